@@ -0,0 +1,64 @@
+/*
+ * Shared fixtures for the host/adb benchmarks in bench/ (minerbench, minerstages).
+ */
+
+#ifndef MINER_BENCH_COMMON_H
+#define MINER_BENCH_COMMON_H
+
+#include "btc_header_sha256.h"
+#include "sha256_scan.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Bitcoin genesis block header, first 76 bytes (nonce 2083236893 follows). */
+static const uint8_t kGenesisHeader76[BTC_HEADER76_SIZE] = {
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x3b, 0xa3, 0xed, 0xfd, 0x7a, 0x7b, 0x12, 0xb2, 0x7a, 0xc7, 0x2c, 0x3e,
+    0x67, 0x76, 0x8f, 0x61, 0x7f, 0xc8, 0x1b, 0xc3, 0x88, 0x8a, 0x51, 0x32, 0x3a, 0x9f, 0xb8, 0xaa,
+    0x4b, 0x1e, 0x5e, 0x4a, 0x29, 0xab, 0x5f, 0x49, 0xff, 0xff, 0x00, 0x1d,
+};
+#define GENESIS_NONCE 2083236893u
+
+/* Difficulty-1 share target (big-endian, as built by StratumHeaderBuilder). */
+static const uint8_t kDiff1Target[BTC_HASH32_SIZE] = {
+    0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0x00, 0x00,
+};
+
+static inline double bench_now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static inline const char *bench_build_arch(void) {
+#if defined(__aarch64__)
+    return "aarch64";
+#elif defined(__x86_64__)
+    return "x86_64";
+#elif defined(__arm__)
+    return "arm";
+#elif defined(__i386__)
+    return "x86";
+#else
+    return "unknown";
+#endif
+}
+
+/* Flavor by CpuSha256Flavor name or ordinal; -1 when unknown. */
+static inline int bench_parse_flavor(const char *s) {
+    for (int f = 0; f < CPU_SHA_FLAVOR_COUNT; f++) {
+        if (strcmp(s, cpu_sha_flavor_label(f)) == 0)
+            return f;
+    }
+    char *endp;
+    long v = strtol(s, &endp, 10);
+    if (*s != '\0' && *endp == '\0' && v >= 0 && v < CPU_SHA_FLAVOR_COUNT)
+        return (int)v;
+    return -1;
+}
+
+#endif
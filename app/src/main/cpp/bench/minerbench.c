@@ -0,0 +1,808 @@
+/*
+ * minerbench: CPU nonce-scan throughput per SHA flavor and thread count.
+ *
+ * Runs scan_nonces_dispatch() over a fixed header (Bitcoin genesis block prefix) with an all-zero
+ * target, so no nonce ever hits and every call scans its full chunk. Each (flavor, threads) run lasts
+ * --seconds; results are printed as a text table and optionally as JSON (--json FILE, "-" = stdout).
+ *
+ *   minerbench [--seconds S] [--threads 1,2,4] [--flavor NAME|ID]... [--json FILE] [--verbose]
+ *   minerbench --selftest
+ *   minerbench --calibrate MS   (the AUTO flavor's per-cluster ranking, MS per flavor per cluster)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench_common.h"
+#include "btc_header_sha256.h"
+#include "cpu_pool.h"
+#include "cpu_topology.h"
+#include "miner_job.h"
+#include "miner_log.h"
+#include "miner_template.h"
+#include "sha256.h"
+#include "sha256_calibrate.h"
+#include "sha256_scan.h"
+#include "uint256.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_CHUNK (1u << 16)
+#define BENCH_MAX_THREAD_COUNTS 16
+#define BENCH_MAX_THREADS 256
+/* Each worker scans its own 2^26-nonce stripe so threads never share work. */
+#define BENCH_STRIPE_SHIFT 26
+
+typedef struct {
+    int flavor;
+    uint32_t first_nonce;
+    double seconds;
+    pthread_barrier_t *barrier;
+    uint64_t hashes;
+    int error;
+} bench_worker;
+
+typedef struct {
+    int flavor;
+    int threads;
+    uint64_t hashes;
+    double seconds;
+    double hs;
+    double ns_per_hash;
+    double efficiency;
+} bench_result;
+
+static void *bench_worker_main(void *arg) {
+    bench_worker *w = (bench_worker *)arg;
+    static const uint8_t zero_target[BTC_HASH32_SIZE];
+    pthread_barrier_wait(w->barrier);
+    const double t0 = bench_now_sec();
+    uint32_t n = w->first_nonce;
+    uint64_t hashes = 0;
+    do {
+        uint32_t end = n + (BENCH_CHUNK - 1u);
+        int r = scan_nonces_dispatch(w->flavor, kGenesisHeader76, n, end, zero_target);
+        if (r == CPU_SHA_FLAVOR_ERROR) {
+            w->error = 1;
+            break;
+        }
+        if (r >= 0) {
+            hashes += (uint64_t)((uint32_t)r - n) + 1u;
+            n = (uint32_t)r + 1u;
+        } else {
+            hashes += BENCH_CHUNK;
+            n = end + 1u;
+        }
+    } while (bench_now_sec() - t0 < w->seconds);
+    w->hashes = hashes;
+    return NULL;
+}
+
+static int run_one(int flavor, int threads, double seconds, bench_result *out) {
+    pthread_t tids[BENCH_MAX_THREADS];
+    bench_worker workers[BENCH_MAX_THREADS];
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, (unsigned)threads + 1u);
+    for (int i = 0; i < threads; i++) {
+        workers[i] = (bench_worker){
+            .flavor = flavor,
+            .first_nonce = (uint32_t)i << BENCH_STRIPE_SHIFT,
+            .seconds = seconds,
+            .barrier = &barrier,
+        };
+        if (pthread_create(&tids[i], NULL, bench_worker_main, &workers[i]) != 0) {
+            fprintf(stderr, "minerbench: pthread_create failed (%s)\n", strerror(errno));
+            exit(1);
+        }
+    }
+    pthread_barrier_wait(&barrier);
+    const double t0 = bench_now_sec();
+    uint64_t total = 0;
+    int error = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(tids[i], NULL);
+        total += workers[i].hashes;
+        error |= workers[i].error;
+    }
+    const double elapsed = bench_now_sec() - t0;
+    pthread_barrier_destroy(&barrier);
+    if (error)
+        return 0;
+    out->flavor = flavor;
+    out->threads = threads;
+    out->hashes = total;
+    out->seconds = elapsed;
+    out->hs = elapsed > 0.0 ? (double)total / elapsed : 0.0;
+    out->ns_per_hash = total > 0 ? elapsed * 1e9 * (double)threads / (double)total : 0.0;
+    out->efficiency = 1.0;
+    return 1;
+}
+
+static int parse_thread_list(const char *s, int *out, int cap) {
+    int n = 0;
+    while (*s && n < cap) {
+        char *endp;
+        long v = strtol(s, &endp, 10);
+        if (endp == s || v < 1 || v > BENCH_MAX_THREADS)
+            return -1;
+        out[n++] = (int)v;
+        s = (*endp == ',') ? endp + 1 : endp;
+        if (*endp != ',' && *endp != '\0')
+            return -1;
+    }
+    return n;
+}
+
+static int default_thread_list(int *out, int cap) {
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu < 1)
+        ncpu = 1;
+    if (ncpu > BENCH_MAX_THREADS)
+        ncpu = BENCH_MAX_THREADS;
+    int n = 0;
+    for (long t = 1; t < ncpu && n < cap - 1; t *= 2)
+        out[n++] = (int)t;
+    out[n++] = (int)ncpu;
+    return n;
+}
+
+static void write_json(FILE *f, double seconds, const bench_result *res, int nres) {
+    fprintf(f, "{\n  \"schema\": \"minerbench-1\",\n  \"arch\": \"%s\",\n  \"compiler\": \"%s\",\n", bench_build_arch(),
+        __VERSION__);
+    fprintf(f, "  \"seconds_per_run\": %.3f,\n  \"chunk_nonces\": %u,\n  \"runs\": [\n", seconds, BENCH_CHUNK);
+    for (int i = 0; i < nres; i++) {
+        const bench_result *r = &res[i];
+        fprintf(f,
+            "    {\"flavor\": \"%s\", \"flavor_id\": %d, \"isa\": \"%s\", \"threads\": %d, \"hashes\": %llu, "
+            "\"seconds\": %.6f, \"hs\": %.1f, \"ns_per_hash\": %.3f, \"scaling_efficiency\": %.4f}%s\n",
+            cpu_sha_flavor_label(r->flavor), r->flavor, cpu_sha_flavor_isa(r->flavor), r->threads, (unsigned long long)r->hashes, r->seconds, r->hs,
+            r->ns_per_hash, r->efficiency, i + 1 < nres ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+/*
+ * scan_nonces_multi against a loose target (about 1 hit in 128 nonces): the hits must be exactly what
+ * repeated single-hit scans find when resumed after each hit, and a 3-slot buffer must stop right
+ * after its third hit with [scanned] pointing there.
+ */
+#define MULTI_START 1000u
+#define MULTI_END 4999u
+#define MULTI_CAP 96
+
+static int check_multi_hits(int flavor) {
+    uint8_t target[32];
+    memset(target, 0xff, sizeof(target));
+    target[0] = 0x01;
+    uint32_t ref[MULTI_CAP];
+    int nref = 0;
+    for (uint32_t n = MULTI_START; n <= MULTI_END && nref < MULTI_CAP;) {
+        const int r = scan_nonces_dispatch(flavor, kGenesisHeader76, n, MULTI_END, target);
+        if (r < 0)
+            break;
+        ref[nref++] = (uint32_t)r;
+        n = (uint32_t)r + 1u;
+    }
+    uint32_t got[MULTI_CAP];
+    cpu_scan_hits all = {.nonces = got, .cap = MULTI_CAP};
+    if (nref < 4 || scan_nonces_multi(flavor, kGenesisHeader76, MULTI_START, MULTI_END, target, &all) != nref ||
+        all.scanned != MULTI_END - MULTI_START + 1u || memcmp(got, ref, (size_t)nref * sizeof(ref[0])) != 0)
+        return 0;
+    cpu_scan_hits three = {.nonces = got, .cap = 3};
+    return scan_nonces_multi(flavor, kGenesisHeader76, MULTI_START, MULTI_END, target, &three) == 3 &&
+           three.scanned == ref[2] - MULTI_START + 1u && memcmp(got, ref, 3 * sizeof(ref[0])) == 0;
+}
+
+/*
+ * Best-hash tracking over the same range with no possible hit (probe kernels only fully hash the
+ * lanes that can beat the running minimum): nonce and digest must match a reference minimum.
+ */
+static int check_best_hash(int flavor) {
+    static const uint8_t zero_target[32];
+    uint32_t best_nonce = 0;
+    uint256 best;
+    uint8_t best_hash[32];
+    for (uint32_t n = MULTI_START; n <= MULTI_END; n++) {
+        uint8_t h[32];
+        uint256 v;
+        btc_double_sha_full(kGenesisHeader76, n, h);
+        uint256_from_hash(&v, h);
+        if (n == MULTI_START || uint256_cmp(&v, &best) < 0) {
+            best = v;
+            best_nonce = n;
+            memcpy(best_hash, h, sizeof(best_hash));
+        }
+    }
+    uint32_t slot;
+    cpu_scan_hits hits = {.nonces = &slot, .cap = 1};
+    return scan_nonces_multi(flavor, kGenesisHeader76, MULTI_START, MULTI_END, zero_target, &hits) == 0 &&
+           hits.best_nonce == best_nonce && memcmp(hits.best_hash, best_hash, sizeof(best_hash)) == 0;
+}
+
+/*
+ * A range ending at UINT32_MAX: the scan must stop there rather than wrap to nonce 0, with every hit
+ * inside the range and matching a reference full double-SHA.
+ */
+#define TOP_START 0xFFFFFF00u
+
+static int check_top_end(int flavor) {
+    uint8_t target[32];
+    memset(target, 0xff, sizeof(target));
+    target[0] = 0x03;
+    uint32_t ref[64];
+    int nref = 0;
+    for (uint32_t n = TOP_START;; n++) {
+        uint8_t h[32];
+        uint256 v;
+        uint256 t;
+        btc_double_sha_full(kGenesisHeader76, n, h);
+        uint256_from_hash(&v, h);
+        uint256_from_be(&t, target);
+        if (uint256_cmp(&v, &t) <= 0 && nref < 64)
+            ref[nref++] = n;
+        if (n == UINT32_MAX)
+            break;
+    }
+    uint32_t got[64];
+    cpu_scan_hits hits = {.nonces = got, .cap = 64};
+    return nref > 0 && scan_nonces_multi(flavor, kGenesisHeader76, TOP_START, UINT32_MAX, target, &hits) == nref &&
+           hits.scanned == (uint64_t)(UINT32_MAX - TOP_START) + 1u &&
+           memcmp(got, ref, (size_t)nref * sizeof(ref[0])) == 0;
+}
+
+/* uint256.c against hand-computed targets: 0xffff * 2^208 / d for exact d, clamping, and round trips. */
+static int check_uint256(void) {
+    static const struct {
+        double difficulty;
+        uint8_t top[8];
+    } kTargets[] = {
+        {1.0, {0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0x00, 0x00}},
+        {0.5, {0x00, 0x00, 0x00, 0x01, 0xff, 0xfe, 0x00, 0x00}},
+        {3.0, {0x00, 0x00, 0x00, 0x00, 0x55, 0x55, 0x00, 0x00}},
+        {65536.0, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff}},
+        {0.0, {0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0x00, 0x00}},
+    };
+    uint8_t t[32];
+    for (size_t i = 0; i < sizeof(kTargets) / sizeof(kTargets[0]); i++) {
+        uint256_target_from_difficulty(kTargets[i].difficulty, t);
+        for (int b = 8; b < 32; b++) {
+            if (t[b] != 0)
+                return 0;
+        }
+        if (memcmp(t, kTargets[i].top, 8) != 0)
+            return 0;
+    }
+    /* 1 / 3 rounds to a double just under a third: just over three difficulty-1 targets, 0x2fffd... */
+    uint256_target_from_difficulty(1.0 / 3.0, t);
+    if (t[3] != 0x02 || t[4] != 0xff || t[5] != 0xfd)
+        return 0;
+    uint256_target_from_difficulty(1e-80, t);
+    for (int b = 0; b < 32; b++) {
+        if (t[b] != 0xff)
+            return 0;
+    }
+    static const double kRoundTrip[] = {1e-6, 0.001, 1.0, 1234.5, 3.7e12, 1e30};
+    for (size_t i = 0; i < sizeof(kRoundTrip) / sizeof(kRoundTrip[0]); i++) {
+        uint256_target_from_difficulty(kRoundTrip[i], t);
+        const double d = uint256_difficulty_from_target(t);
+        if (d < kRoundTrip[i] * (1.0 - 1e-12) || d > kRoundTrip[i] * (1.0 + 1e-9))
+            return 0;
+    }
+    uint8_t genesis[32];
+    btc_double_sha_full(kGenesisHeader76, GENESIS_NONCE, genesis);
+    const double gd = uint256_difficulty_from_hash(genesis);
+    /* Genesis block hash 000000000019d6...: share difficulty about 2536.6. */
+    return gd > 2536.0 && gd < 2537.0;
+}
+
+/*
+ * cpu_pool over a few chunks plus a ragged tail (about 1 hit in 4096 nonces): the drained hits, nonce
+ * count and best difficulty must equal one scan_nonces_multi call over the same range, both for one plain
+ * group and for two groups with their own pinning, flavor, claim size and weight. Then a large job is
+ * cancelled mid-way and must go idle without finishing.
+ */
+#define POOL_CHECK_THREADS 3
+#define POOL_CHECK_MAX_HITS 256
+
+static int cmp_u32(const void *a, const void *b) {
+    const uint32_t x = *(const uint32_t *)a;
+    const uint32_t y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    const uint64_t x = *(const uint64_t *)a;
+    const uint64_t y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* Drains [pool] until its job is idle, appending hits (all of [tag]) to [got]; 0 on a bad hit or error. */
+static int pool_wait_idle(cpu_pool *pool, uint64_t tag, uint32_t *got, int *ngot_io, uint64_t *scanned_io,
+                          double *best_io) {
+    int ok = 1;
+    int ngot = *ngot_io;
+    uint64_t scanned = 0;
+    double best = 0.0;
+    const struct timespec tick = {0, 1000000L};
+    /* One more drain after the job is seen idle: [busy] is read last, so the final hits may follow it. */
+    for (int idle = 0, last = 0; ok && !last;) {
+        last = idle;
+        if (!last)
+            nanosleep(&tick, NULL);
+        cpu_pool_hit hits[POOL_CHECK_MAX_HITS];
+        cpu_pool_stats st;
+        const int n = cpu_pool_drain(pool, hits, POOL_CHECK_MAX_HITS, &st);
+        idle = st.busy == 0;
+        scanned += st.scanned;
+        if (st.best_difficulty > best)
+            best = st.best_difficulty;
+        for (int i = 0; i < n && ok; i++) {
+            ok = hits[i].tag == tag && ngot < POOL_CHECK_MAX_HITS;
+            if (ok)
+                got[ngot++] = hits[i].nonce;
+        }
+        ok = ok && st.dropped == 0 && st.error == 0;
+    }
+    *ngot_io = ngot;
+    *scanned_io += scanned;
+    if (best > *best_io)
+        *best_io = best;
+    return ok;
+}
+
+/* Runs [job] over [start, end] on [pool] until idle; the hits, nonce count and best must match [all]. */
+static int pool_matches(cpu_pool *pool, miner_job *job, uint32_t start, uint32_t end, const uint32_t *ref, int nref,
+                        const cpu_scan_hits *all, int *ngot_out) {
+    uint32_t got[POOL_CHECK_MAX_HITS];
+    int ngot = 0;
+    uint64_t scanned = 0;
+    double best = 0.0;
+    int ok = job && cpu_pool_submit(pool, 7u, job, start, end) == 0 &&
+             pool_wait_idle(pool, 7u, got, &ngot, &scanned, &best);
+    qsort(got, (size_t)ngot, sizeof(got[0]), cmp_u32);
+    *ngot_out = ngot;
+    return ok && ngot == nref && memcmp(got, ref, (size_t)ngot * sizeof(got[0])) == 0 &&
+           scanned == (uint64_t)(end - start) + 1u && best == uint256_difficulty_from_hash(all->best_hash);
+}
+
+/*
+ * Sharing a job with another device: a range stolen right after submit is left out, a range added while
+ * the workers run and one added after they went idle are scanned. The hits must equal the reference
+ * scan of everything but the stolen range.
+ */
+static int check_pool_share(cpu_pool *pool, int flavor) {
+    const uint32_t u = CPU_POOL_UNIT;
+    /* About 1 hit in 16384 nonces; runs of 20+ units leave a worker's tail to steal. */
+    uint8_t target[32];
+    memset(target, 0xff, sizeof(target));
+    target[0] = 0x00;
+    target[1] = 0x03;
+    uint32_t ref[POOL_CHECK_MAX_HITS];
+    cpu_scan_hits all = {.nonces = ref, .cap = POOL_CHECK_MAX_HITS};
+    if (scan_nonces_multi(flavor, kGenesisHeader76, 0u, 76u * u - 1u, target, &all) < 0)
+        return 0;
+    miner_job *job = miner_job_create(kGenesisHeader76, target, flavor);
+    uint32_t got[POOL_CHECK_MAX_HITS];
+    int ngot = 0;
+    uint64_t scanned = 0;
+    double best = 0.0;
+    uint32_t s0 = 1u;
+    uint32_t e0 = 0u;
+    int ok = job && cpu_pool_submit(pool, 10u, job, 0u, 64u * u - 1u) == 0;
+    miner_job_release(job);
+    /* Nothing to steal once the workers have claimed it all; then the stolen range stays empty. */
+    const int stolen = ok && cpu_pool_steal(pool, 10u, u, &s0, &e0);
+    ok = ok && (!stolen || (s0 % u == 0u && (e0 + 1u) % u == 0u && e0 < 64u * u && s0 <= e0));
+    ok = ok && cpu_pool_steal(pool, 11u, u, &s0, &e0) == 0 && cpu_pool_extend(pool, 10u, 64u * u, 72u * u - 1u) &&
+         cpu_pool_extend(pool, 10u, 72u * u + 1u, 76u * u - 1u) == 0 &&
+         pool_wait_idle(pool, 10u, got, &ngot, &scanned, &best) && cpu_pool_remaining(pool) == 0u &&
+         cpu_pool_extend(pool, 10u, 72u * u, 76u * u - 1u) && pool_wait_idle(pool, 10u, got, &ngot, &scanned, &best);
+    int nexp = 0;
+    for (uint32_t i = 0; i < all.count; i++) {
+        if (!stolen || ref[i] < s0 || ref[i] > e0)
+            ref[nexp++] = ref[i];
+    }
+    qsort(got, (size_t)ngot, sizeof(got[0]), cmp_u32);
+    const uint64_t expect = 76u * (uint64_t)u - (stolen ? (uint64_t)(e0 - s0) + 1u : 0u);
+    return ok && ngot == nexp && memcmp(got, ref, (size_t)ngot * sizeof(got[0])) == 0 && scanned == expect;
+}
+
+/* Template check: workers 0..2 own extranonce2 100 + i + 5k; 103 and 104 + 5k are left for another device. */
+#define TPL_EN2_FIRST 100u
+#define TPL_EN2_STRIDE 5u
+
+/* Coinbase bytes that are not all alike, so a misplaced extranonce2 changes the root. */
+static void tpl_fill(uint8_t *b, size_t n, uint8_t seed) {
+    for (size_t i = 0; i < n; i++)
+        b[i] = (uint8_t)(seed + i * 7u);
+}
+
+/* Header for [en2] the way StratumHeaderBuilder builds it: the whole coinbase, SHA256d, then each branch. */
+static void tpl_reference_header(const uint8_t *cb1, size_t n1, uint32_t en2, const uint8_t *cb2, size_t n2,
+                                 const uint8_t (*branches)[32], int nbranches, uint8_t header76[76]) {
+    uint8_t coinbase[512];
+    memcpy(coinbase, cb1, n1);
+    for (int i = 0; i < 4; i++)
+        coinbase[n1 + (size_t)i] = (uint8_t)(en2 >> (24 - 8 * i));
+    memcpy(coinbase + n1 + 4u, cb2, n2);
+    uint8_t node[64];
+    sha256_double(coinbase, n1 + 4u + n2, node);
+    for (int b = 0; b < nbranches; b++) {
+        memcpy(node + 32, branches[b], 32u);
+        sha256_double(node, 64u, node);
+    }
+    memcpy(header76, kGenesisHeader76, 76u);
+    memcpy(header76 + 36, node, 32u);
+}
+
+/* Hits kept by the template check: about 64 per header, each worker through a few headers. */
+#define TPL_MAX_HITS 4096
+
+/*
+ * Template job: miner_template_header must equal the reference header (extranonce2 inside the first
+ * block, across a block boundary and after whole blocks). On the pool, over the top four units of the
+ * nonce space so every header ends at UINT32_MAX: every worker must finish its first header (its hits
+ * equal a reference scan of it) and move on to its next extranonce2 by itself, no (extranonce2, nonce)
+ * may be reported twice, and every hit must meet the target in the header of the extranonce2 it carries.
+ */
+static int check_pool_template(cpu_pool *pool, int flavor) {
+    uint8_t cb1[150];
+    uint8_t cb2[60];
+    uint8_t branches[2][32];
+    tpl_fill(cb1, sizeof(cb1), 3u);
+    tpl_fill(cb2, sizeof(cb2), 11u);
+    tpl_fill(branches[0], 64u, 29u);
+    uint8_t target[32];
+    memset(target, 0xff, sizeof(target));
+    target[0] = 0x00;
+    target[1] = 0x0f;
+    int ok = 1;
+    miner_template *tpl = NULL;
+    const size_t cb1_lens[3] = {20u, 62u, sizeof(cb1)};
+    for (int c = 0; c < 3 && ok; c++) {
+        miner_template_release(tpl);
+        tpl = miner_template_create(kGenesisHeader76, target, cb1, cb1_lens[c], 4, cb2, sizeof(cb2), branches[0],
+                                    c);
+        for (uint32_t en2 = 0; tpl && ok && en2 < 3u; en2++) {
+            uint8_t got[76];
+            uint8_t want[76];
+            miner_template_header(tpl, en2 * 0x01010101u, got);
+            tpl_reference_header(cb1, cb1_lens[c], en2 * 0x01010101u, cb2, sizeof(cb2),
+                                 (const uint8_t (*)[32])branches, c, want);
+            ok = memcmp(got, want, sizeof(got)) == 0;
+        }
+        ok = ok && tpl;
+    }
+    /* 256K nonces per header (about 64 hits) so each worker gets through a few headers quickly. */
+    const uint32_t nonce_start = UINT32_MAX - 4u * CPU_POOL_UNIT + 1u;
+    const uint64_t per_header = (uint64_t)(UINT32_MAX - nonce_start) + 1u;
+    ok = ok && cpu_pool_submit_template(pool, 12u, tpl, flavor, TPL_EN2_FIRST, TPL_EN2_STRIDE, nonce_start,
+                                        UINT32_MAX) == 0;
+    miner_template_release(tpl);
+    const int nworkers = cpu_pool_workers(pool);
+    /* Hits as extranonce2 << 32 | nonce. */
+    uint64_t *seen = (uint64_t *)malloc(TPL_MAX_HITS * sizeof(uint64_t));
+    uint32_t max_en2[CPU_POOL_MAX_THREADS] = {0};
+    int nhits = 0;
+    uint64_t scanned = 0;
+    const struct timespec tick = {0, 1000000L};
+    const double t0 = bench_now_sec();
+    ok = ok && seen;
+    /* Until every worker is past its second header, then cancelled and drained once more. */
+    for (int done = 0, last = 0; ok && !last;) {
+        last = done;
+        if (!last)
+            nanosleep(&tick, NULL);
+        cpu_pool_hit hits[POOL_CHECK_MAX_HITS];
+        cpu_pool_stats st;
+        const int n = cpu_pool_drain(pool, hits, POOL_CHECK_MAX_HITS, &st);
+        scanned += st.scanned;
+        ok = st.dropped == 0 && st.error == 0 && (done || st.busy == nworkers);
+        for (int i = 0; i < n && ok; i++) {
+            const uint32_t en2 = hits[i].extranonce2;
+            const uint32_t worker = (en2 - TPL_EN2_FIRST) % TPL_EN2_STRIDE;
+            uint8_t header76[76];
+            uint8_t hash[32];
+            uint256 h;
+            uint256 t;
+            tpl_reference_header(cb1, sizeof(cb1), en2, cb2, sizeof(cb2), (const uint8_t (*)[32])branches, 2,
+                                 header76);
+            btc_double_sha_full(header76, hits[i].nonce, hash);
+            uint256_from_hash(&h, hash);
+            uint256_from_be(&t, target);
+            ok = hits[i].tag == 12u && en2 >= TPL_EN2_FIRST && worker < (uint32_t)nworkers &&
+                 hits[i].nonce >= nonce_start && uint256_cmp(&h, &t) <= 0 && nhits < TPL_MAX_HITS;
+            if (ok) {
+                seen[nhits++] = (uint64_t)en2 << 32 | hits[i].nonce;
+                if (en2 > max_en2[worker])
+                    max_en2[worker] = en2;
+            }
+        }
+        if (!done && (scanned >= 3u * (uint64_t)nworkers * per_header || bench_now_sec() - t0 > 20.0)) {
+            cpu_pool_cancel(pool);
+            done = 1;
+        }
+    }
+    ok = ok && scanned >= 3u * (uint64_t)nworkers * per_header;
+    if (ok)
+        qsort(seen, (size_t)nhits, sizeof(seen[0]), cmp_u64);
+    for (int i = 1; i < nhits && ok; i++)
+        ok = seen[i] != seen[i - 1];
+    for (int w = 0; w < nworkers && ok; w++) {
+        /* Worker w's first header, complete since it has moved on: exactly the reference hits. */
+        const uint32_t en2 = TPL_EN2_FIRST + (uint32_t)w;
+        uint8_t header76[76];
+        uint32_t ref[POOL_CHECK_MAX_HITS];
+        cpu_scan_hits all = {.nonces = ref, .cap = POOL_CHECK_MAX_HITS};
+        tpl_reference_header(cb1, sizeof(cb1), en2, cb2, sizeof(cb2), (const uint8_t (*)[32])branches, 2, header76);
+        const int nref = scan_nonces_multi(flavor, header76, nonce_start, UINT32_MAX, target, &all);
+        int k = 0;
+        while (k < nhits && seen[k] >> 32 < en2)
+            k++;
+        ok = max_en2[w] >= en2 + TPL_EN2_STRIDE && nref > 0 && k + nref <= nhits;
+        for (int r = 0; r < nref && ok; r++)
+            ok = seen[k + r] == ((uint64_t)en2 << 32 | ref[r]);
+        ok = ok && (k + nref == nhits || seen[k + nref] >> 32 != en2);
+    }
+    free(seen);
+    return ok && nhits > 0;
+}
+
+static int check_pool(int flavor) {
+    uint8_t target[32];
+    memset(target, 0xff, sizeof(target));
+    target[0] = 0x00;
+    target[1] = 0x0f;
+    const uint32_t start = 1000u;
+    const uint32_t end = start + 3u * CPU_POOL_CHUNK + 4999u;
+    uint32_t ref[POOL_CHECK_MAX_HITS];
+    cpu_scan_hits all = {.nonces = ref, .cap = POOL_CHECK_MAX_HITS};
+    const int nref = scan_nonces_multi(flavor, kGenesisHeader76, start, end, target, &all);
+    if (nref < 0)
+        return 0;
+    /* The pool holds its own reference; dropping ours at once also checks it keeps the job alive. */
+    miner_job *job = miner_job_create(kGenesisHeader76, target, flavor);
+    int ngot = 0;
+
+    /* Two groups: pinned to this thread's CPUs with small claims, and unpinned SCALAR with large ones. */
+    uint64_t self = 0;
+    cpu_topology_get_self(&self);
+    const cpu_pool_group groups[2] = {
+        {.cpu_mask = self, .threads = 2, .flavor = MINER_JOB_NO_FLAVOR, .chunk = CPU_POOL_UNIT, .weight = 3.0},
+        {.cpu_mask = 0, .threads = 1, .flavor = 5, .chunk = 4u * CPU_POOL_CHUNK, .weight = 1.0},
+    };
+    cpu_pool *pool = cpu_pool_create_groups(groups, 2, 0);
+    uint64_t per_group[2] = {0, 0};
+    int ok = pool && pool_matches(pool, job, start, end, ref, nref, &all, &ngot) &&
+         cpu_pool_group_scanned(pool, per_group, 2) == 2 && per_group[0] + per_group[1] == (uint64_t)(end - start) + 1u;
+    const int ngroups_ok = ok;
+    cpu_pool_destroy(pool);
+
+    pool = cpu_pool_create(POOL_CHECK_THREADS, 0);
+    ok = ok && pool && pool_matches(pool, job, start, end, ref, nref, &all, &ngot);
+    miner_job_release(job);
+    /* The last unit of the nonce space: workers must stop at UINT32_MAX, not wrap to 0. */
+    const uint32_t top = UINT32_MAX - CPU_POOL_UNIT + 1u;
+    uint32_t top_ref[POOL_CHECK_MAX_HITS];
+    cpu_scan_hits top_all = {.nonces = top_ref, .cap = POOL_CHECK_MAX_HITS};
+    const int ntop = scan_nonces_multi(flavor, kGenesisHeader76, top, UINT32_MAX, target, &top_all);
+    job = miner_job_create(kGenesisHeader76, target, flavor);
+    int ntop_got = 0;
+    const int top_ok = ntop > 0 && pool && pool_matches(pool, job, top, UINT32_MAX, top_ref, ntop, &top_all, &ntop_got);
+    miner_job_release(job);
+    ok = ok && top_ok;
+    if (!pool)
+        return 0;
+    const int shared_ok = check_pool_share(pool, flavor);
+    const int template_ok = check_pool_template(pool, flavor);
+    ok = ok && shared_ok && template_ok;
+    const struct timespec tick = {0, 1000000L};
+
+    /* Cancel: the rest of a 2^31-nonce job is dropped within a poll window per worker. */
+    cpu_pool_stats st;
+    cpu_pool_hit spare[POOL_CHECK_MAX_HITS];
+    job = miner_job_create(kGenesisHeader76, kDiff1Target, flavor);
+    ok = ok && job && cpu_pool_submit(pool, 8u, job, 0u, 0x7fffffffu) == 0;
+    nanosleep(&tick, NULL);
+    cpu_pool_cancel(pool);
+    cpu_pool_drain(pool, spare, POOL_CHECK_MAX_HITS, &st);
+    ok = ok && st.busy == 0 && st.scanned < 0x80000000ull;
+
+    /* cpuRequestInterrupt mid-job: every worker leaves it at its next poll (busy counts down to 0). */
+    ok = ok && job && cpu_pool_submit(pool, 9u, job, 0u, 0x7fffffffu) == 0;
+    miner_job_release(job);
+    nanosleep(&tick, NULL);
+    cpu_scan_cancel_all();
+    const double t0 = bench_now_sec();
+    double stop_ms = 0.0;
+    do {
+        cpu_pool_drain(pool, spare, POOL_CHECK_MAX_HITS, &st);
+        stop_ms = (bench_now_sec() - t0) * 1e3;
+    } while (ok && st.busy != 0 && stop_ms < 2000.0 && nanosleep(&tick, NULL) == 0);
+    ok = ok && st.busy == 0;
+    cpu_pool_destroy(pool);
+    printf("%s cpu_pool %s threads=%d hits=%d/%d grouped=%d top_end=%d shared=%d template=%d interrupt_ms=%.2f\n",
+        ok ? "PASS" : "FAIL", cpu_sha_flavor_label(flavor), POOL_CHECK_THREADS, ngot, nref, ngroups_ok, top_ok,
+        shared_ok, template_ok, stop_ms);
+    return ok;
+}
+
+/* Per-flavor self-test plus an end-to-end scan that must land exactly on the genesis nonce. */
+static int run_selftest(void) {
+    int failures = 0;
+    if (!gpu_sha_host_selftest()) {
+        printf("FAIL host midstate vs full double-SHA\n");
+        failures++;
+    }
+    if (!check_uint256()) {
+        printf("FAIL uint256 target / difficulty\n");
+        failures++;
+    }
+    for (int f = 0; f < CPU_SHA_FLAVOR_COUNT; f++) {
+        if (!cpu_sha_flavor_supported(f)) {
+            printf("SKIP %-18s (not supported on this CPU/build)\n", cpu_sha_flavor_label(f));
+            continue;
+        }
+        int ok = cpu_sha_selftest_flavor(f);
+        int hit = scan_nonces_dispatch(f, kGenesisHeader76, GENESIS_NONCE - 37u, GENESIS_NONCE + 37u, kDiff1Target);
+        int hit_ok = (hit >= 0 && (uint32_t)hit == GENESIS_NONCE);
+        int multi_ok = check_multi_hits(f);
+        int best_ok = check_best_hash(f);
+        int top_ok = check_top_end(f);
+        const int pass = ok && hit_ok && multi_ok && best_ok && top_ok;
+        printf("%s %-18s selftest=%d genesis_scan=%d multi_hit=%d best_hash=%d top_end=%d isa=%s\n",
+            pass ? "PASS" : "FAIL", cpu_sha_flavor_label(f), ok, hit_ok, multi_ok, best_ok, top_ok,
+            cpu_sha_flavor_isa(f));
+        if (!pass)
+            failures++;
+    }
+    if (!check_pool(4))
+        failures++;
+    return failures == 0 ? 0 : 1;
+}
+
+/* Cluster table plus the ranking and winner cpu_sha_calibrate gives the app for CpuSha256Flavor.AUTO. */
+static int run_calibrate(uint32_t ms) {
+    cpu_cluster clusters[CPU_TOPOLOGY_MAX_CLUSTERS];
+    cpu_sha_rank rows[CPU_CALIBRATE_MAX_ROWS];
+    const int nclusters = cpu_topology_clusters(clusters, CPU_TOPOLOGY_MAX_CLUSTERS);
+    for (int c = 0; c < nclusters; c++) {
+        printf("cluster %d: cpus 0x%llx (%d), capacity %u, max %u kHz\n", c,
+            (unsigned long long)clusters[c].cpu_mask, clusters[c].ncpus, clusters[c].capacity, clusters[c].max_khz);
+    }
+    const int nrows = cpu_sha_calibrate(clusters, nclusters, ms, rows, CPU_CALIBRATE_MAX_ROWS);
+    if (nrows <= 0) {
+        printf("calibration failed (%d)\n", nrows);
+        return 1;
+    }
+    printf("%-8s %-18s %14s\n", "cluster", "flavor", "H/s");
+    for (int i = 0; i < nrows; i++)
+        printf("%-8d %-18s %14.0f\n", rows[i].cluster, cpu_sha_flavor_label(rows[i].flavor), rows[i].hs);
+    const int winner = cpu_sha_calibration_winner(clusters, nclusters, rows, nrows);
+    printf("winner: %s\n", cpu_sha_flavor_label(winner));
+    return winner >= 0 ? 0 : 1;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+        "usage: minerbench [--seconds S] [--threads 1,2,4] [--flavor NAME|ID]... [--json FILE|-] [--verbose]\n"
+        "       minerbench --selftest\n"
+        "       minerbench --calibrate MS\n");
+}
+
+int main(int argc, char **argv) {
+    double seconds = 3.0;
+    int thread_counts[BENCH_MAX_THREAD_COUNTS];
+    int nthread_counts = 0;
+    int flavors[CPU_SHA_FLAVOR_COUNT];
+    int nflavors = 0;
+    const char *json_path = NULL;
+    int selftest = 0;
+    long calibrate_ms = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(a, "--seconds") == 0 && v) {
+            seconds = atof(v);
+            i++;
+        } else if (strcmp(a, "--threads") == 0 && v) {
+            nthread_counts = parse_thread_list(v, thread_counts, BENCH_MAX_THREAD_COUNTS);
+            if (nthread_counts <= 0) {
+                usage();
+                return 2;
+            }
+            i++;
+        } else if (strcmp(a, "--flavor") == 0 && v) {
+            int f = bench_parse_flavor(v);
+            if (f < 0 || nflavors >= CPU_SHA_FLAVOR_COUNT) {
+                fprintf(stderr, "minerbench: unknown flavor '%s'\n", v);
+                return 2;
+            }
+            flavors[nflavors++] = f;
+            i++;
+        } else if (strcmp(a, "--json") == 0 && v) {
+            json_path = v;
+            i++;
+        } else if (strcmp(a, "--selftest") == 0) {
+            selftest = 1;
+        } else if (strcmp(a, "--calibrate") == 0 && v) {
+            calibrate_ms = strtol(v, NULL, 10);
+            if (calibrate_ms < 1) {
+                usage();
+                return 2;
+            }
+            i++;
+        } else if (strcmp(a, "--verbose") == 0) {
+#if !defined(__ANDROID__)
+            miner_log_set_min_priority(ANDROID_LOG_DEBUG);
+#endif
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    if (selftest)
+        return run_selftest();
+    if (calibrate_ms > 0)
+        return run_calibrate((uint32_t)calibrate_ms);
+    if (seconds <= 0.0) {
+        usage();
+        return 2;
+    }
+    if (nthread_counts == 0)
+        nthread_counts = default_thread_list(thread_counts, BENCH_MAX_THREAD_COUNTS);
+    if (nflavors == 0) {
+        for (int f = 0; f < CPU_SHA_FLAVOR_COUNT; f++) {
+            if (cpu_sha_flavor_supported(f))
+                flavors[nflavors++] = f;
+        }
+    }
+
+    bench_result results[CPU_SHA_FLAVOR_COUNT * BENCH_MAX_THREAD_COUNTS];
+    int nres = 0;
+    printf("%-18s %7s %14s %12s %10s\n", "flavor", "threads", "H/s", "ns/hash", "scaling");
+    for (int fi = 0; fi < nflavors; fi++) {
+        const int f = flavors[fi];
+        if (!cpu_sha_flavor_supported(f) || !cpu_sha_selftest_flavor(f)) {
+            printf("%-18s skipped (unsupported or self-test failed)\n", cpu_sha_flavor_label(f));
+            continue;
+        }
+        const bench_result *base = NULL;
+        for (int ti = 0; ti < nthread_counts; ti++) {
+            bench_result *r = &results[nres];
+            if (!run_one(f, thread_counts[ti], seconds, r)) {
+                printf("%-18s %7d flavor error\n", cpu_sha_flavor_label(f), thread_counts[ti]);
+                continue;
+            }
+            if (!base)
+                base = r;
+            /* Per-thread rate relative to the smallest thread count measured for this flavor. */
+            if (base->hs > 0.0)
+                r->efficiency = (r->hs / r->threads) / (base->hs / base->threads);
+            printf("%-18s %7d %14.0f %12.2f %9.1f%%\n", cpu_sha_flavor_label(f), r->threads, r->hs, r->ns_per_hash,
+                r->efficiency * 100.0);
+            fflush(stdout);
+            nres++;
+        }
+    }
+
+    if (json_path) {
+        FILE *f = strcmp(json_path, "-") == 0 ? stdout : fopen(json_path, "w");
+        if (!f) {
+            fprintf(stderr, "minerbench: cannot write %s (%s)\n", json_path, strerror(errno));
+            return 1;
+        }
+        write_json(f, seconds, results, nres);
+        if (f != stdout)
+            fclose(f);
+    }
+    return 0;
+}
@@ -0,0 +1,306 @@
+/*
+ * minerstages: per-stage cost of the double-SHA pipeline for each CPU SHA flavor.
+ *
+ * Times each stage of one nonce in isolation (midstate, first hash, second hash, digest serialisation,
+ * target check, plus the whole double hash) through cpu_sha_stage_bench(), which runs the same calls
+ * as the scan loops. Each
+ * (flavor, stage) pair is calibrated to --ms milliseconds per repetition and repeated --reps times; the
+ * fastest repetition is reported, with the median alongside as a noise indicator.
+ *
+ * Cycles come from the perf cycle counter when the kernel allows it (perf_event_paranoid), else from
+ * the TSC on x86 (reference cycles, not core cycles); otherwise only nanoseconds are reported.
+ *
+ *   minerstages [--ms N] [--reps N] [--flavor NAME|ID]... [--stage NAME]... [--cpu N] [--json FILE|-]
+ */
+
+#define _GNU_SOURCE
+
+#include "bench_common.h"
+#include "sha256_scan.h"
+
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define STAGES_MAX_REPS 64
+#define STAGES_MAX_ITERS (1u << 30)
+
+typedef enum {
+    CYCLES_NONE,
+    CYCLES_PERF,
+    CYCLES_TSC,
+} cycle_source;
+
+typedef struct {
+    int flavor;
+    int stage;
+    int lanes;
+    uint32_t iters;
+    double ns_per_op;
+    double ns_per_op_median;
+    double cycles_per_op; /* < 0 when no cycle source */
+} stage_result;
+
+static int g_perf_fd = -1;
+static cycle_source g_cycles = CYCLES_NONE;
+
+static void cycles_init(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    g_perf_fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if (g_perf_fd >= 0) {
+        ioctl(g_perf_fd, PERF_EVENT_IOC_ENABLE, 0);
+        g_cycles = CYCLES_PERF;
+        return;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    g_cycles = CYCLES_TSC;
+#endif
+}
+
+static uint64_t cycles_now(void) {
+    switch (g_cycles) {
+        case CYCLES_PERF: {
+            uint64_t v = 0;
+            if (read(g_perf_fd, &v, sizeof(v)) != (ssize_t)sizeof(v))
+                return 0;
+            return v;
+        }
+#if defined(__x86_64__) || defined(__i386__)
+        case CYCLES_TSC:
+            return __rdtsc();
+#endif
+        default:
+            return 0;
+    }
+}
+
+static const char *cycles_label(void) {
+    switch (g_cycles) {
+        case CYCLES_PERF:
+            return "perf_cpu_cycles";
+        case CYCLES_TSC:
+            return "tsc";
+        default:
+            return "none";
+    }
+}
+
+static int parse_stage(const char *s) {
+    for (int st = 0; st < CPU_STAGE_COUNT; st++) {
+        if (strcmp(s, cpu_stage_label(st)) == 0)
+            return st;
+    }
+    return -1;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    const double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Returns 0 when the flavor has no such stage. */
+static int measure(int flavor, int stage, double min_rep_sec, int reps, stage_result *out) {
+    static uint32_t sink;
+    /* Calibrate: grow the iteration count until one repetition lasts at least min_rep_sec. */
+    uint32_t iters = 256;
+    int lanes;
+    for (;;) {
+        const double t0 = bench_now_sec();
+        lanes = cpu_sha_stage_bench(flavor, stage, kGenesisHeader76, kDiff1Target, iters, &sink);
+        const double dt = bench_now_sec() - t0;
+        if (lanes < 0)
+            return 0;
+        if (dt >= min_rep_sec || iters >= STAGES_MAX_ITERS)
+            break;
+        const double scale = dt > 0.0 ? (min_rep_sec * 1.2) / dt : 16.0;
+        const double next = (double)iters * (scale > 16.0 ? 16.0 : (scale < 2.0 ? 2.0 : scale));
+        iters = next >= (double)STAGES_MAX_ITERS ? STAGES_MAX_ITERS : (uint32_t)next;
+    }
+
+    double ns[STAGES_MAX_REPS];
+    double best_ns = -1.0;
+    double best_cycles = -1.0;
+    for (int r = 0; r < reps; r++) {
+        const uint64_t c0 = cycles_now();
+        const double t0 = bench_now_sec();
+        cpu_sha_stage_bench(flavor, stage, kGenesisHeader76, kDiff1Target, iters, &sink);
+        const double t1 = bench_now_sec();
+        const uint64_t c1 = cycles_now();
+        ns[r] = (t1 - t0) * 1e9 / (double)iters;
+        if (best_ns < 0.0 || ns[r] < best_ns) {
+            best_ns = ns[r];
+            best_cycles = g_cycles != CYCLES_NONE ? (double)(c1 - c0) / (double)iters : -1.0;
+        }
+    }
+    qsort(ns, (size_t)reps, sizeof(ns[0]), cmp_double);
+
+    out->flavor = flavor;
+    out->stage = stage;
+    out->lanes = lanes;
+    out->iters = iters;
+    out->ns_per_op = best_ns;
+    out->ns_per_op_median = ns[reps / 2];
+    out->cycles_per_op = best_cycles;
+    return 1;
+}
+
+static void json_number_or_null(FILE *f, double v) {
+    if (v < 0.0)
+        fputs("null", f);
+    else
+        fprintf(f, "%.3f", v);
+}
+
+static void write_json(FILE *f, int reps, double min_rep_sec, int cpu, const stage_result *res, int nres) {
+    fprintf(f, "{\n  \"schema\": \"minerstages-1\",\n  \"arch\": \"%s\",\n  \"compiler\": \"%s\",\n", bench_build_arch(),
+        __VERSION__);
+    fprintf(f, "  \"cycle_source\": \"%s\",\n  \"reps\": %d,\n  \"min_rep_ms\": %.1f,\n  \"cpu\": %d,\n  \"results\": [\n",
+        cycles_label(), reps, min_rep_sec * 1e3, cpu);
+    for (int i = 0; i < nres; i++) {
+        const stage_result *r = &res[i];
+        fprintf(f,
+            "    {\"flavor\": \"%s\", \"flavor_id\": %d, \"stage\": \"%s\", \"lanes\": %d, \"iters\": %u, "
+            "\"ns_per_op\": %.3f, \"ns_per_op_median\": %.3f, \"ns_per_nonce\": %.3f, \"cycles_per_op\": ",
+            cpu_sha_flavor_label(r->flavor), r->flavor, cpu_stage_label(r->stage), r->lanes, r->iters, r->ns_per_op,
+            r->ns_per_op_median, r->ns_per_op / r->lanes);
+        json_number_or_null(f, r->cycles_per_op);
+        fputs(", \"cycles_per_nonce\": ", f);
+        json_number_or_null(f, r->cycles_per_op < 0.0 ? -1.0 : r->cycles_per_op / r->lanes);
+        fprintf(f, "}%s\n", i + 1 < nres ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+static void usage(void) {
+    fprintf(stderr,
+        "usage: minerstages [--ms N] [--reps N] [--flavor NAME|ID]... [--stage NAME]... [--cpu N] [--json FILE|-]\n"
+        "stages: midstate first_hash second_hash digest_serialise target_check double_hash\n");
+}
+
+int main(int argc, char **argv) {
+    double min_rep_ms = 50.0;
+    int reps = 7;
+    int flavors[CPU_SHA_FLAVOR_COUNT];
+    int nflavors = 0;
+    int stages[CPU_STAGE_COUNT];
+    int nstages = 0;
+    int cpu = -1;
+    const char *json_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(a, "--ms") == 0 && v) {
+            min_rep_ms = atof(v);
+            i++;
+        } else if (strcmp(a, "--reps") == 0 && v) {
+            reps = atoi(v);
+            i++;
+        } else if (strcmp(a, "--flavor") == 0 && v) {
+            int f = bench_parse_flavor(v);
+            if (f < 0 || nflavors >= CPU_SHA_FLAVOR_COUNT) {
+                fprintf(stderr, "minerstages: unknown flavor '%s'\n", v);
+                return 2;
+            }
+            flavors[nflavors++] = f;
+            i++;
+        } else if (strcmp(a, "--stage") == 0 && v) {
+            int st = parse_stage(v);
+            if (st < 0 || nstages >= CPU_STAGE_COUNT) {
+                fprintf(stderr, "minerstages: unknown stage '%s'\n", v);
+                return 2;
+            }
+            stages[nstages++] = st;
+            i++;
+        } else if (strcmp(a, "--cpu") == 0 && v) {
+            cpu = atoi(v);
+            i++;
+        } else if (strcmp(a, "--json") == 0 && v) {
+            json_path = v;
+            i++;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (min_rep_ms <= 0.0 || reps < 1 || reps > STAGES_MAX_REPS) {
+        usage();
+        return 2;
+    }
+    if (cpu >= 0) {
+        /* Pin so big.LITTLE migrations do not mix core types within one measurement. */
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+            fprintf(stderr, "minerstages: cannot pin to cpu %d (%s)\n", cpu, strerror(errno));
+            return 1;
+        }
+    }
+    if (nflavors == 0) {
+        for (int f = 0; f < CPU_SHA_FLAVOR_COUNT; f++) {
+            if (cpu_sha_flavor_supported(f))
+                flavors[nflavors++] = f;
+        }
+    }
+    if (nstages == 0) {
+        for (int st = 0; st < CPU_STAGE_COUNT; st++)
+            stages[nstages++] = st;
+    }
+    cycles_init();
+
+    stage_result results[CPU_SHA_FLAVOR_COUNT * CPU_STAGE_COUNT];
+    int nres = 0;
+    printf("cycle source: %s\n", cycles_label());
+    printf("%-18s %-17s %5s %12s %12s %12s %12s\n", "flavor", "stage", "lanes", "ns/op", "median", "ns/nonce",
+        "cyc/nonce");
+    for (int fi = 0; fi < nflavors; fi++) {
+        const int f = flavors[fi];
+        if (!cpu_sha_flavor_supported(f)) {
+            printf("%-18s skipped (not supported on this CPU/build)\n", cpu_sha_flavor_label(f));
+            continue;
+        }
+        for (int si = 0; si < nstages; si++) {
+            stage_result *r = &results[nres];
+            if (!measure(f, stages[si], min_rep_ms * 1e-3, reps, r))
+                continue;
+            printf("%-18s %-17s %5d %12.2f %12.2f %12.2f ", cpu_sha_flavor_label(f), cpu_stage_label(r->stage),
+                r->lanes, r->ns_per_op, r->ns_per_op_median, r->ns_per_op / r->lanes);
+            if (r->cycles_per_op >= 0.0)
+                printf("%12.1f\n", r->cycles_per_op / r->lanes);
+            else
+                printf("%12s\n", "-");
+            fflush(stdout);
+            nres++;
+        }
+    }
+
+    if (json_path) {
+        FILE *f = strcmp(json_path, "-") == 0 ? stdout : fopen(json_path, "w");
+        if (!f) {
+            fprintf(stderr, "minerstages: cannot write %s (%s)\n", json_path, strerror(errno));
+            return 1;
+        }
+        write_json(f, reps, min_rep_ms * 1e-3, cpu, results, nres);
+        if (f != stdout)
+            fclose(f);
+    }
+    return nres > 0 ? 0 : 1;
+}
@@ -1,7 +1,7 @@
 #include "btc_header_sha256.h"
+#include "miner_log.h"
 #include "sha256.h"
 
-#include <android/log.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -0,0 +1,79 @@
+/*
+ * Runtime CPU feature detection for flavor gating (see cpu_sha_flavor_supported).
+ */
+
+#include "cpu_features.h"
+
+#include <stdatomic.h>
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#elif defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+/* Detected bits | CPU_FEATURES_VALID; 0 until the first call. Detection is idempotent, so racing is fine. */
+#define CPU_FEATURES_VALID (1u << 31)
+static atomic_uint g_cpu_features = 0;
+
+#if defined(__x86_64__)
+/* XCR0 state-enable bits: SSE | AVX (YMM), plus opmask | ZMM_Hi256 | Hi16_ZMM for AVX-512. */
+#define XCR0_YMM 0x06u
+#define XCR0_ZMM 0xE6u
+
+static uint32_t read_xcr0(void) {
+    uint32_t lo, hi;
+    __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    (void)hi;
+    return lo;
+}
+#endif
+
+static uint32_t detect_cpu_features(void) {
+    uint32_t f = 0;
+#if defined(__aarch64__) && defined(__linux__)
+    const unsigned long hw = getauxval(AT_HWCAP);
+    if (hw & HWCAP_ASIMD)
+        f |= CPU_FEATURE_ARM_ASIMD;
+    if (hw & HWCAP_SHA2)
+        f |= CPU_FEATURE_ARM_SHA2;
+    if ((hw & HWCAP_ASIMD) && (hw & HWCAP_SHA3))
+        f |= CPU_FEATURE_ARM_SHA3;
+#elif defined(__aarch64__)
+    f |= CPU_FEATURE_ARM_ASIMD;
+#elif defined(__x86_64__)
+    unsigned int eax, ebx, ecx, edx;
+    uint32_t xcr0 = 0;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        if (ecx & bit_SSSE3)
+            f |= CPU_FEATURE_X86_SSSE3;
+        if (ecx & bit_SSE4_1)
+            f |= CPU_FEATURE_X86_SSE41;
+        /* XGETBV only exists once the OS has enabled XSAVE. */
+        if ((ecx & bit_OSXSAVE) && (ecx & bit_AVX))
+            xcr0 = read_xcr0();
+    }
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        /* SHA-NI kernels also use SSSE3 (pshufb) and SSE4.1 (pblendw). */
+        if ((ebx & bit_SHA) && (f & CPU_FEATURE_X86_SSSE3) && (f & CPU_FEATURE_X86_SSE41))
+            f |= CPU_FEATURE_X86_SHANI;
+        if ((ebx & bit_AVX2) && (xcr0 & XCR0_YMM) == XCR0_YMM)
+            f |= CPU_FEATURE_X86_AVX2;
+        if ((ebx & bit_AVX512F) && (ebx & bit_AVX512BW) && (xcr0 & XCR0_ZMM) == XCR0_ZMM)
+            f |= CPU_FEATURE_X86_AVX512;
+        if ((f & CPU_FEATURE_X86_AVX512) && (ebx & bit_AVX512VL))
+            f |= CPU_FEATURE_X86_AVX512VL;
+    }
+#endif
+    return f;
+}
+
+uint32_t cpu_features(void) {
+    uint32_t f = atomic_load_explicit(&g_cpu_features, memory_order_relaxed);
+    if (!(f & CPU_FEATURES_VALID)) {
+        f = detect_cpu_features() | CPU_FEATURES_VALID;
+        atomic_store_explicit(&g_cpu_features, f, memory_order_relaxed);
+    }
+    return f & ~CPU_FEATURES_VALID;
+}
@@ -0,0 +1,23 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+#include <stdint.h>
+
+/* Runtime CPU feature bits (AT_HWCAP on AArch64, CPUID/XGETBV on x86_64); gate SIMD flavors on these. */
+#define CPU_FEATURE_ARM_ASIMD (1u << 0)
+#define CPU_FEATURE_ARM_SHA2 (1u << 1)
+/* ARMv8.2-A SHA3 (EOR3 / BCAX / XAR); selects the sha3 builds of the NEON lane kernels. */
+#define CPU_FEATURE_ARM_SHA3 (1u << 2)
+#define CPU_FEATURE_X86_SSSE3 (1u << 8)
+#define CPU_FEATURE_X86_SSE41 (1u << 9)
+#define CPU_FEATURE_X86_SHANI (1u << 10)
+/* AVX2 / AVX-512 (F+BW) usable: CPU support and the OS saves the YMM / ZMM state (XCR0). */
+#define CPU_FEATURE_X86_AVX2 (1u << 11)
+#define CPU_FEATURE_X86_AVX512 (1u << 12)
+/* AVX-512VL on top of CPU_FEATURE_X86_AVX512: EVEX rotates / vpternlogd on 128- and 256-bit vectors. */
+#define CPU_FEATURE_X86_AVX512VL (1u << 13)
+
+/** Feature bits of the running CPU; detected once, then cached. */
+uint32_t cpu_features(void);
+
+#endif
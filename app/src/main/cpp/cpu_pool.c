@@ -0,0 +1,704 @@
+/*
+ * Native CPU worker pool. The engine submits one job per round; workers split its nonce range into
+ * CPU_POOL_UNIT-nonce units, one contiguous run per worker, claim a few units at a time and a worker that
+ * runs dry steals half of the largest run left, so no thread idles at the end of a round while another
+ * still has work. Hits go
+ * through a bounded lock-free queue (Vyukov MPMC ring) and the engine drains it together with the
+ * counters, so the hashing threads never cross JNI.
+ *
+ * Each worker's scans poll its own stop flag and the global CPU job epoch (cpu_scan_cancel_all), so a
+ * new job, cancel or clean_jobs interrupt stops every worker inside CPU_SCAN_POLL_NONCES nonces.
+ *
+ * Jobs arrive prepared (miner_job.h): every chunk of every worker scans the same midstate and kernel
+ * image, and the job is freed once the pool has moved on and the last worker has left it.
+ *
+ * cpu_pool_extend adds ranges to the running job (as runs only thieves take from, waking workers that had
+ * finished) and cpu_pool_steal hands the upper half of the largest run to another device, so the pool can
+ * share one job's nonce space with the GPU (the engine's NonceScheduler).
+ *
+ * On big.LITTLE SoCs the workers come in groups, one per core cluster: pinned there so they do not
+ * migrate between clusters, each group with its own flavor and claim size, and runs sized by the group's
+ * per-thread speed so the little cores' share ends about when the big cores' does.
+ *
+ * A template job (cpu_pool_submit_template) has no shared range at all: each worker owns an extranonce2
+ * sequence, builds its own header from the template, scans all of its nonces and moves straight on to its
+ * next extranonce2, so the pool never drains at a round boundary and workers share nothing but the hit
+ * queue until the job is replaced.
+ */
+
+#define _GNU_SOURCE
+
+#include "cpu_pool.h"
+
+#include "cpu_topology.h"
+#include "miner_log.h"
+#include "miner_template.h"
+#include "sha256_scan.h"
+#include "uint256.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LOG_TAG "CPU_Pool"
+
+/* Hit slots per scan_nonces_job call; a full buffer just resumes after its last hit. */
+#define POOL_SCAN_HITS 16
+
+/*
+ * A run of units as one CAS-able word: job generation (top 16 bits), next unit and end unit (exclusive),
+ * 24 bits each. Units are absolute (unit u is nonces u * CPU_POOL_UNIT onwards), so ranges added to a
+ * job later fit the same encoding. The generation makes a CAS against a previous job's run fail instead
+ * of taking units of the new one.
+ */
+#define RANGE_GEN(r) ((uint32_t)((r) >> 48))
+#define RANGE_NEXT(r) ((uint32_t)((r) >> 24) & 0xFFFFFFu)
+#define RANGE_END(r) ((uint32_t)(r) & 0xFFFFFFu)
+#define RANGE(gen, next, end) \
+    (((uint64_t)((gen) & 0xFFFFu) << 48) | ((uint64_t)(next) << 24) | (uint64_t)(end))
+
+typedef struct {
+    _Atomic size_t seq;
+    cpu_pool_hit hit;
+} hit_slot;
+
+/* Claims above this many units would only delay a stop or pace check. */
+#define POOL_MAX_CLAIM_UNITS 256u
+/* Runs added by cpu_pool_extend that are not yet split among the workers. */
+#define POOL_SPILLS 4
+
+typedef struct {
+    uint64_t tag;
+    /*
+     * Per group: the submitted job, or one prepared from it for the group's flavor. The pool holds one
+     * reference to each while current, and each worker one to the job it scans.
+     */
+    miner_job *jobs[CPU_POOL_MAX_GROUPS];
+    /* Template job instead (jobs all NULL): referenced like [jobs], scanned with [flavor] or the group's. */
+    miner_template *tpl;
+    int flavor;
+    uint32_t en2_first;
+    uint32_t en2_stride;
+    /* cpu_scan_epoch() at submit; a later cpu_scan_cancel_all ends the job. */
+    uint32_t epoch;
+    uint32_t start;
+    uint32_t end;
+} pool_job;
+
+/*
+ * One cache line per worker: its run is CASed by thieves, the counters are read by the drainer and
+ * [stop] is written only by pool_publish (set) and by the worker itself, under the lock (cleared).
+ */
+typedef struct {
+    _Alignas(64) _Atomic uint64_t range;
+    atomic_int stop;
+    _Atomic uint64_t scanned;
+    /* Max difficulty since the last drain as double bits; positive doubles order like their bits. */
+    _Atomic uint64_t best_bits;
+    cpu_pool *pool;
+    pthread_t thread;
+    /* Fixed at create. */
+    int group;
+    uint32_t claim_units;
+    double weight;
+} pool_worker;
+
+struct cpu_pool {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    /* Under [lock]. */
+    int quit;
+    uint32_t gen;
+    int busy;
+    /* Bumped by cpu_pool_extend to wake workers that finished the current job. */
+    uint32_t ext;
+    pool_job job;
+    _Atomic uint32_t pace_ms;
+    _Atomic int error;
+    _Atomic uint32_t dropped;
+    int nice;
+    int ngroups;
+    cpu_pool_group groups[CPU_POOL_MAX_GROUPS];
+    int nworkers;
+    pool_worker *workers;
+    /* Ranges added to the current job: never claimed from directly, only stolen from like a worker's run. */
+    _Atomic uint64_t spill[POOL_SPILLS];
+    /* Drainer only. */
+    uint64_t drained_scanned;
+    _Alignas(64) _Atomic size_t q_head;
+    _Alignas(64) _Atomic size_t q_tail;
+    hit_slot q[CPU_POOL_QUEUE];
+};
+
+static int queue_push(cpu_pool *p, uint64_t tag, uint32_t nonce, uint32_t en2) {
+    size_t pos = atomic_load_explicit(&p->q_head, memory_order_relaxed);
+    for (;;) {
+        hit_slot *s = &p->q[pos & (CPU_POOL_QUEUE - 1)];
+        const size_t seq = atomic_load_explicit(&s->seq, memory_order_acquire);
+        const intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&p->q_head, &pos, pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                s->hit.tag = tag;
+                s->hit.nonce = nonce;
+                s->hit.extranonce2 = en2;
+                atomic_store_explicit(&s->seq, pos + 1, memory_order_release);
+                return 1;
+            }
+        } else if (dif < 0) {
+            return 0;
+        } else {
+            pos = atomic_load_explicit(&p->q_head, memory_order_relaxed);
+        }
+    }
+}
+
+static int queue_pop(cpu_pool *p, cpu_pool_hit *out) {
+    const size_t pos = atomic_load_explicit(&p->q_tail, memory_order_relaxed);
+    hit_slot *s = &p->q[pos & (CPU_POOL_QUEUE - 1)];
+    const size_t seq = atomic_load_explicit(&s->seq, memory_order_acquire);
+    if ((intptr_t)seq - (intptr_t)(pos + 1) < 0)
+        return 0;
+    *out = s->hit;
+    atomic_store_explicit(&s->seq, pos + CPU_POOL_QUEUE, memory_order_release);
+    atomic_store_explicit(&p->q_tail, pos + 1, memory_order_relaxed);
+    return 1;
+}
+
+/* Claims up to the worker's claim size from its own run: [*unit] onwards, [*count] units. */
+static int take_chunk(pool_worker *w, uint32_t gen, uint32_t *unit, uint32_t *count) {
+    uint64_t r = atomic_load_explicit(&w->range, memory_order_acquire);
+    while (RANGE_GEN(r) == (gen & 0xFFFFu) && RANGE_NEXT(r) < RANGE_END(r)) {
+        const uint32_t left = RANGE_END(r) - RANGE_NEXT(r);
+        const uint32_t n = left < w->claim_units ? left : w->claim_units;
+        if (atomic_compare_exchange_weak_explicit(&w->range, &r, r + ((uint64_t)n << 24), memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+            *unit = RANGE_NEXT(r);
+            *count = n;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Largest non-empty run of job [gen] other than [own], a worker's or a spill, read into [*r]; else NULL. */
+static _Atomic uint64_t *largest_run(cpu_pool *p, const _Atomic uint64_t *own, uint32_t gen, uint64_t *r) {
+    _Atomic uint64_t *victim = NULL;
+    uint32_t most = 0;
+    for (int i = 0; i < p->nworkers + POOL_SPILLS; i++) {
+        _Atomic uint64_t *run = i < p->nworkers ? &p->workers[i].range : &p->spill[i - p->nworkers];
+        if (run == own)
+            continue;
+        const uint64_t v = atomic_load_explicit(run, memory_order_acquire);
+        if (RANGE_GEN(v) != (gen & 0xFFFFu) || RANGE_NEXT(v) >= RANGE_END(v))
+            continue;
+        if (RANGE_END(v) - RANGE_NEXT(v) > most) {
+            most = RANGE_END(v) - RANGE_NEXT(v);
+            victim = run;
+            *r = v;
+        }
+    }
+    return victim;
+}
+
+/* Moves the upper half of the largest run of job [gen] into [w]'s (exhausted) run; 0 when none is left. */
+static int steal_run(cpu_pool *p, pool_worker *w, uint32_t gen) {
+    for (;;) {
+        uint64_t vr = 0;
+        _Atomic uint64_t *victim = largest_run(p, &w->range, gen, &vr);
+        if (!victim)
+            return 0;
+        const uint32_t split = RANGE_END(vr) - (RANGE_END(vr) - RANGE_NEXT(vr) + 1u) / 2u;
+        if (!atomic_compare_exchange_strong_explicit(victim, &vr, RANGE(gen, RANGE_NEXT(vr), split),
+                                                     memory_order_acq_rel, memory_order_acquire))
+            continue;
+        /* Nobody steals from an empty run, so this only fails when a new job replaced ours; drop the chunks. */
+        uint64_t mine = atomic_load_explicit(&w->range, memory_order_acquire);
+        return RANGE_GEN(mine) == (gen & 0xFFFFu) &&
+               atomic_compare_exchange_strong_explicit(&w->range, &mine, RANGE(gen, split, RANGE_END(vr)),
+                                                       memory_order_acq_rel, memory_order_acquire);
+    }
+}
+
+/* Nonces [*lo, *hi] of units [first, first + count); a partial first or last unit of the submitted range is clipped. */
+static void unit_nonces(const pool_job *job, uint32_t first, uint32_t count, uint64_t *lo, uint64_t *hi) {
+    uint64_t a = (uint64_t)first * CPU_POOL_UNIT;
+    uint64_t b = a + (uint64_t)count * CPU_POOL_UNIT - 1u;
+    if (a < job->start && job->start <= b)
+        a = job->start;
+    if (a <= job->end && job->end < b)
+        b = job->end;
+    *lo = a;
+    *hi = b;
+}
+
+static void worker_best(pool_worker *w, double difficulty) {
+    uint64_t bits;
+    memcpy(&bits, &difficulty, sizeof(bits));
+    /* Only this worker raises it; losing a race with the drainer's exchange re-reports a lower value later. */
+    if (bits > atomic_load_explicit(&w->best_bits, memory_order_relaxed))
+        atomic_store_explicit(&w->best_bits, bits, memory_order_relaxed);
+}
+
+/* Sleeps the pace interval unless the job changes first; 0 when it did (or the pool is shutting down). */
+static int worker_pace(cpu_pool *p, uint32_t gen) {
+    const uint32_t ms = atomic_load_explicit(&p->pace_ms, memory_order_relaxed);
+    if (ms == 0)
+        return 1;
+    struct timespec until;
+    clock_gettime(CLOCK_MONOTONIC, &until);
+    until.tv_sec += (time_t)(ms / 1000u);
+    until.tv_nsec += (long)(ms % 1000u) * 1000000L;
+    if (until.tv_nsec >= 1000000000L) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000L;
+    }
+    pthread_mutex_lock(&p->lock);
+    while (!p->quit && p->gen == gen && pthread_cond_timedwait(&p->wake, &p->lock, &until) != ETIMEDOUT) {
+    }
+    const int same = !p->quit && p->gen == gen;
+    pthread_mutex_unlock(&p->lock);
+    return same;
+}
+
+/*
+ * Scans nonces [from, hi] of [mj], queueing hits with the job's tag and [en2]; 0 when the worker must
+ * leave the job (stopped, interrupted or its flavor failed).
+ */
+static int worker_scan(pool_worker *w, const pool_job *job, const miner_job *mj, uint64_t from, uint64_t hi,
+                       uint32_t en2) {
+    cpu_pool *p = w->pool;
+    uint32_t nonces[POOL_SCAN_HITS];
+    const cpu_scan_cancel cancel = {.epoch = job->epoch, .stop = &w->stop};
+    while (from <= hi) {
+        cpu_scan_hits hits = {.nonces = nonces, .cap = POOL_SCAN_HITS, .cancel = &cancel};
+        const int r = scan_nonces_job(mj, (uint32_t)from, (uint32_t)hi, &hits);
+        if (r == CPU_SHA_FLAVOR_ERROR) {
+            atomic_store_explicit(&p->error, r, memory_order_relaxed);
+            return 0;
+        }
+        for (uint32_t i = 0; i < hits.count; i++) {
+            if (!queue_push(p, job->tag, nonces[i], en2))
+                atomic_fetch_add_explicit(&p->dropped, 1u, memory_order_relaxed);
+        }
+        if (hits.scanned > 0) {
+            atomic_fetch_add_explicit(&w->scanned, hits.scanned, memory_order_relaxed);
+            worker_best(w, uint256_difficulty_from_hash(hits.best_hash));
+        }
+        if (r == CPU_SCAN_INTERRUPTED)
+            return 0;
+        if (hits.scanned == 0)
+            break;
+        from += hits.scanned;
+    }
+    return !atomic_load_explicit(&w->stop, memory_order_relaxed);
+}
+
+/* Counts [n] scanned nonces towards the next pace sleep; 0 when the job changed during it. */
+static int worker_paced(pool_worker *w, uint32_t gen, uint64_t *since_pace, uint64_t n) {
+    *since_pace += n;
+    if (*since_pace < CPU_POOL_PACE_NONCES)
+        return 1;
+    *since_pace = 0;
+    return worker_pace(w->pool, gen);
+}
+
+static void worker_run(pool_worker *w, uint32_t gen, const pool_job *job, const miner_job *mj) {
+    cpu_pool *p = w->pool;
+    uint64_t since_pace = 0;
+    uint32_t unit;
+    uint32_t count;
+    while (take_chunk(w, gen, &unit, &count) || (steal_run(p, w, gen) && take_chunk(w, gen, &unit, &count))) {
+        uint64_t from;
+        uint64_t hi;
+        unit_nonces(job, unit, count, &from, &hi);
+        if (!worker_scan(w, job, mj, from, hi, 0u) || !worker_paced(w, gen, &since_pace, hi - from + 1u))
+            return;
+    }
+}
+
+/*
+ * Template job: worker [index] mines extranonce2 en2_first + index, then + en2_stride after each header,
+ * nonces start..end of every header in claims of its group's size, until the job changes.
+ */
+static void worker_run_template(pool_worker *w, uint32_t gen, const pool_job *job, int index) {
+    const int group_flavor = w->pool->groups[w->group].flavor;
+    const int flavor = group_flavor != MINER_JOB_NO_FLAVOR ? group_flavor : job->flavor;
+    const uint64_t claim = (uint64_t)w->claim_units * CPU_POOL_UNIT;
+    uint64_t since_pace = 0;
+    miner_job mj;
+    for (uint32_t en2 = job->en2_first + (uint32_t)index;; en2 += job->en2_stride) {
+        uint8_t header76[76];
+        miner_template_header(job->tpl, en2, header76);
+        miner_job_init(&mj, header76, job->tpl->target, flavor);
+        for (uint64_t from = job->start; from <= job->end; from += claim) {
+            const uint64_t hi = from + claim - 1u < job->end ? from + claim - 1u : job->end;
+            if (!worker_scan(w, job, &mj, from, hi, en2) || !worker_paced(w, gen, &since_pace, hi - from + 1u))
+                return;
+        }
+    }
+}
+
+static void *worker_main(void *arg) {
+    pool_worker *w = (pool_worker *)arg;
+    cpu_pool *p = w->pool;
+    if (p->nice != 0 && setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), p->nice) != 0) {
+        __android_log_print(ANDROID_LOG_WARN, LOG_TAG, "setpriority(%d) failed: %d", p->nice, errno);
+    }
+    const uint64_t mask = p->groups[w->group].cpu_mask;
+    if (mask != 0) {
+        const int rc = cpu_topology_pin_self(mask);
+        if (rc != 0) {
+            __android_log_print(ANDROID_LOG_WARN, LOG_TAG, "group %d: pinning to 0x%llx failed: %d", w->group,
+                (unsigned long long)mask, rc);
+        }
+    }
+    uint32_t gen = 0;
+    uint32_t ext = 0;
+    pool_job job;
+    memset(&job, 0, sizeof(job));
+    pthread_mutex_lock(&p->lock);
+    for (;;) {
+        while (!p->quit && p->gen == gen && p->ext == ext)
+            pthread_cond_wait(&p->wake, &p->lock);
+        if (p->quit)
+            break;
+        if (p->gen != gen) {
+            gen = p->gen;
+            job = p->job;
+            atomic_store_explicit(&w->stop, 0, memory_order_relaxed);
+        } else if (job.jobs[w->group]) {
+            /* cpu_pool_extend added to the job this worker had finished: busy again. */
+            p->busy++;
+        }
+        ext = p->ext;
+        miner_job *mj = job.jobs[w->group];
+        miner_template *tpl = job.tpl;
+        if (mj)
+            miner_job_retain(mj);
+        if (tpl)
+            miner_template_retain(tpl);
+        pthread_mutex_unlock(&p->lock);
+        if (tpl) {
+            worker_run_template(w, gen, &job, (int)(w - p->workers));
+            miner_template_release(tpl);
+        } else if (mj) {
+            worker_run(w, gen, &job, mj);
+            miner_job_release(mj);
+        }
+        pthread_mutex_lock(&p->lock);
+        if (p->gen == gen && p->busy > 0)
+            p->busy--;
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+/*
+ * New generation with units [first, end) of p->job split over the workers by weight (none for no job);
+ * caller holds the lock.
+ */
+static void pool_publish(cpu_pool *p, uint32_t first, uint32_t end) {
+    p->gen++;
+    double total = 0.0;
+    for (int i = 0; i < p->nworkers; i++)
+        total += p->workers[i].weight;
+    const uint32_t nunits = end - first;
+    double cum = 0.0;
+    uint32_t a = first;
+    for (int i = 0; i < p->nworkers; i++) {
+        cum += p->workers[i].weight;
+        const uint32_t b = i + 1 == p->nworkers ? end : first + (uint32_t)((double)nunits * cum / total);
+        atomic_store_explicit(&p->workers[i].stop, 1, memory_order_relaxed);
+        atomic_store_explicit(&p->workers[i].range, RANGE(p->gen, a, b), memory_order_release);
+        a = b;
+    }
+    for (int s = 0; s < POOL_SPILLS; s++)
+        atomic_store_explicit(&p->spill[s], RANGE(p->gen, 0u, 0u), memory_order_release);
+    p->busy = p->job.jobs[0] || p->job.tpl ? p->nworkers : 0;
+    pthread_cond_broadcast(&p->wake);
+}
+
+/* Moves the current job's references into [old] and leaves the pool without a job; caller holds the lock. */
+static void pool_take_job(cpu_pool *p, pool_job *old) {
+    *old = p->job;
+    memset(p->job.jobs, 0, sizeof(p->job.jobs));
+    p->job.tpl = NULL;
+}
+
+/* Drops the references [pool_take_job] moved into [old]; call without the lock. */
+static void release_job(const pool_job *old, int ngroups) {
+    for (int g = 0; g < ngroups; g++)
+        miner_job_release(old->jobs[g]);
+    miner_template_release(old->tpl);
+}
+
+cpu_pool *cpu_pool_create(int threads, int nice) {
+    const cpu_pool_group all = {.threads = threads < 1 ? 1 : threads, .flavor = MINER_JOB_NO_FLAVOR};
+    return cpu_pool_create_groups(&all, 1, nice);
+}
+
+cpu_pool *cpu_pool_create_groups(const cpu_pool_group *groups, int ngroups, int nice) {
+    if (ngroups > CPU_POOL_MAX_GROUPS)
+        ngroups = CPU_POOL_MAX_GROUPS;
+    int threads = 0;
+    for (int g = 0; g < ngroups; g++)
+        threads += groups[g].threads > 0 ? groups[g].threads : 0;
+    if (threads < 1)
+        return NULL;
+    if (threads > CPU_POOL_MAX_THREADS)
+        threads = CPU_POOL_MAX_THREADS;
+    void *mem = NULL;
+    if (posix_memalign(&mem, 64, sizeof(cpu_pool)) != 0)
+        return NULL;
+    cpu_pool *p = (cpu_pool *)mem;
+    memset(p, 0, sizeof(*p));
+    if (posix_memalign(&mem, 64, sizeof(pool_worker) * (size_t)threads) != 0) {
+        free(p);
+        return NULL;
+    }
+    p->workers = (pool_worker *)mem;
+    memset(p->workers, 0, sizeof(pool_worker) * (size_t)threads);
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&p->wake, &attr);
+    pthread_condattr_destroy(&attr);
+    for (size_t i = 0; i < CPU_POOL_QUEUE; i++)
+        atomic_init(&p->q[i].seq, i);
+    p->nice = nice;
+    p->ngroups = ngroups;
+    for (int g = 0, i = 0; g < ngroups; g++) {
+        cpu_pool_group *pg = &p->groups[g];
+        *pg = groups[g];
+        if (pg->flavor != MINER_JOB_NO_FLAVOR && !cpu_sha_flavor_supported(pg->flavor)) {
+            __android_log_print(ANDROID_LOG_WARN, LOG_TAG, "group %d: flavor %d unsupported; using the job's", g,
+                pg->flavor);
+            pg->flavor = MINER_JOB_NO_FLAVOR;
+        }
+        const uint32_t chunk = pg->chunk != 0 ? pg->chunk : CPU_POOL_CHUNK;
+        uint32_t units = (chunk + CPU_POOL_UNIT / 2u) / CPU_POOL_UNIT;
+        if (units < 1u)
+            units = 1u;
+        if (units > POOL_MAX_CLAIM_UNITS)
+            units = POOL_MAX_CLAIM_UNITS;
+        for (int t = 0; t < pg->threads && i < threads; t++, i++) {
+            p->workers[i].group = g;
+            p->workers[i].claim_units = units;
+            p->workers[i].weight = pg->weight > 0.0 ? pg->weight : 1.0;
+        }
+    }
+    /* Workers read nworkers only after a submit, which orders this store through the lock. */
+    int started = 0;
+    for (; started < threads; started++) {
+        p->workers[started].pool = p;
+        if (pthread_create(&p->workers[started].thread, NULL, worker_main, &p->workers[started]) != 0) {
+            __android_log_print(ANDROID_LOG_WARN, LOG_TAG, "started %d of %d workers", started, threads);
+            break;
+        }
+    }
+    p->nworkers = started;
+    if (started == 0) {
+        cpu_pool_destroy(p);
+        return NULL;
+    }
+    return p;
+}
+
+void cpu_pool_destroy(cpu_pool *p) {
+    if (!p)
+        return;
+    pthread_mutex_lock(&p->lock);
+    p->quit = 1;
+    pool_job old;
+    pool_take_job(p, &old);
+    pool_publish(p, 0u, 0u);
+    pthread_mutex_unlock(&p->lock);
+    for (int i = 0; i < p->nworkers; i++)
+        pthread_join(p->workers[i].thread, NULL);
+    release_job(&old, p->ngroups);
+    pthread_cond_destroy(&p->wake);
+    pthread_mutex_destroy(&p->lock);
+    free(p->workers);
+    free(p);
+}
+
+int cpu_pool_submit(cpu_pool *p, uint64_t tag, miner_job *job, uint32_t start, uint32_t end) {
+    if (!cpu_sha_flavor_supported(job->flavor))
+        return CPU_SHA_FLAVOR_ERROR;
+    const uint32_t first = start / CPU_POOL_UNIT;
+    const uint32_t last = end < start ? first : end / CPU_POOL_UNIT + 1u;
+    miner_job *jobs[CPU_POOL_MAX_GROUPS];
+    for (int g = 0; g < p->ngroups; g++) {
+        const int flavor = p->groups[g].flavor;
+        jobs[g] = flavor != MINER_JOB_NO_FLAVOR && flavor != job->flavor
+                      ? miner_job_create(job->header76, job->target, flavor)
+                      : NULL;
+        /* Also when out of memory: the group scans with the job's flavor. */
+        if (!jobs[g]) {
+            miner_job_retain(job);
+            jobs[g] = job;
+        }
+    }
+    pool_job old;
+    pthread_mutex_lock(&p->lock);
+    pool_take_job(p, &old);
+    memcpy(p->job.jobs, jobs, sizeof(jobs[0]) * (size_t)p->ngroups);
+    p->job.tag = tag;
+    p->job.epoch = cpu_scan_epoch();
+    p->job.start = start;
+    p->job.end = end;
+    pool_publish(p, first, last);
+    pthread_mutex_unlock(&p->lock);
+    release_job(&old, p->ngroups);
+    return 0;
+}
+
+int cpu_pool_submit_template(cpu_pool *p, uint64_t tag, miner_template *tpl, int flavor, uint32_t en2_first,
+                             uint32_t en2_stride, uint32_t nonce_start, uint32_t nonce_end) {
+    if (!cpu_sha_flavor_supported(flavor))
+        return CPU_SHA_FLAVOR_ERROR;
+    miner_template_retain(tpl);
+    pool_job old;
+    pthread_mutex_lock(&p->lock);
+    pool_take_job(p, &old);
+    p->job.tpl = tpl;
+    p->job.flavor = flavor;
+    p->job.en2_first = en2_first;
+    p->job.en2_stride = en2_stride;
+    p->job.tag = tag;
+    p->job.epoch = cpu_scan_epoch();
+    p->job.start = nonce_start;
+    p->job.end = nonce_end;
+    pool_publish(p, 0u, 0u);
+    pthread_mutex_unlock(&p->lock);
+    release_job(&old, p->ngroups);
+    return 0;
+}
+
+void cpu_pool_cancel(cpu_pool *p) {
+    pthread_mutex_lock(&p->lock);
+    pool_job old;
+    pool_take_job(p, &old);
+    pool_publish(p, 0u, 0u);
+    pthread_mutex_unlock(&p->lock);
+    release_job(&old, p->ngroups);
+}
+
+int cpu_pool_workers(cpu_pool *p) {
+    return p->nworkers;
+}
+
+int cpu_pool_extend(cpu_pool *p, uint64_t tag, uint32_t start, uint32_t end) {
+    if (end < start || start % CPU_POOL_UNIT != 0u || (end != UINT32_MAX && (end + 1u) % CPU_POOL_UNIT != 0u))
+        return 0;
+    const uint64_t run = RANGE(0u, start / CPU_POOL_UNIT, (uint32_t)(((uint64_t)end + 1u) / CPU_POOL_UNIT));
+    int added = 0;
+    pthread_mutex_lock(&p->lock);
+    if (p->job.jobs[0] && p->job.tag == tag) {
+        for (int s = 0; s < POOL_SPILLS && !added; s++) {
+            const uint64_t r = atomic_load_explicit(&p->spill[s], memory_order_acquire);
+            /* Thieves never touch an empty run, so the slot stays free until this store. */
+            if (RANGE_GEN(r) == (p->gen & 0xFFFFu) && RANGE_NEXT(r) < RANGE_END(r))
+                continue;
+            atomic_store_explicit(&p->spill[s], run | RANGE(p->gen, 0u, 0u), memory_order_release);
+            added = 1;
+        }
+        if (added) {
+            p->ext++;
+            pthread_cond_broadcast(&p->wake);
+        }
+    }
+    pthread_mutex_unlock(&p->lock);
+    return added;
+}
+
+int cpu_pool_steal(cpu_pool *p, uint64_t tag, uint32_t min_nonces, uint32_t *start, uint32_t *end) {
+    int stolen = 0;
+    pthread_mutex_lock(&p->lock);
+    if (p->job.jobs[0] && p->job.tag == tag) {
+        const uint32_t gen = p->gen;
+        for (;;) {
+            uint64_t vr = 0;
+            _Atomic uint64_t *victim = largest_run(p, NULL, gen, &vr);
+            if (!victim)
+                break;
+            const uint32_t take = (RANGE_END(vr) - RANGE_NEXT(vr) + 1u) / 2u;
+            if ((uint64_t)take * CPU_POOL_UNIT < min_nonces)
+                break;
+            const uint32_t split = RANGE_END(vr) - take;
+            if (!atomic_compare_exchange_strong_explicit(victim, &vr, RANGE(gen, RANGE_NEXT(vr), split),
+                                                         memory_order_acq_rel, memory_order_acquire))
+                continue;
+            uint64_t lo;
+            uint64_t hi;
+            unit_nonces(&p->job, split, take, &lo, &hi);
+            *start = (uint32_t)lo;
+            *end = (uint32_t)hi;
+            stolen = 1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&p->lock);
+    return stolen;
+}
+
+uint64_t cpu_pool_remaining(cpu_pool *p) {
+    pthread_mutex_lock(&p->lock);
+    const uint32_t gen = p->gen;
+    pthread_mutex_unlock(&p->lock);
+    uint64_t units = 0;
+    for (int i = 0; i < p->nworkers + POOL_SPILLS; i++) {
+        const uint64_t r = atomic_load_explicit(i < p->nworkers ? &p->workers[i].range : &p->spill[i - p->nworkers],
+                                                memory_order_acquire);
+        if (RANGE_GEN(r) == (gen & 0xFFFFu) && RANGE_NEXT(r) < RANGE_END(r))
+            units += RANGE_END(r) - RANGE_NEXT(r);
+    }
+    return units * CPU_POOL_UNIT;
+}
+
+void cpu_pool_set_pace(cpu_pool *p, uint32_t ms) {
+    atomic_store_explicit(&p->pace_ms, ms, memory_order_relaxed);
+}
+
+int cpu_pool_drain(cpu_pool *p, cpu_pool_hit *out, int max, cpu_pool_stats *stats) {
+    int n = 0;
+    while (n < max && queue_pop(p, &out[n]))
+        n++;
+    uint64_t total = 0;
+    uint64_t best = 0;
+    for (int i = 0; i < p->nworkers; i++) {
+        total += atomic_load_explicit(&p->workers[i].scanned, memory_order_relaxed);
+        const uint64_t b = atomic_exchange_explicit(&p->workers[i].best_bits, 0, memory_order_relaxed);
+        if (b > best)
+            best = b;
+    }
+    stats->scanned = total - p->drained_scanned;
+    p->drained_scanned = total;
+    memcpy(&stats->best_difficulty, &best, sizeof(best));
+    pthread_mutex_lock(&p->lock);
+    stats->busy = p->busy;
+    pthread_mutex_unlock(&p->lock);
+    stats->dropped = atomic_exchange_explicit(&p->dropped, 0u, memory_order_relaxed);
+    stats->error = atomic_exchange_explicit(&p->error, 0, memory_order_relaxed);
+    return n;
+}
+
+int cpu_pool_group_scanned(cpu_pool *p, uint64_t *out, int max) {
+    const int n = p->ngroups < max ? p->ngroups : max;
+    for (int g = 0; g < n; g++)
+        out[g] = 0;
+    for (int i = 0; i < p->nworkers; i++) {
+        if (p->workers[i].group < n)
+            out[p->workers[i].group] += atomic_load_explicit(&p->workers[i].scanned, memory_order_relaxed);
+    }
+    return n;
+}
@@ -0,0 +1,136 @@
+#ifndef CPU_POOL_H
+#define CPU_POOL_H
+
+#include "miner_job.h"
+#include "miner_template.h"
+
+#include <stdint.h>
+
+/* Granularity of a job's nonce range: claims, steals and the initial split are whole units. */
+#define CPU_POOL_UNIT (1u << 14)
+/* Default nonces per claim (what a worker takes from its run at once). */
+#define CPU_POOL_CHUNK (1u << 16)
+/* Pacing sleeps once per this many nonces per worker (the engine's former per-thread chunk). */
+#define CPU_POOL_PACE_NONCES (1u << 21)
+/* Hit queue slots; the engine drains every status interval, so this only fills if draining stalls. */
+#define CPU_POOL_QUEUE 1024
+#define CPU_POOL_MAX_THREADS 64
+#define CPU_POOL_MAX_GROUPS 8
+
+typedef struct cpu_pool cpu_pool;
+
+/**
+ * One winning nonce and the tag of the job it belongs to (cpu_pool_submit); for a template job also the
+ * extranonce2 of the header it was found in (0 otherwise).
+ */
+typedef struct {
+    uint64_t tag;
+    uint32_t nonce;
+    uint32_t extranonce2;
+} cpu_pool_hit;
+
+/** Snapshot returned by cpu_pool_drain; counters are deltas since the previous drain. */
+typedef struct {
+    uint64_t scanned;
+    /* Difficulty of the lowest hash scanned since the previous drain; 0 when none. */
+    double best_difficulty;
+    /* Workers still on the current job; 0 once it is finished or cancelled. */
+    int busy;
+    /* Hits lost to a full queue since the previous drain. */
+    uint32_t dropped;
+    /* CPU_SHA_FLAVOR_ERROR if a worker's flavor failed since the previous drain, else 0. */
+    int error;
+} cpu_pool_stats;
+
+/**
+ * Workers of one core cluster (cpu_topology.h). [cpu_mask] pins them there (0: the scheduler places
+ * them). [flavor] is the kernel they scan with, MINER_JOB_NO_FLAVOR for the job's own; a flavor this CPU
+ * cannot run falls back to the job's. [chunk] is nonces per claim, rounded to CPU_POOL_UNIT (0:
+ * CPU_POOL_CHUNK). [weight] is the per-thread speed relative to the other groups (e.g. calibrated H/s)
+ * and sizes each worker's initial share of a job; <= 0 counts as 1.
+ */
+typedef struct {
+    uint64_t cpu_mask;
+    int threads;
+    int flavor;
+    uint32_t chunk;
+    double weight;
+} cpu_pool_group;
+
+/**
+ * Starts [threads] native workers (clamped to 1..CPU_POOL_MAX_THREADS) at nice value [nice] (Android
+ * thread priorities are nice values), as one unpinned group scanning with the job's flavor. They idle
+ * until cpu_pool_submit. NULL when no thread could start.
+ */
+cpu_pool *cpu_pool_create(int threads, int nice);
+
+/**
+ * Like cpu_pool_create with one set of workers per group (at most CPU_POOL_MAX_GROUPS; the thread total
+ * is capped at CPU_POOL_MAX_THREADS). Each worker pins itself to its group's mask before taking work.
+ */
+cpu_pool *cpu_pool_create_groups(const cpu_pool_group *groups, int ngroups, int nice);
+
+/** Cancels the current job, joins every worker and frees the pool. */
+void cpu_pool_destroy(cpu_pool *pool);
+
+/**
+ * Replaces the current job: nonces [start, end] of job->header76 || nonce, scanned with job->flavor (or
+ * a group's own flavor, prepared here from the same header), are split into one contiguous range per
+ * worker in proportion to the group weights, and a worker that runs dry steals half of the largest
+ * remaining range. Every hit is queued with [tag]. The pool takes its own reference to [job] (the caller
+ * keeps or releases its one) and drops it when the job is replaced or cancelled. Workers on the previous
+ * job stop within CPU_SCAN_POLL_NONCES nonces, so a few hits of the old tag can still arrive after this
+ * returns. cpu_scan_cancel_all (cpuRequestInterrupt) ends the job like cpu_pool_cancel. Returns 0, or
+ * CPU_SHA_FLAVOR_ERROR for an unusable flavor.
+ */
+int cpu_pool_submit(cpu_pool *pool, uint64_t tag, miner_job *job, uint32_t start, uint32_t end);
+
+/**
+ * Replaces the current job with one that has no shared nonce range: worker i (0..cpu_pool_workers - 1)
+ * mines headers built from [tpl] (miner_template.h) for extranonce2 en2_first + i, en2_first + i +
+ * en2_stride and so on, nonces [nonce_start, nonce_end] of each (0..UINT32_MAX: the whole space; the
+ * range must not be empty), until the job is replaced or cancelled. Workers never wait for each other,
+ * so busy stays at the worker count meanwhile. [en2_stride] must be at least cpu_pool_workers so the
+ * sequences do not overlap; the values in between are free for another device. Scans use [flavor] (or
+ * a group's own); hits carry the header's extranonce2. The pool takes its own reference to [tpl].
+ * Returns 0, or CPU_SHA_FLAVOR_ERROR for an unusable flavor.
+ */
+int cpu_pool_submit_template(cpu_pool *pool, uint64_t tag, miner_template *tpl, int flavor, uint32_t en2_first,
+                             uint32_t en2_stride, uint32_t nonce_start, uint32_t nonce_end);
+
+/** Drops the rest of the current job and the pool's reference to it; every worker stops within CPU_SCAN_POLL_NONCES nonces. */
+void cpu_pool_cancel(cpu_pool *pool);
+
+/**
+ * Adds nonces [start, end] to the current job if its tag is still [tag]: whole CPU_POOL_UNITs, none of
+ * them overlapping the units the job already covers. Workers steal from it as from any run, including
+ * workers that had already finished the job. 1 when added; 0 when the job changed, the range is not whole
+ * units, or too many added ranges are still untouched.
+ */
+int cpu_pool_extend(cpu_pool *pool, uint64_t tag, uint32_t start, uint32_t end);
+
+/**
+ * Takes the upper half of the largest run left in job [tag] for another device into [*start, *end].
+ * 0 when the job changed or that half would be under [min_nonces].
+ */
+int cpu_pool_steal(cpu_pool *pool, uint64_t tag, uint32_t min_nonces, uint32_t *start, uint32_t *end);
+
+/** Nonces of the current job no worker has claimed yet (a racy snapshot). */
+uint64_t cpu_pool_remaining(cpu_pool *pool);
+
+/** Worker threads that started (at most the count asked for). */
+int cpu_pool_workers(cpu_pool *pool);
+
+/** Each worker sleeps [ms] after every CPU_POOL_PACE_NONCES nonces (intensity / thermal throttle); 0 = none. */
+void cpu_pool_set_pace(cpu_pool *pool, uint32_t ms);
+
+/**
+ * Moves up to [max] queued hits into [out] (returns how many) and fills [stats]. Hits beyond [max] stay
+ * queued for the next call. Meant for one draining thread at a time.
+ */
+int cpu_pool_drain(cpu_pool *pool, cpu_pool_hit *out, int max, cpu_pool_stats *stats);
+
+/** Nonces each group has hashed since the pool started, in group order; returns the group count (at most [max]). */
+int cpu_pool_group_scanned(cpu_pool *pool, uint64_t *out, int max);
+
+#endif
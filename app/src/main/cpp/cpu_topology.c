@@ -0,0 +1,110 @@
+/*
+ * CPU cluster discovery from sysfs. big.LITTLE / DynamIQ core types differ in cpu_capacity (the
+ * scheduler's relative performance) and in cpuinfo_max_freq, so CPUs sharing both form a cluster.
+ */
+
+#define _GNU_SOURCE
+
+#include "cpu_topology.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <stdio.h>
+#include <unistd.h>
+
+static int read_cpu_u32(const char *fmt, int cpu, uint32_t *out) {
+    char path[96];
+    snprintf(path, sizeof(path), fmt, cpu);
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return 0;
+    unsigned long v = 0;
+    const int ok = fscanf(f, "%lu", &v) == 1;
+    fclose(f);
+    if (ok)
+        *out = (uint32_t)v;
+    return ok;
+}
+
+static int cpu_online(int cpu) {
+    uint32_t v = 1;
+    /* cpu0 usually has no "online" file because it cannot be hotplugged. */
+    if (!read_cpu_u32("/sys/devices/system/cpu/cpu%d/online", cpu, &v))
+        return 1;
+    return v != 0;
+}
+
+/* Fastest first; ties keep CPU order. */
+static int cluster_before(const cpu_cluster *a, const cpu_cluster *b) {
+    if (a->capacity != b->capacity)
+        return a->capacity > b->capacity;
+    if (a->max_khz != b->max_khz)
+        return a->max_khz > b->max_khz;
+    return a->first_cpu < b->first_cpu;
+}
+
+int cpu_topology_clusters(cpu_cluster *out, int max) {
+    if (!out || max < 1)
+        return 0;
+    long conf = sysconf(_SC_NPROCESSORS_CONF);
+    if (conf < 1)
+        conf = 1;
+    if (conf > CPU_TOPOLOGY_MAX_CPUS)
+        conf = CPU_TOPOLOGY_MAX_CPUS;
+    int n = 0;
+    for (int cpu = 0; cpu < (int)conf; cpu++) {
+        if (!cpu_online(cpu))
+            continue;
+        uint32_t capacity = 0, khz = 0;
+        read_cpu_u32("/sys/devices/system/cpu/cpu%d/cpu_capacity", cpu, &capacity);
+        read_cpu_u32("/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", cpu, &khz);
+        int c = 0;
+        while (c < n && (out[c].capacity != capacity || out[c].max_khz != khz))
+            c++;
+        if (c == n) {
+            if (n == max)
+                c = n - 1; /* more core types than slots: fold the rest into the last one */
+            else
+                out[n++] = (cpu_cluster){.first_cpu = cpu, .capacity = capacity, .max_khz = khz};
+        }
+        out[c].cpu_mask |= 1ull << cpu;
+        out[c].ncpus++;
+    }
+    if (n == 0) {
+        out[0] = (cpu_cluster){.first_cpu = 0, .ncpus = (int)conf};
+        out[0].cpu_mask = conf >= 64 ? ~0ull : (1ull << conf) - 1u;
+        return 1;
+    }
+    for (int i = 1; i < n; i++) {
+        const cpu_cluster c = out[i];
+        int j = i;
+        for (; j > 0 && cluster_before(&c, &out[j - 1]); j--)
+            out[j] = out[j - 1];
+        out[j] = c;
+    }
+    return n;
+}
+
+int cpu_topology_get_self(uint64_t *mask) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0)
+        return -errno;
+    uint64_t m = 0;
+    for (int cpu = 0; cpu < CPU_TOPOLOGY_MAX_CPUS; cpu++) {
+        if (CPU_ISSET(cpu, &set))
+            m |= 1ull << cpu;
+    }
+    *mask = m;
+    return 0;
+}
+
+int cpu_topology_pin_self(uint64_t mask) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu = 0; cpu < CPU_TOPOLOGY_MAX_CPUS; cpu++) {
+        if (mask & (1ull << cpu))
+            CPU_SET(cpu, &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0 ? 0 : -errno;
+}
@@ -0,0 +1,31 @@
+#ifndef CPU_TOPOLOGY_H
+#define CPU_TOPOLOGY_H
+
+#include <stdint.h>
+
+/* CPU masks are 64-bit, so CPUs beyond 63 are ignored (no phone comes close). */
+#define CPU_TOPOLOGY_MAX_CPUS 64
+#define CPU_TOPOLOGY_MAX_CLUSTERS 8
+
+/** Online CPUs of one core type: same cpu_capacity and cpuinfo_max_freq (0 when sysfs does not say). */
+typedef struct {
+    uint64_t cpu_mask;
+    int first_cpu;
+    int ncpus;
+    uint32_t capacity;
+    uint32_t max_khz;
+} cpu_cluster;
+
+/**
+ * Online CPUs grouped into clusters, fastest first (capacity, then max frequency). Writes at most
+ * [max] clusters into [out] and returns how many; 1 cluster of every CPU when sysfs is unreadable.
+ */
+int cpu_topology_clusters(cpu_cluster *out, int max);
+
+/** Affinity mask of the calling thread; 0 on success, negative errno otherwise. */
+int cpu_topology_get_self(uint64_t *mask);
+
+/** Pins the calling thread to [mask]; 0 on success, negative errno otherwise (e.g. CPUs offline). */
+int cpu_topology_pin_self(uint64_t mask);
+
+#endif
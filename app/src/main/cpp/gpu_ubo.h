@@ -0,0 +1,57 @@
+#ifndef GPU_UBO_H
+#define GPU_UBO_H
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Host image of miner.comp's uniform buffer. Header and midstate are stored as little-endian words so
+ * the GPU (LE) reads the same uint value as the C big-endian word; the target is raw bytes.
+ */
+#define UBO_SIZE 256
+#define UBO_HEADER_WORDS (76 / 4)
+#define UBO_OFFSET_MIDSTATE 76u
+#define UBO_OFFSET_NONCE_START (UBO_OFFSET_MIDSTATE + 32u)
+#define UBO_OFFSET_NONCE_END (UBO_OFFSET_NONCE_START + 4u)
+#define UBO_OFFSET_TARGET (UBO_OFFSET_NONCE_END + 4u)
+#define UBO_OFFSET_GPU_USE_MIDSTATE (UBO_OFFSET_TARGET + 32u)
+#define UBO_OFFSET_GPU_SELFTEST (UBO_OFFSET_GPU_USE_MIDSTATE + 4u)
+#define UBO_HOST_PAYLOAD_BYTES (UBO_OFFSET_GPU_SELFTEST + 4u)
+_Static_assert(UBO_HOST_PAYLOAD_BYTES <= UBO_SIZE, "UBO host layout exceeds UBO_SIZE; update gpu_ubo.h and miner.comp");
+
+static inline void gpu_ubo_write_le32(uint8_t *dst, uint32_t val) {
+    dst[0] = (uint8_t)(val);
+    dst[1] = (uint8_t)(val >> 8);
+    dst[2] = (uint8_t)(val >> 16);
+    dst[3] = (uint8_t)(val >> 24);
+}
+
+/* Whole image; [mid] is written only with [useMidstate], as the shader reads it only then. */
+static inline void gpu_ubo_fill(uint8_t *ubo, const uint8_t *header76, uint32_t nonceStart, uint32_t nonceEnd,
+                                const uint8_t *target, int useMidstate, int selftestWriteDigest,
+                                const uint32_t mid[8]) {
+    memset(ubo, 0, UBO_SIZE);
+    for (int i = 0; i < UBO_HEADER_WORDS; i++) {
+        uint32_t w = (uint32_t)header76[i * 4] << 24 | (uint32_t)header76[i * 4 + 1] << 16 |
+                     (uint32_t)header76[i * 4 + 2] << 8 | (uint32_t)header76[i * 4 + 3];
+        gpu_ubo_write_le32(ubo + i * 4, w);
+    }
+    if (useMidstate) {
+        for (int i = 0; i < 8; i++)
+            gpu_ubo_write_le32(ubo + UBO_OFFSET_MIDSTATE + i * 4, mid[i]);
+    }
+    gpu_ubo_write_le32(ubo + UBO_OFFSET_NONCE_START, nonceStart);
+    gpu_ubo_write_le32(ubo + UBO_OFFSET_NONCE_END, nonceEnd);
+    memcpy(ubo + UBO_OFFSET_TARGET, target, 32);
+    gpu_ubo_write_le32(ubo + UBO_OFFSET_GPU_USE_MIDSTATE, useMidstate ? 1u : 0u);
+    gpu_ubo_write_le32(ubo + UBO_OFFSET_GPU_SELFTEST, selftestWriteDigest ? 1u : 0u);
+}
+
+/* Per-dispatch words of a prepared job image (miner_job.gpu_ubo). */
+static inline void gpu_ubo_set_range(uint8_t *ubo, uint32_t nonceStart, uint32_t nonceEnd, int useMidstate) {
+    gpu_ubo_write_le32(ubo + UBO_OFFSET_NONCE_START, nonceStart);
+    gpu_ubo_write_le32(ubo + UBO_OFFSET_NONCE_END, nonceEnd);
+    gpu_ubo_write_le32(ubo + UBO_OFFSET_GPU_USE_MIDSTATE, useMidstate ? 1u : 0u);
+}
+
+#endif
@@ -1,15 +1,23 @@
 #include "sha256.h"
 #include "sha256_scan.h"
+#include "sha256_calibrate.h"
 #include "btc_header_sha256.h"
+#include "cpu_features.h"
+#include "cpu_pool.h"
+#include "miner_channel.h"
+#include "miner_job.h"
+#include "miner_log.h"
+#include "miner_template.h"
+#include "uint256.h"
 #include <jni.h>
-#include <stdatomic.h>
+#if defined(__ANDROID__)
+#include <android/api-level.h>
+#endif
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
-#if defined(__aarch64__)
-#include <sys/auxv.h>
-#include <asm/hwcap.h>
-#endif
+#define LOG_TAG "Miner_JNI"
 
 #define BLOCK_HEADER_SIZE 80
 #define HEADER_PREFIX_SIZE 76
@@ -20,9 +28,15 @@
 #define CPU_JNI_STATUS_INTERRUPTED (-3)
 #define CPU_JNI_STATUS_FLAVOR_ERROR (-4)
 #define CPU_JNI_STATUS_JNI_ARG_ERROR (-5)
-
-/* Set by cpuRequestInterrupt; checked every 64k iterations in nonce scan. */
-atomic_int g_cpu_interrupt_requested = 0;
+/* JNI_OnLoad registers the @CriticalNative methods on this class. */
+#define NATIVE_MINER_CLASS "com/btcminer/android/mining/NativeMiner"
+/* nativeCalibrateCpuSha256 out[]: winner, row count, then rows of (cluster, cluster CPU mask, flavor, H/s). */
+#define CPU_CALIBRATE_JNI_HEADER 2
+#define CPU_CALIBRATE_JNI_ROW 4
+/* nativeCpuTopology out[] rows: CPU mask, CPU count, capacity, max kHz. */
+#define CPU_TOPOLOGY_JNI_ROW 4
+/* nativeCpuPoolCreateGroups groups[] rows: CPU mask, threads, flavor (-1 = the job's), nonces per claim, weight. */
+#define CPU_POOL_GROUP_JNI_ROW 5
 
 /* NIST test vector: SHA-256("abc") = 0xba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad */
 static const uint8_t TEST_ABC_HASH[HASH_SIZE] = {
@@ -38,6 +52,13 @@ Java_com_btcminer_android_mining_NativeMiner_nativeVersion(JNIEnv *env, jclass c
     return (*env)->NewStringUTF(env, "1.0.0");
 }
 
+JNIEXPORT jint JNICALL
+Java_com_btcminer_android_mining_NativeMiner_nativeKernelsVersion(JNIEnv *env, jclass clazz) {
+    (void)env;
+    (void)clazz;
+    return CPU_SHA_KERNELS_VERSION;
+}
+
 JNIEXPORT jboolean JNICALL
 Java_com_btcminer_android_mining_NativeMiner_nativeTestSha256(JNIEnv *env, jclass clazz) {
     (void)env;
@@ -66,23 +87,82 @@ Java_com_btcminer_android_mining_NativeMiner_nativeHashBlockHeader(JNIEnv *env,
     return result;
 }
 
-JNIEXPORT void JNICALL
-Java_com_btcminer_android_mining_NativeMiner_cpuRequestInterrupt(JNIEnv *env, jclass clazz) {
-    (void)env;
+/* Share target (32 bytes, big-endian) for pool [difficulty]; see uint256_target_from_difficulty. */
+JNIEXPORT jbyteArray JNICALL
+Java_com_btcminer_android_mining_NativeMiner_nativeTargetFromDifficulty(JNIEnv *env, jclass clazz,
+                                                                        jdouble difficulty) {
+    (void)clazz;
+    uint8_t target[HASH_SIZE];
+    uint256_target_from_difficulty((double)difficulty, target);
+    jbyteArray result = (*env)->NewByteArray(env, HASH_SIZE);
+    if (result) {
+        (*env)->SetByteArrayRegion(env, result, 0, HASH_SIZE, (jbyte *)target);
+    }
+    return result;
+}
+
+/* Difficulty of a 32-byte big-endian target; 0 when the array has the wrong length. */
+JNIEXPORT jdouble JNICALL
+Java_com_btcminer_android_mining_NativeMiner_nativeDifficultyFromTarget(JNIEnv *env, jclass clazz,
+                                                                        jbyteArray targetJava) {
+    (void)clazz;
+    if (!targetJava || (*env)->GetArrayLength(env, targetJava) != HASH_SIZE) {
+        return 0.0;
+    }
+    uint8_t target[HASH_SIZE];
+    (*env)->GetByteArrayRegion(env, targetJava, 0, HASH_SIZE, (jbyte *)target);
+    return uint256_difficulty_from_target(target);
+}
+
+/* Share difficulty of an 80-byte header (double SHA-256, then truediffone / hash); 0 on a bad length. */
+JNIEXPORT jdouble JNICALL
+Java_com_btcminer_android_mining_NativeMiner_nativeShareDifficulty(JNIEnv *env, jclass clazz,
+                                                                   jbyteArray headerJava) {
     (void)clazz;
-    atomic_store_explicit(&g_cpu_interrupt_requested, 1, memory_order_release);
+    if (!headerJava || (*env)->GetArrayLength(env, headerJava) != BLOCK_HEADER_SIZE) {
+        return 0.0;
+    }
+    uint8_t header[BLOCK_HEADER_SIZE];
+    uint8_t hash[HASH_SIZE];
+    (*env)->GetByteArrayRegion(env, headerJava, 0, BLOCK_HEADER_SIZE, (jbyte *)header);
+    sha256_double(header, BLOCK_HEADER_SIZE, hash);
+    return uint256_difficulty_from_hash(hash);
 }
 
 JNIEXPORT jboolean JNICALL
 Java_com_btcminer_android_mining_NativeMiner_nativeHwcapSha2(JNIEnv *env, jclass clazz) {
     (void)env;
     (void)clazz;
-#if defined(__aarch64__)
-    unsigned long hw = getauxval(AT_HWCAP);
-    return ((hw & HWCAP_SHA2) != 0) ? JNI_TRUE : JNI_FALSE;
-#else
-    return JNI_FALSE;
-#endif
+    return (cpu_features() & CPU_FEATURE_ARM_SHA2) != 0 ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_btcminer_android_mining_NativeMiner_nativeCpuidShaNi(JNIEnv *env, jclass clazz) {
+    (void)env;
+    (void)clazz;
+    return (cpu_features() & CPU_FEATURE_X86_SHANI) != 0 ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_btcminer_android_mining_NativeMiner_nativeCpuidSse41(JNIEnv *env, jclass clazz) {
+    (void)env;
+    (void)clazz;
+    const uint32_t need = CPU_FEATURE_X86_SSSE3 | CPU_FEATURE_X86_SSE41;
+    return (cpu_features() & need) == need ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_btcminer_android_mining_NativeMiner_nativeCpuidAvx2(JNIEnv *env, jclass clazz) {
+    (void)env;
+    (void)clazz;
+    return (cpu_features() & CPU_FEATURE_X86_AVX2) != 0 ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_btcminer_android_mining_NativeMiner_nativeCpuidAvx512(JNIEnv *env, jclass clazz) {
+    (void)env;
+    (void)clazz;
+    return (cpu_features() & CPU_FEATURE_X86_AVX512) != 0 ? JNI_TRUE : JNI_FALSE;
 }
 
 /** GPU midstate vs full double-SHA host check; logs tag GPU_SHA_SelfTest. */
@@ -98,62 +178,461 @@ Java_com_btcminer_android_mining_NativeMiner_nativeSelfTestCpuSha256Flavor(JNIEn
                                                                            jint flavor) {
     (void)env;
     (void)clazz;
-    if (flavor < 0 || flavor > 5) {
+    if (flavor < 0 || flavor >= CPU_SHA_FLAVOR_COUNT) {
         return JNI_FALSE;
     }
     return cpu_sha_selftest_flavor((int)flavor) ? JNI_TRUE : JNI_FALSE;
 }
 
-/* Parameter order must match Kotlin [NativeMiner.nativeScanNoncesInto] (out is last). */
+/* Handle for the other nativeCpuPool* calls, or 0 when no worker thread could start. */
+JNIEXPORT jlong JNICALL
+Java_com_btcminer_android_mining_NativeMiner_nativeCpuPoolCreate(JNIEnv *env, jclass clazz, jint threads,
+                                                                 jint nice) {
+    (void)env;
+    (void)clazz;
+    return (jlong)(intptr_t)cpu_pool_create((int)threads, (int)nice);
+}
+
+/* Parameter order must match Kotlin [NativeMiner.nativeCpuPoolCreateGroups]; 0 on a bad array or no thread. */
+JNIEXPORT jlong JNICALL
+Java_com_btcminer_android_mining_NativeMiner_nativeCpuPoolCreateGroups(JNIEnv *env, jclass clazz,
+                                                                       jlongArray groupsJava, jint nice) {
+    (void)clazz;
+    if (!groupsJava)
+        return 0;
+    const jsize len = (*env)->GetArrayLength(env, groupsJava);
+    int n = (int)(len / CPU_POOL_GROUP_JNI_ROW);
+    if (n < 1)
+        return 0;
+    if (n > CPU_POOL_MAX_GROUPS)
+        n = CPU_POOL_MAX_GROUPS;
+    jlong rows[CPU_POOL_MAX_GROUPS * CPU_POOL_GROUP_JNI_ROW];
+    (*env)->GetLongArrayRegion(env, groupsJava, 0, n * CPU_POOL_GROUP_JNI_ROW, rows);
+    cpu_pool_group groups[CPU_POOL_MAX_GROUPS];
+    for (int g = 0; g < n; g++) {
+        const jlong *row = rows + g * CPU_POOL_GROUP_JNI_ROW;
+        groups[g].cpu_mask = (uint64_t)row[0];
+        groups[g].threads = (int)row[1];
+        groups[g].flavor = (int)row[2];
+        groups[g].chunk = row[3] > 0 && row[3] <= (jlong)UINT32_MAX ? (uint32_t)row[3] : 0u;
+        groups[g].weight = (double)row[4];
+    }
+    return (jlong)(intptr_t)cpu_pool_create_groups(groups, n, (int)nice);
+}
+
+/* Cumulative nonces per group into out[]; returns the group count (rows beyond the array are dropped). */
+JNIEXPORT jint JNICALL
+Java_com_btcminer_android_mining_NativeMiner_nativeCpuPoolGroupScanned(JNIEnv *env, jclass clazz, jlong handle,
+                                                                       jlongArray outJava) {
+    (void)clazz;
+    if (!handle || !outJava)
+        return 0;
+    uint64_t scanned[CPU_POOL_MAX_GROUPS];
+    const int n = cpu_pool_group_scanned((cpu_pool *)(intptr_t)handle, scanned, CPU_POOL_MAX_GROUPS);
+    const jsize len = (*env)->GetArrayLength(env, outJava);
+    jlong out[CPU_POOL_MAX_GROUPS];
+    const int m = n < (int)len ? n : (int)len;
+    for (int g = 0; g < m; g++)
+        out[g] = (jlong)scanned[g];
+    (*env)->SetLongArrayRegion(env, outJava, 0, m, out);
+    return (jint)n;
+}
+
+/* Core clusters fastest first (cpu_topology.h), CPU_TOPOLOGY_JNI_ROW longs each; returns the cluster count. */
+JNIEXPORT jint JNICALL
+Java_com_btcminer_android_mining_NativeMiner_nativeCpuTopology(JNIEnv *env, jclass clazz, jlongArray outJava) {
+    (void)clazz;
+    cpu_cluster clusters[CPU_TOPOLOGY_MAX_CLUSTERS];
+    const int n = cpu_topology_clusters(clusters, CPU_TOPOLOGY_MAX_CLUSTERS);
+    if (!outJava)
+        return (jint)n;
+    const int max_rows = (int)((*env)->GetArrayLength(env, outJava) / CPU_TOPOLOGY_JNI_ROW);
+    jlong rows[CPU_TOPOLOGY_MAX_CLUSTERS * CPU_TOPOLOGY_JNI_ROW];
+    const int m = n < max_rows ? n : max_rows;
+    for (int c = 0; c < m; c++) {
+        jlong *row = rows + c * CPU_TOPOLOGY_JNI_ROW;
+        row[0] = (jlong)clusters[c].cpu_mask;
+        row[1] = (jlong)clusters[c].ncpus;
+        row[2] = (jlong)clusters[c].capacity;
+        row[3] = (jlong)clusters[c].max_khz;
+    }
+    (*env)->SetLongArrayRegion(env, outJava, 0, m * CPU_TOPOLOGY_JNI_ROW, rows);
+    return (jint)n;
+}
+
 JNIEXPORT void JNICALL
-Java_com_btcminer_android_mining_NativeMiner_nativeScanNoncesInto(JNIEnv *env, jclass clazz, jbyteArray header76Java,
-                                                                  jint nonceStart, jint nonceEnd, jbyteArray targetJava,
-                                                                  jint flavor, jlongArray outJava) {
+Java_com_btcminer_android_mining_NativeMiner_nativeCpuPoolDestroy(JNIEnv *env, jclass clazz, jlong handle) {
+    (void)env;
+    (void)clazz;
+    cpu_pool_destroy((cpu_pool *)(intptr_t)handle);
+}
+
+/* Parameter order must match Kotlin [NativeMiner.nativeCalibrateCpuSha256] (out is last). */
+JNIEXPORT void JNICALL
+Java_com_btcminer_android_mining_NativeMiner_nativeCalibrateCpuSha256(JNIEnv *env, jclass clazz, jint msPerFlavor,
+                                                                      jlongArray outJava) {
     (void)clazz;
-    if (!outJava || (*env)->GetArrayLength(env, outJava) < 2) {
+    if (!outJava)
         return;
-    }
+    const jsize len = (*env)->GetArrayLength(env, outJava);
+    if (len < CPU_CALIBRATE_JNI_HEADER)
+        return;
+    cpu_cluster clusters[CPU_TOPOLOGY_MAX_CLUSTERS];
+    cpu_sha_rank rows[CPU_CALIBRATE_MAX_ROWS];
+    const int nclusters = cpu_topology_clusters(clusters, CPU_TOPOLOGY_MAX_CLUSTERS);
+    const uint32_t ms = msPerFlavor > 0 ? (uint32_t)msPerFlavor : 1u;
+    int nrows = cpu_sha_calibrate(clusters, nclusters, ms, rows, CPU_CALIBRATE_MAX_ROWS);
+    const int max_rows = (int)((len - CPU_CALIBRATE_JNI_HEADER) / CPU_CALIBRATE_JNI_ROW);
     jlong *out = (*env)->GetLongArrayElements(env, outJava, NULL);
     if (!out)
         return;
-    if (!header76Java || !targetJava ||
-        (*env)->GetArrayLength(env, header76Java) != HEADER_PREFIX_SIZE ||
-        (*env)->GetArrayLength(env, targetJava) != HASH_SIZE) {
-        out[0] = (jlong)CPU_JNI_STATUS_JNI_ARG_ERROR;
+    if (nrows < 0) {
+        out[0] = (jlong)CPU_JNI_STATUS_INTERRUPTED;
         out[1] = 0;
-        (*env)->ReleaseLongArrayElements(env, outJava, out, 0);
-        return;
+    } else {
+        out[0] = (jlong)cpu_sha_calibration_winner(clusters, nclusters, rows, nrows);
+        if (nrows > max_rows)
+            nrows = max_rows;
+        out[1] = (jlong)nrows;
+        for (int i = 0; i < nrows; i++) {
+            jlong *row = out + CPU_CALIBRATE_JNI_HEADER + i * CPU_CALIBRATE_JNI_ROW;
+            row[0] = (jlong)rows[i].cluster;
+            row[1] = (jlong)clusters[rows[i].cluster].cpu_mask;
+            row[2] = (jlong)rows[i].flavor;
+            row[3] = (jlong)rows[i].hs;
+        }
     }
-    if (flavor < 0 || flavor > 5) {
-        out[0] = (jlong)CPU_JNI_STATUS_FLAVOR_ERROR;
-        out[1] = 0;
-        (*env)->ReleaseLongArrayElements(env, outJava, out, 0);
+    (*env)->ReleaseLongArrayElements(env, outJava, out, 0);
+}
+
+/*
+ * Address of a direct ByteBuffer laid out as miner_channel (miner_channel.h), for the primitive-only calls
+ * below; 0 when it is not direct, too small or not 8-byte aligned. Valid while the app holds the buffer.
+ */
+JNIEXPORT jlong JNICALL
+Java_com_btcminer_android_mining_NativeMiner_nativeChannelAddress(JNIEnv *env, jclass clazz, jobject buffer) {
+    (void)clazz;
+    if (!buffer)
+        return 0;
+    void *addr = (*env)->GetDirectBufferAddress(env, buffer);
+    if (!addr || (*env)->GetDirectBufferCapacity(env, buffer) < (jlong)sizeof(miner_channel) ||
+        ((uintptr_t)addr & 7u) != 0)
+        return 0;
+    return (jlong)(intptr_t)addr;
+}
+
+/* Heap copy of [array] (a 1-byte buffer when it is empty or null) and its length; NULL when out of memory. */
+static uint8_t *byte_array_copy(JNIEnv *env, jbyteArray array, size_t *len) {
+    const jsize n = array ? (*env)->GetArrayLength(env, array) : 0;
+    uint8_t *buf = (uint8_t *)malloc(n > 0 ? (size_t)n : 1u);
+    if (buf && n > 0)
+        (*env)->GetByteArrayRegion(env, array, 0, n, (jbyte *)buf);
+    *len = (size_t)n;
+    return buf;
+}
+
+/*
+ * Header template (miner_template.h) from the channel's header and target plus the job's coinbase around an
+ * [en2Size]-byte extranonce2 ([coinbase1] is coinb1 || extranonce1) and its merkle branches, 32 bytes each.
+ * The handle holds one reference; 0 on a bad size or when out of memory.
+ */
+JNIEXPORT jlong JNICALL
+Java_com_btcminer_android_mining_NativeMiner_nativeTemplateCreate(JNIEnv *env, jclass clazz, jlong channel,
+                                                                  jbyteArray coinbase1, jint en2Size,
+                                                                  jbyteArray coinbase2, jbyteArray branches) {
+    (void)clazz;
+    const miner_channel *ch = (const miner_channel *)(intptr_t)channel;
+    if (!ch)
+        return 0;
+    size_t len1;
+    size_t len2;
+    size_t branch_len;
+    uint8_t *cb1 = byte_array_copy(env, coinbase1, &len1);
+    uint8_t *cb2 = byte_array_copy(env, coinbase2, &len2);
+    uint8_t *br = byte_array_copy(env, branches, &branch_len);
+    miner_template *tpl = NULL;
+    if (cb1 && cb2 && br && branch_len % 32u == 0u) {
+        tpl = miner_template_create(ch->header76, ch->target, cb1, len1, (int)en2Size, cb2, len2, br,
+                                    (int)(branch_len / 32u));
+    }
+    free(cb1);
+    free(cb2);
+    free(br);
+    return (jlong)(intptr_t)tpl;
+}
+
+/*
+ * @CriticalNative methods: no JNIEnv or jclass, primitives only, registered in JNI_OnLoad. Android 7.x
+ * ignores the annotation and calls with JNIEnv and jclass, so each has a plain JNI twin for those releases.
+ */
+
+static void JNICALL cpu_request_interrupt(void) {
+    cpu_scan_cancel_all();
+}
+
+/*
+ * Prepared job (miner_job.h) from the channel's header and target, with the CPU image for [flavor]
+ * (MINER_JOB_NO_FLAVOR for a GPU-only job). The handle holds one reference; 0 when out of memory.
+ */
+static jlong JNICALL miner_job_create_channel(jlong channel, jint flavor) {
+    const miner_channel *ch = (const miner_channel *)(intptr_t)channel;
+    if (!ch)
+        return 0;
+    return (jlong)(intptr_t)miner_job_create(ch->header76, ch->target, (int)flavor);
+}
+
+static void JNICALL miner_job_release_critical(jlong job) {
+    miner_job_release((miner_job *)(intptr_t)job);
+}
+
+static void JNICALL miner_template_release_critical(jlong tpl) {
+    miner_template_release((miner_template *)(intptr_t)tpl);
+}
+
+/* Writes the template's header for [extranonce2] and its target into the channel's job inputs. */
+static void JNICALL miner_template_header_channel(jlong tpl, jint extranonce2, jlong channel) {
+    const miner_template *t = (const miner_template *)(intptr_t)tpl;
+    miner_channel *ch = (miner_channel *)(intptr_t)channel;
+    if (!t || !ch)
         return;
+    miner_template_header(t, (uint32_t)extranonce2, ch->header76);
+    memcpy(ch->target, t->target, sizeof(ch->target));
+}
+
+/*
+ * Template job: worker i mines extranonce2 en2First + i + k * en2Stride (unsigned). Returns 0 or a
+ * CPU_JNI_STATUS_* error, JNI_ARG_ERROR when the stride would overlap the workers' sequences.
+ */
+static jint JNICALL cpu_pool_submit_template_critical(jlong handle, jlong tpl, jlong tag, jint flavor,
+                                                      jint en2First, jint en2Stride) {
+    cpu_pool *p = (cpu_pool *)(intptr_t)handle;
+    if (!p || !tpl || en2Stride < cpu_pool_workers(p))
+        return CPU_JNI_STATUS_JNI_ARG_ERROR;
+    const int ret = cpu_pool_submit_template(p, (uint64_t)tag, (miner_template *)(intptr_t)tpl, (int)flavor,
+                                             (uint32_t)en2First, (uint32_t)en2Stride, 0u, UINT32_MAX);
+    return ret < 0 ? CPU_JNI_STATUS_FLAVOR_ERROR : 0;
+}
+
+static jint JNICALL cpu_pool_workers_critical(jlong handle) {
+    return handle ? (jint)cpu_pool_workers((cpu_pool *)(intptr_t)handle) : 0;
+}
+
+/* The pool takes its own reference to [job]; returns 0 or a CPU_JNI_STATUS_* error. */
+static jint JNICALL cpu_pool_submit_job(jlong handle, jlong job, jlong tag, jint nonceStart, jint nonceEnd) {
+    if (!handle || !job)
+        return CPU_JNI_STATUS_JNI_ARG_ERROR;
+    const int ret = cpu_pool_submit((cpu_pool *)(intptr_t)handle, (uint64_t)tag, (miner_job *)(intptr_t)job,
+                                    (uint32_t)nonceStart, (uint32_t)nonceEnd);
+    return ret < 0 ? CPU_JNI_STATUS_FLAVOR_ERROR : 0;
+}
+
+static void JNICALL cpu_pool_cancel_critical(jlong handle) {
+    if (handle)
+        cpu_pool_cancel((cpu_pool *)(intptr_t)handle);
+}
+
+static void JNICALL cpu_pool_set_pace_critical(jlong handle, jint paceMs) {
+    if (handle)
+        cpu_pool_set_pace((cpu_pool *)(intptr_t)handle, paceMs > 0 ? (uint32_t)paceMs : 0u);
+}
+
+/* 1 when nonces [nonceStart, nonceEnd] (unsigned, whole CPU_POOL_UNITs) joined job [tag]; else 0. */
+static jint JNICALL cpu_pool_extend_critical(jlong handle, jlong tag, jint nonceStart, jint nonceEnd) {
+    if (!handle)
+        return 0;
+    return (jint)cpu_pool_extend((cpu_pool *)(intptr_t)handle, (uint64_t)tag, (uint32_t)nonceStart,
+                                 (uint32_t)nonceEnd);
+}
+
+/* Stolen range as start << 32 | end (unsigned), or -1 when nothing of at least [minNonces] is left. */
+static jlong JNICALL cpu_pool_steal_critical(jlong handle, jlong tag, jint minNonces) {
+    uint32_t start;
+    uint32_t end;
+    if (!handle || !cpu_pool_steal((cpu_pool *)(intptr_t)handle, (uint64_t)tag,
+                                   minNonces > 0 ? (uint32_t)minNonces : 0u, &start, &end))
+        return -1;
+    return (jlong)((uint64_t)start << 32 | end);
+}
+
+static jlong JNICALL cpu_pool_remaining_critical(jlong handle) {
+    return handle ? (jlong)cpu_pool_remaining((cpu_pool *)(intptr_t)handle) : 0;
+}
+
+/*
+ * Fills the channel's telemetry (busy, scanned, best_difficulty, dropped) and up to MINER_CHANNEL_MAX_HITS
+ * hits; returns the hit count, or CPU_JNI_STATUS_JNI_ARG_ERROR. Channel status is 0 or
+ * CPU_JNI_STATUS_FLAVOR_ERROR when a worker's flavor failed since the previous drain.
+ */
+static jint JNICALL cpu_pool_drain_channel(jlong handle, jlong channel) {
+    miner_channel *ch = (miner_channel *)(intptr_t)channel;
+    if (!handle || !ch)
+        return CPU_JNI_STATUS_JNI_ARG_ERROR;
+    cpu_pool_hit hits[MINER_CHANNEL_MAX_HITS];
+    cpu_pool_stats stats;
+    const int n = cpu_pool_drain((cpu_pool *)(intptr_t)handle, hits, MINER_CHANNEL_MAX_HITS, &stats);
+    ch->status = stats.error != 0 ? CPU_JNI_STATUS_FLAVOR_ERROR : 0;
+    ch->busy = stats.busy;
+    ch->count = (uint32_t)n;
+    ch->dropped = stats.dropped;
+    ch->scanned = stats.scanned;
+    ch->best_difficulty = stats.best_difficulty;
+    for (int i = 0; i < n; i++) {
+        ch->hits[i].tag = hits[i].tag;
+        ch->hits[i].nonce = hits[i].nonce;
+        ch->hits[i].extranonce2 = hits[i].extranonce2;
     }
-    uint8_t header76[HEADER_PREFIX_SIZE];
-    uint8_t target[HASH_SIZE];
-    (*env)->GetByteArrayRegion(env, header76Java, 0, HEADER_PREFIX_SIZE, (jbyte *)header76);
-    (*env)->GetByteArrayRegion(env, targetJava, 0, HASH_SIZE, (jbyte *)target);
+    return (jint)n;
+}
 
-    uint32_t start = (uint32_t)nonceStart;
-    uint32_t end = (uint32_t)nonceEnd;
-    atomic_store_explicit(&g_cpu_interrupt_requested, 0, memory_order_relaxed);
-    int ret = scan_nonces_dispatch((int)flavor, header76, start, end, target);
-    if (ret >= 0) {
-        out[0] = (jlong)CPU_JNI_STATUS_HIT;
-        out[1] = (jlong)(uint32_t)ret;
-    } else if (ret == -1) {
-        out[0] = (jlong)CPU_JNI_STATUS_MISS;
-        out[1] = 0;
-    } else if (ret == -3) {
-        out[0] = (jlong)CPU_JNI_STATUS_INTERRUPTED;
-        out[1] = 0;
-    } else if (ret == -4) {
-        out[0] = (jlong)CPU_JNI_STATUS_FLAVOR_ERROR;
-        out[1] = 0;
-    } else {
-        out[0] = (jlong)CPU_JNI_STATUS_MISS;
-        out[1] = 0;
+static void JNICALL cpu_request_interrupt_jni(JNIEnv *env, jclass clazz) {
+    (void)env;
+    (void)clazz;
+    cpu_request_interrupt();
+}
+
+static jlong JNICALL miner_job_create_channel_jni(JNIEnv *env, jclass clazz, jlong channel, jint flavor) {
+    (void)env;
+    (void)clazz;
+    return miner_job_create_channel(channel, flavor);
+}
+
+static void JNICALL miner_job_release_jni(JNIEnv *env, jclass clazz, jlong job) {
+    (void)env;
+    (void)clazz;
+    miner_job_release_critical(job);
+}
+
+static void JNICALL miner_template_release_jni(JNIEnv *env, jclass clazz, jlong tpl) {
+    (void)env;
+    (void)clazz;
+    miner_template_release_critical(tpl);
+}
+
+static void JNICALL miner_template_header_jni(JNIEnv *env, jclass clazz, jlong tpl, jint extranonce2,
+                                              jlong channel) {
+    (void)env;
+    (void)clazz;
+    miner_template_header_channel(tpl, extranonce2, channel);
+}
+
+static jint JNICALL cpu_pool_submit_template_jni(JNIEnv *env, jclass clazz, jlong handle, jlong tpl, jlong tag,
+                                                 jint flavor, jint en2First, jint en2Stride) {
+    (void)env;
+    (void)clazz;
+    return cpu_pool_submit_template_critical(handle, tpl, tag, flavor, en2First, en2Stride);
+}
+
+static jint JNICALL cpu_pool_workers_jni(JNIEnv *env, jclass clazz, jlong handle) {
+    (void)env;
+    (void)clazz;
+    return cpu_pool_workers_critical(handle);
+}
+
+static jint JNICALL cpu_pool_submit_job_jni(JNIEnv *env, jclass clazz, jlong handle, jlong job, jlong tag,
+                                            jint nonceStart, jint nonceEnd) {
+    (void)env;
+    (void)clazz;
+    return cpu_pool_submit_job(handle, job, tag, nonceStart, nonceEnd);
+}
+
+static void JNICALL cpu_pool_cancel_jni(JNIEnv *env, jclass clazz, jlong handle) {
+    (void)env;
+    (void)clazz;
+    cpu_pool_cancel_critical(handle);
+}
+
+static void JNICALL cpu_pool_set_pace_jni(JNIEnv *env, jclass clazz, jlong handle, jint paceMs) {
+    (void)env;
+    (void)clazz;
+    cpu_pool_set_pace_critical(handle, paceMs);
+}
+
+static jint JNICALL cpu_pool_extend_jni(JNIEnv *env, jclass clazz, jlong handle, jlong tag, jint nonceStart,
+                                       jint nonceEnd) {
+    (void)env;
+    (void)clazz;
+    return cpu_pool_extend_critical(handle, tag, nonceStart, nonceEnd);
+}
+
+static jlong JNICALL cpu_pool_steal_jni(JNIEnv *env, jclass clazz, jlong handle, jlong tag, jint minNonces) {
+    (void)env;
+    (void)clazz;
+    return cpu_pool_steal_critical(handle, tag, minNonces);
+}
+
+static jlong JNICALL cpu_pool_remaining_jni(JNIEnv *env, jclass clazz, jlong handle) {
+    (void)env;
+    (void)clazz;
+    return cpu_pool_remaining_critical(handle);
+}
+
+static jint JNICALL cpu_pool_drain_channel_jni(JNIEnv *env, jclass clazz, jlong handle, jlong channel) {
+    (void)env;
+    (void)clazz;
+    return cpu_pool_drain_channel(handle, channel);
+}
+
+/* Same order in both tables; names and signatures must match the @CriticalNative externals in NativeMiner.kt. */
+static const JNINativeMethod kCriticalMethods[] = {
+    {"cpuRequestInterrupt", "()V", (void *)cpu_request_interrupt},
+    {"nativeJobCreate", "(JI)J", (void *)miner_job_create_channel},
+    {"nativeJobRelease", "(J)V", (void *)miner_job_release_critical},
+    {"nativeCpuPoolSubmitJob", "(JJJII)I", (void *)cpu_pool_submit_job},
+    {"nativeCpuPoolCancel", "(J)V", (void *)cpu_pool_cancel_critical},
+    {"nativeCpuPoolSetPace", "(JI)V", (void *)cpu_pool_set_pace_critical},
+    {"nativeCpuPoolDrainChannel", "(JJ)I", (void *)cpu_pool_drain_channel},
+    {"nativeCpuPoolExtend", "(JJII)I", (void *)cpu_pool_extend_critical},
+    {"nativeCpuPoolSteal", "(JJI)J", (void *)cpu_pool_steal_critical},
+    {"nativeCpuPoolRemaining", "(J)J", (void *)cpu_pool_remaining_critical},
+    {"nativeTemplateRelease", "(J)V", (void *)miner_template_release_critical},
+    {"nativeTemplateHeader", "(JIJ)V", (void *)miner_template_header_channel},
+    {"nativeCpuPoolSubmitTemplate", "(JJJIII)I", (void *)cpu_pool_submit_template_critical},
+    {"nativeCpuPoolWorkers", "(J)I", (void *)cpu_pool_workers_critical},
+};
+
+static const JNINativeMethod kCriticalMethodsJni[] = {
+    {"cpuRequestInterrupt", "()V", (void *)cpu_request_interrupt_jni},
+    {"nativeJobCreate", "(JI)J", (void *)miner_job_create_channel_jni},
+    {"nativeJobRelease", "(J)V", (void *)miner_job_release_jni},
+    {"nativeCpuPoolSubmitJob", "(JJJII)I", (void *)cpu_pool_submit_job_jni},
+    {"nativeCpuPoolCancel", "(J)V", (void *)cpu_pool_cancel_jni},
+    {"nativeCpuPoolSetPace", "(JI)V", (void *)cpu_pool_set_pace_jni},
+    {"nativeCpuPoolDrainChannel", "(JJ)I", (void *)cpu_pool_drain_channel_jni},
+    {"nativeCpuPoolExtend", "(JJII)I", (void *)cpu_pool_extend_jni},
+    {"nativeCpuPoolSteal", "(JJI)J", (void *)cpu_pool_steal_jni},
+    {"nativeCpuPoolRemaining", "(J)J", (void *)cpu_pool_remaining_jni},
+    {"nativeTemplateRelease", "(J)V", (void *)miner_template_release_jni},
+    {"nativeTemplateHeader", "(JIJ)V", (void *)miner_template_header_jni},
+    {"nativeCpuPoolSubmitTemplate", "(JJJIII)I", (void *)cpu_pool_submit_template_jni},
+    {"nativeCpuPoolWorkers", "(J)I", (void *)cpu_pool_workers_jni},
+};
+
+_Static_assert(sizeof(kCriticalMethods) == sizeof(kCriticalMethodsJni), "one JNI twin per @CriticalNative method");
+
+static int critical_native_supported(void) {
+#if defined(__ANDROID__)
+    /* @CriticalNative is honoured from Android 8.0 (API 26). */
+    return android_get_device_api_level() >= 26;
+#else
+    return 1;
+#endif
+}
+
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *vm, void *reserved) {
+    (void)reserved;
+    JNIEnv *env = NULL;
+    if ((*vm)->GetEnv(vm, (void **)&env, JNI_VERSION_1_6) != JNI_OK)
+        return JNI_ERR;
+    jclass clazz = (*env)->FindClass(env, NATIVE_MINER_CLASS);
+    if (!clazz)
+        return JNI_ERR;
+    const int critical = critical_native_supported();
+    const jint n = (jint)(sizeof(kCriticalMethods) / sizeof(kCriticalMethods[0]));
+    const jint rc = (*env)->RegisterNatives(env, clazz, critical ? kCriticalMethods : kCriticalMethodsJni, n);
+    (*env)->DeleteLocalRef(env, clazz);
+    if (rc != JNI_OK) {
+        __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, "RegisterNatives failed: %d", (int)rc);
+        return JNI_ERR;
     }
-    (*env)->ReleaseLongArrayElements(env, outJava, out, 0);
+    return JNI_VERSION_1_6;
 }
@@ -0,0 +1,55 @@
+#ifndef MINER_CHANNEL_H
+#define MINER_CHANNEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Shared-memory record between one mining worker and native code: a direct ByteBuffer the app allocates
+ * once per worker (MinerChannel.kt), in native byte order. The app writes the job inputs once per round;
+ * native code writes the result and telemetry; each call passes only the buffer address and primitives,
+ * so nothing is copied in, pinned or allocated per call. Offsets are mirrored by MinerChannel.kt.
+ */
+
+#define MINER_CHANNEL_MAX_HITS 64
+
+typedef struct {
+    uint64_t tag;
+    uint32_t nonce;
+    /* Header the nonce belongs to, for template jobs (cpu_pool_submit_template); else 0. */
+    uint32_t extranonce2;
+} miner_channel_hit;
+
+typedef struct {
+    /* Inputs, written by the app. */
+    uint8_t header76[76];
+    uint8_t target[32];
+    /* Outputs, written by native code. */
+    int32_t status;
+    /* GPU winning nonce (status HIT). */
+    uint32_t nonce;
+    /* CPU pool: workers still on the current job. */
+    int32_t busy;
+    /* Valid entries in [hits]. */
+    uint32_t count;
+    /* CPU pool: hits lost to a full queue since the previous drain. */
+    uint32_t dropped;
+    /* Nonces hashed by the call (GPU) or since the previous drain (CPU pool). */
+    uint64_t scanned;
+    /* Difficulty of the lowest hash since the previous drain; 0 when none. */
+    double best_difficulty;
+    miner_channel_hit hits[MINER_CHANNEL_MAX_HITS];
+} miner_channel;
+
+_Static_assert(offsetof(miner_channel, target) == 76, "MinerChannel.TARGET");
+_Static_assert(offsetof(miner_channel, status) == 108, "MinerChannel.STATUS");
+_Static_assert(offsetof(miner_channel, nonce) == 112, "MinerChannel.NONCE");
+_Static_assert(offsetof(miner_channel, busy) == 116, "MinerChannel.BUSY");
+_Static_assert(offsetof(miner_channel, count) == 120, "MinerChannel.COUNT");
+_Static_assert(offsetof(miner_channel, dropped) == 124, "MinerChannel.DROPPED");
+_Static_assert(offsetof(miner_channel, scanned) == 128, "MinerChannel.SCANNED");
+_Static_assert(offsetof(miner_channel, best_difficulty) == 136, "MinerChannel.BEST_DIFFICULTY");
+_Static_assert(offsetof(miner_channel, hits) == 144 && sizeof(miner_channel_hit) == 16, "MinerChannel.HITS");
+_Static_assert(sizeof(miner_channel) == 1168, "MinerChannel.SIZE");
+
+#endif
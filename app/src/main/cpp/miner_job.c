@@ -0,0 +1,48 @@
+/*
+ * Prepared mining jobs: the per-job half of every scan, done once when the job arrives rather than in
+ * each chunk of each worker.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "miner_job.h"
+
+#include "btc_header_sha256.h"
+#include "gpu_ubo.h"
+#include "sha256_scan.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+_Static_assert(MINER_JOB_UBO_BYTES == UBO_SIZE, "miner_job.gpu_ubo must hold the whole UBO image");
+
+void miner_job_init(miner_job *job, const uint8_t header76[76], const uint8_t target[32], int flavor) {
+    memcpy(job->header76, header76, sizeof(job->header76));
+    memcpy(job->target, target, sizeof(job->target));
+    uint256_from_be(&job->target_w, target);
+    btc_midstate_header76(header76, job->midstate);
+    job->flavor = flavor;
+    atomic_init(&job->refs, 0);
+    cpu_sha_prepare_job(job);
+}
+
+miner_job *miner_job_create(const uint8_t header76[76], const uint8_t target[32], int flavor) {
+    void *mem = NULL;
+    if (posix_memalign(&mem, 64, sizeof(miner_job)) != 0)
+        return NULL;
+    miner_job *job = (miner_job *)mem;
+    miner_job_init(job, header76, target, flavor);
+    /* Midstate always filled in; each dispatch sets whether the shader uses it. */
+    gpu_ubo_fill(job->gpu_ubo, header76, 0u, 0u, target, 1, 0, job->midstate);
+    atomic_init(&job->refs, 1);
+    return job;
+}
+
+void miner_job_retain(miner_job *job) {
+    atomic_fetch_add_explicit(&job->refs, 1, memory_order_relaxed);
+}
+
+void miner_job_release(miner_job *job) {
+    if (job && atomic_fetch_sub_explicit(&job->refs, 1, memory_order_acq_rel) == 1)
+        free(job);
+}
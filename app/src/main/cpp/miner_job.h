@@ -0,0 +1,55 @@
+#ifndef MINER_JOB_H
+#define MINER_JOB_H
+
+#include "uint256.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+/* Lane-kernel job image (sha256_lanes_tmpl.h and friends); sha256_scan.c asserts every kernel fits. */
+#define MINER_JOB_LANES_BYTES 1536
+/* GPU uniform buffer (gpu_ubo.h). */
+#define MINER_JOB_UBO_BYTES 256
+/* [flavor] of a job prepared without a CPU kernel image (GPU-only jobs). */
+#define MINER_JOB_NO_FLAVOR (-1)
+
+/**
+ * Everything that depends only on (header76, target), computed once per job instead of once per scan
+ * call: the block-0 midstate, the target as words in compare order, the CPU lane kernel's job image for
+ * [flavor] (splatted midstate, block-1 schedule words and the nonce-independent rounds) and the GPU
+ * uniform buffer with the nonce range left for each dispatch to fill in.
+ *
+ * A job from miner_job_create is reference-counted, so the CPU pool's workers, a GPU scan and the app's
+ * handle (a jlong) can share it; the last miner_job_release frees it. A job set up with miner_job_init
+ * lives on the caller's stack and is never retained. Immutable once set up.
+ */
+typedef struct {
+    _Alignas(64) unsigned char lanes[MINER_JOB_LANES_BYTES];
+    uint8_t gpu_ubo[MINER_JOB_UBO_BYTES];
+    uint8_t header76[76];
+    uint8_t target[32];
+    uint256 target_w;
+    uint32_t midstate[8];
+    /* CPU flavor [lanes] was prepared for, or MINER_JOB_NO_FLAVOR. */
+    int flavor;
+    atomic_int refs;
+} miner_job;
+
+/**
+ * Prepares [job] in place for CPU scans with [flavor] (no GPU image). A flavor this CPU cannot run is
+ * recorded as given and fails later in scan_nonces_job; no kernel code runs for it here.
+ */
+void miner_job_init(miner_job *job, const uint8_t header76[76], const uint8_t target[32], int flavor);
+
+/**
+ * Heap job holding one reference, with both the CPU image for [flavor] (MINER_JOB_NO_FLAVOR for none)
+ * and the GPU image. NULL when out of memory.
+ */
+miner_job *miner_job_create(const uint8_t header76[76], const uint8_t target[32], int flavor);
+
+void miner_job_retain(miner_job *job);
+
+/** Drops one reference; frees the job with the last one. NULL is ignored. */
+void miner_job_release(miner_job *job);
+
+#endif
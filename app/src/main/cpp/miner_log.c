@@ -0,0 +1,30 @@
+/* Host (non-Android) backend for miner_log.h: stderr with a priority floor. */
+#include "miner_log.h"
+
+#if !defined(__ANDROID__)
+
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+static atomic_int g_min_priority = ANDROID_LOG_WARN;
+
+void miner_log_set_min_priority(int prio) {
+    atomic_store_explicit(&g_min_priority, prio, memory_order_relaxed);
+}
+
+int miner_log_print(int prio, const char *tag, const char *fmt, ...) {
+    if (prio < atomic_load_explicit(&g_min_priority, memory_order_relaxed))
+        return 0;
+    static const char levels[] = "??VDIWE";
+    char lv = (prio >= 0 && prio < (int)sizeof(levels) - 1) ? levels[prio] : '?';
+    va_list ap;
+    va_start(ap, fmt);
+    int n = fprintf(stderr, "%c/%s: ", lv, tag);
+    n += vfprintf(stderr, fmt, ap);
+    n += fprintf(stderr, "\n");
+    va_end(ap);
+    return n;
+}
+
+#endif
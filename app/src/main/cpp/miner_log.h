@@ -0,0 +1,32 @@
+#ifndef MINER_LOG_H
+#define MINER_LOG_H
+
+/*
+ * Logging shim for the hashing core. Android builds forward to liblog unchanged; host builds
+ * (miner_core / minerbench on Linux) print to stderr so the core has no NDK dependency.
+ */
+
+#if defined(__ANDROID__)
+
+#include <android/log.h>
+
+#else
+
+enum {
+    ANDROID_LOG_VERBOSE = 2,
+    ANDROID_LOG_DEBUG = 3,
+    ANDROID_LOG_INFO = 4,
+    ANDROID_LOG_WARN = 5,
+    ANDROID_LOG_ERROR = 6,
+};
+
+int miner_log_print(int prio, const char *tag, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+/** Host only: messages below [prio] are dropped (default ANDROID_LOG_WARN). */
+void miner_log_set_min_priority(int prio);
+
+#define __android_log_print miner_log_print
+
+#endif
+
+#endif
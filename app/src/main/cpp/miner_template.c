@@ -0,0 +1,125 @@
+/*
+ * Stratum job templates: headers built natively per extranonce2, so each CPU pool worker (and the GPU)
+ * can move to a fresh header of its own the moment it has scanned the last one.
+ */
+
+#include "miner_template.h"
+
+#include "sha256.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* SHA-256 over the coinbase pieces without assembling them: [fill] bytes of [block] are pending. */
+typedef struct {
+    uint32_t state[8];
+    uint8_t block[64];
+    size_t fill;
+} tpl_sha;
+
+static void tpl_sha_feed(tpl_sha *s, const uint8_t *p, size_t n) {
+    while (n > 0) {
+        size_t take = 64u - s->fill;
+        if (take > n)
+            take = n;
+        memcpy(s->block + s->fill, p, take);
+        s->fill += take;
+        p += take;
+        n -= take;
+        if (s->fill == 64u) {
+            sha256_compress(s->state, s->block);
+            s->fill = 0;
+        }
+    }
+}
+
+/* Pads for a [len]-byte message and writes the digest. */
+static void tpl_sha_finish(tpl_sha *s, uint64_t len, uint8_t out[32]) {
+    s->block[s->fill++] = 0x80;
+    if (s->fill > 56u) {
+        memset(s->block + s->fill, 0, 64u - s->fill);
+        sha256_compress(s->state, s->block);
+        s->fill = 0;
+    }
+    memset(s->block + s->fill, 0, 56u - s->fill);
+    const uint64_t bitlen = len * 8u;
+    for (int i = 0; i < 8; i++)
+        s->block[63 - i] = (uint8_t)(bitlen >> (i * 8));
+    sha256_compress(s->state, s->block);
+    for (int i = 0; i < 8; i++) {
+        out[i * 4 + 0] = (uint8_t)(s->state[i] >> 24);
+        out[i * 4 + 1] = (uint8_t)(s->state[i] >> 16);
+        out[i * 4 + 2] = (uint8_t)(s->state[i] >> 8);
+        out[i * 4 + 3] = (uint8_t)s->state[i];
+    }
+}
+
+miner_template *miner_template_create(const uint8_t header76[76], const uint8_t target[32],
+                                      const uint8_t *coinbase1, size_t coinbase1_len, int en2_size,
+                                      const uint8_t *coinbase2, size_t coinbase2_len,
+                                      const uint8_t *branches, int nbranches) {
+    if (en2_size < 1 || en2_size > MINER_TEMPLATE_MAX_EN2 || coinbase1_len > MINER_TEMPLATE_MAX_COINBASE ||
+        coinbase2_len > MINER_TEMPLATE_MAX_COINBASE || nbranches < 0 || nbranches > MINER_TEMPLATE_MAX_BRANCHES)
+        return NULL;
+    const size_t head = coinbase1_len / 64u * 64u;
+    const size_t tail_len = coinbase1_len - head + (size_t)en2_size + coinbase2_len;
+    const size_t branch_bytes = (size_t)nbranches * 32u;
+    /* Template, tail and branches in one block. */
+    miner_template *tpl = (miner_template *)malloc(sizeof(miner_template) + tail_len + branch_bytes);
+    if (!tpl)
+        return NULL;
+    memcpy(tpl->header76, header76, sizeof(tpl->header76));
+    memcpy(tpl->target, target, sizeof(tpl->target));
+    sha256_initial_state(tpl->midstate);
+    for (size_t off = 0; off < head; off += 64u)
+        sha256_compress(tpl->midstate, coinbase1 + off);
+    tpl->coinbase_len = (uint64_t)coinbase1_len + (uint64_t)en2_size + coinbase2_len;
+    tpl->tail = (uint8_t *)(tpl + 1);
+    tpl->tail_len = tail_len;
+    tpl->en2_offset = coinbase1_len - head;
+    tpl->en2_size = en2_size;
+    memcpy(tpl->tail, coinbase1 + head, tpl->en2_offset);
+    memset(tpl->tail + tpl->en2_offset, 0, (size_t)en2_size);
+    if (coinbase2_len > 0)
+        memcpy(tpl->tail + tpl->en2_offset + (size_t)en2_size, coinbase2, coinbase2_len);
+    tpl->nbranches = nbranches;
+    tpl->branches = (uint8_t (*)[32])(tpl->tail + tail_len);
+    if (branch_bytes > 0)
+        memcpy(tpl->branches, branches, branch_bytes);
+    atomic_init(&tpl->refs, 1);
+    return tpl;
+}
+
+void miner_template_retain(miner_template *tpl) {
+    atomic_fetch_add_explicit(&tpl->refs, 1, memory_order_relaxed);
+}
+
+void miner_template_release(miner_template *tpl) {
+    if (tpl && atomic_fetch_sub_explicit(&tpl->refs, 1, memory_order_acq_rel) == 1)
+        free(tpl);
+}
+
+void miner_template_header(const miner_template *tpl, uint32_t en2, uint8_t header76[76]) {
+    uint8_t en2_bytes[MINER_TEMPLATE_MAX_EN2];
+    for (int i = 0; i < tpl->en2_size; i++) {
+        const int shift = (tpl->en2_size - 1 - i) * 8;
+        en2_bytes[i] = shift < 32 ? (uint8_t)(en2 >> shift) : 0u;
+    }
+    tpl_sha s;
+    memcpy(s.state, tpl->midstate, sizeof(s.state));
+    s.fill = 0;
+    const size_t after = tpl->en2_offset + (size_t)tpl->en2_size;
+    tpl_sha_feed(&s, tpl->tail, tpl->en2_offset);
+    tpl_sha_feed(&s, en2_bytes, (size_t)tpl->en2_size);
+    tpl_sha_feed(&s, tpl->tail + after, tpl->tail_len - after);
+    uint8_t node[64];
+    tpl_sha_finish(&s, tpl->coinbase_len, node);
+    sha256(node, 32u, node);
+    for (int b = 0; b < tpl->nbranches; b++) {
+        memcpy(node + 32, tpl->branches[b], 32u);
+        sha256_double(node, 64u, node);
+    }
+    memcpy(header76, tpl->header76, 36u);
+    memcpy(header76 + 36, node, 32u);
+    memcpy(header76 + 68, tpl->header76 + 68, 8u);
+}
@@ -0,0 +1,62 @@
+#ifndef MINER_TEMPLATE_H
+#define MINER_TEMPLATE_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Longest extranonce2 a template accepts (Stratum pools use 4 or 8). */
+#define MINER_TEMPLATE_MAX_EN2 8
+/* Coinbase halves and merkle branches beyond these are rejected (a block's coinbase stays far below). */
+#define MINER_TEMPLATE_MAX_COINBASE (64u * 1024u)
+#define MINER_TEMPLATE_MAX_BRANCHES 32
+
+/**
+ * One Stratum job as a header factory, so whoever owns an extranonce2 builds its own header with no shared
+ * state: coinbase = coinbase1 (coinb1 || extranonce1) || extranonce2 || coinbase2, merkle root =
+ * SHA256d(coinbase) folded as SHA256d(root || branch) per branch, header76 = version || prevhash || root ||
+ * ntime || nbits, exactly as the engine's StratumHeaderBuilder does it. The coinbase blocks before the
+ * extranonce2 are hashed once here, so a new header costs the coinbase tail and the branches.
+ *
+ * Reference-counted like miner_job (the CPU pool's workers and the app's handle share it); immutable once
+ * created.
+ */
+typedef struct {
+    /* Version, prevhash, ntime and nbits; the merkle root bytes are rewritten per header. */
+    uint8_t header76[76];
+    uint8_t target[32];
+    /* SHA-256 state after the coinbase's whole blocks before the extranonce2. */
+    uint32_t midstate[8];
+    uint64_t coinbase_len;
+    /* Coinbase bytes from the end of those blocks on, extranonce2 zeroed at [en2_offset]. */
+    uint8_t *tail;
+    size_t tail_len;
+    size_t en2_offset;
+    int en2_size;
+    int nbranches;
+    uint8_t (*branches)[32];
+    atomic_int refs;
+} miner_template;
+
+/**
+ * Template holding one reference, from a header whose merkle root is ignored, the share target, the
+ * coinbase around an [en2_size]-byte extranonce2 and [nbranches] 32-byte merkle branches. NULL when a size
+ * is out of range or memory ran out.
+ */
+miner_template *miner_template_create(const uint8_t header76[76], const uint8_t target[32],
+                                      const uint8_t *coinbase1, size_t coinbase1_len, int en2_size,
+                                      const uint8_t *coinbase2, size_t coinbase2_len,
+                                      const uint8_t *branches, int nbranches);
+
+void miner_template_retain(miner_template *tpl);
+
+/** Drops one reference; frees the template with the last one. NULL is ignored. */
+void miner_template_release(miner_template *tpl);
+
+/**
+ * Header for extranonce2 [en2], written big-endian into its en2_size bytes (the engine's zero-padded hex;
+ * bytes above the fourth are zero). Safe from any number of threads at once.
+ */
+void miner_template_header(const miner_template *tpl, uint32_t en2, uint8_t header76[76]);
+
+#endif
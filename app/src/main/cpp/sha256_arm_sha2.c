@@ -21,7 +21,7 @@ static const uint32_t K256[64] __attribute__((aligned(16))) = {
     0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
 };
 
-void sha256_arm_compress(uint32_t *s, const uint8_t *chunk, size_t blocks) {
+void sha256_arm_compress(uint32_t s[8], const uint8_t *chunk, size_t blocks) {
     uint32x4_t STATE0, STATE1, ABEF_SAVE, CDGH_SAVE;
     uint32x4_t MSG0, MSG1, MSG2, MSG3;
     uint32x4_t TMP0, TMP2;
@@ -151,4 +151,336 @@ void sha256_arm_compress(uint32_t *s, const uint8_t *chunk, size_t blocks) {
     vst1q_u32(&s[4], STATE1);
 }
 
+/*
+ * Rounds 4i..4i+3 on (s0 = ABCD, s1 = EFGH). [m0] holds W[4i..4i+3] and, for quads 0..11, is advanced in
+ * place to W[4i+16..4i+19] from [m1]..[m3]; the callers rotate the four message registers per quad.
+ */
+#define ARM_QROUND(i, s0, s1, m0, m1, m2, m3)                                  \
+    do {                                                                       \
+        const uint32x4_t wk_ = vaddq_u32((m0), vld1q_u32(&K256[4 * (i)]));    \
+        const uint32x4_t abcd_ = (s0);                                         \
+        if ((i) < 12)                                                          \
+            (m0) = vsha256su0q_u32((m0), (m1));                                \
+        (s0) = vsha256hq_u32((s0), (s1), wk_);                                 \
+        (s1) = vsha256h2q_u32((s1), abcd_, wk_);                               \
+        if ((i) < 12)                                                          \
+            (m0) = vsha256su1q_u32((m0), (m2), (m3));                          \
+    } while (0)
+
+/* All 64 rounds of one stream; the _TO60 form stops after round 59 (quad 14), with W60..W63 in m3. */
+#define ARM_ROUNDS_1WAY_TO60(s0, s1, m0, m1, m2, m3) \
+    do {                                             \
+        ARM_QROUND(0, s0, s1, m0, m1, m2, m3);       \
+        ARM_QROUND(1, s0, s1, m1, m2, m3, m0);       \
+        ARM_QROUND(2, s0, s1, m2, m3, m0, m1);       \
+        ARM_QROUND(3, s0, s1, m3, m0, m1, m2);       \
+        ARM_QROUND(4, s0, s1, m0, m1, m2, m3);       \
+        ARM_QROUND(5, s0, s1, m1, m2, m3, m0);       \
+        ARM_QROUND(6, s0, s1, m2, m3, m0, m1);       \
+        ARM_QROUND(7, s0, s1, m3, m0, m1, m2);       \
+        ARM_QROUND(8, s0, s1, m0, m1, m2, m3);       \
+        ARM_QROUND(9, s0, s1, m1, m2, m3, m0);       \
+        ARM_QROUND(10, s0, s1, m2, m3, m0, m1);      \
+        ARM_QROUND(11, s0, s1, m3, m0, m1, m2);      \
+        ARM_QROUND(12, s0, s1, m0, m1, m2, m3);      \
+        ARM_QROUND(13, s0, s1, m1, m2, m3, m0);      \
+        ARM_QROUND(14, s0, s1, m2, m3, m0, m1);      \
+    } while (0)
+
+#define ARM_ROUNDS_1WAY(s0, s1, m0, m1, m2, m3)       \
+    do {                                              \
+        ARM_ROUNDS_1WAY_TO60(s0, s1, m0, m1, m2, m3); \
+        ARM_QROUND(15, s0, s1, m3, m0, m1, m2);       \
+    } while (0)
+
+/* Same rounds for two independent streams, quad by quad, so both chains are in flight together. */
+#define ARM_ROUNDS_2WAY_TO60(s0a, s1a, m0a, m1a, m2a, m3a, s0b, s1b, m0b, m1b, m2b, m3b) \
+    do {                                                                                 \
+        ARM_QROUND(0, s0a, s1a, m0a, m1a, m2a, m3a);                                     \
+        ARM_QROUND(0, s0b, s1b, m0b, m1b, m2b, m3b);                                     \
+        ARM_QROUND(1, s0a, s1a, m1a, m2a, m3a, m0a);                                     \
+        ARM_QROUND(1, s0b, s1b, m1b, m2b, m3b, m0b);                                     \
+        ARM_QROUND(2, s0a, s1a, m2a, m3a, m0a, m1a);                                     \
+        ARM_QROUND(2, s0b, s1b, m2b, m3b, m0b, m1b);                                     \
+        ARM_QROUND(3, s0a, s1a, m3a, m0a, m1a, m2a);                                     \
+        ARM_QROUND(3, s0b, s1b, m3b, m0b, m1b, m2b);                                     \
+        ARM_QROUND(4, s0a, s1a, m0a, m1a, m2a, m3a);                                     \
+        ARM_QROUND(4, s0b, s1b, m0b, m1b, m2b, m3b);                                     \
+        ARM_QROUND(5, s0a, s1a, m1a, m2a, m3a, m0a);                                     \
+        ARM_QROUND(5, s0b, s1b, m1b, m2b, m3b, m0b);                                     \
+        ARM_QROUND(6, s0a, s1a, m2a, m3a, m0a, m1a);                                     \
+        ARM_QROUND(6, s0b, s1b, m2b, m3b, m0b, m1b);                                     \
+        ARM_QROUND(7, s0a, s1a, m3a, m0a, m1a, m2a);                                     \
+        ARM_QROUND(7, s0b, s1b, m3b, m0b, m1b, m2b);                                     \
+        ARM_QROUND(8, s0a, s1a, m0a, m1a, m2a, m3a);                                     \
+        ARM_QROUND(8, s0b, s1b, m0b, m1b, m2b, m3b);                                     \
+        ARM_QROUND(9, s0a, s1a, m1a, m2a, m3a, m0a);                                     \
+        ARM_QROUND(9, s0b, s1b, m1b, m2b, m3b, m0b);                                     \
+        ARM_QROUND(10, s0a, s1a, m2a, m3a, m0a, m1a);                                    \
+        ARM_QROUND(10, s0b, s1b, m2b, m3b, m0b, m1b);                                    \
+        ARM_QROUND(11, s0a, s1a, m3a, m0a, m1a, m2a);                                    \
+        ARM_QROUND(11, s0b, s1b, m3b, m0b, m1b, m2b);                                    \
+        ARM_QROUND(12, s0a, s1a, m0a, m1a, m2a, m3a);                                    \
+        ARM_QROUND(12, s0b, s1b, m0b, m1b, m2b, m3b);                                    \
+        ARM_QROUND(13, s0a, s1a, m1a, m2a, m3a, m0a);                                    \
+        ARM_QROUND(13, s0b, s1b, m1b, m2b, m3b, m0b);                                    \
+        ARM_QROUND(14, s0a, s1a, m2a, m3a, m0a, m1a);                                    \
+        ARM_QROUND(14, s0b, s1b, m2b, m3b, m0b, m1b);                                    \
+    } while (0)
+
+#define ARM_ROUNDS_2WAY(s0a, s1a, m0a, m1a, m2a, m3a, s0b, s1b, m0b, m1b, m2b, m3b)       \
+    do {                                                                                  \
+        ARM_ROUNDS_2WAY_TO60(s0a, s1a, m0a, m1a, m2a, m3a, s0b, s1b, m0b, m1b, m2b, m3b); \
+        ARM_QROUND(15, s0a, s1a, m3a, m0a, m1a, m2a);                                     \
+        ARM_QROUND(15, s0b, s1b, m3b, m0b, m1b, m2b);                                     \
+    } while (0)
+
+/* Three streams: enough independent sha256h/h2 work to cover the crypto unit's latency on big cores. */
+#define ARM_ROUNDS_3WAY_TO60(s0a, s1a, m0a, m1a, m2a, m3a, s0b, s1b, m0b, m1b, m2b, m3b, s0c, s1c, m0c, m1c, m2c, m3c) \
+    do {                                                                                                               \
+        ARM_QROUND(0, s0a, s1a, m0a, m1a, m2a, m3a);                                                                   \
+        ARM_QROUND(0, s0b, s1b, m0b, m1b, m2b, m3b);                                                                   \
+        ARM_QROUND(0, s0c, s1c, m0c, m1c, m2c, m3c);                                                                   \
+        ARM_QROUND(1, s0a, s1a, m1a, m2a, m3a, m0a);                                                                   \
+        ARM_QROUND(1, s0b, s1b, m1b, m2b, m3b, m0b);                                                                   \
+        ARM_QROUND(1, s0c, s1c, m1c, m2c, m3c, m0c);                                                                   \
+        ARM_QROUND(2, s0a, s1a, m2a, m3a, m0a, m1a);                                                                   \
+        ARM_QROUND(2, s0b, s1b, m2b, m3b, m0b, m1b);                                                                   \
+        ARM_QROUND(2, s0c, s1c, m2c, m3c, m0c, m1c);                                                                   \
+        ARM_QROUND(3, s0a, s1a, m3a, m0a, m1a, m2a);                                                                   \
+        ARM_QROUND(3, s0b, s1b, m3b, m0b, m1b, m2b);                                                                   \
+        ARM_QROUND(3, s0c, s1c, m3c, m0c, m1c, m2c);                                                                   \
+        ARM_QROUND(4, s0a, s1a, m0a, m1a, m2a, m3a);                                                                   \
+        ARM_QROUND(4, s0b, s1b, m0b, m1b, m2b, m3b);                                                                   \
+        ARM_QROUND(4, s0c, s1c, m0c, m1c, m2c, m3c);                                                                   \
+        ARM_QROUND(5, s0a, s1a, m1a, m2a, m3a, m0a);                                                                   \
+        ARM_QROUND(5, s0b, s1b, m1b, m2b, m3b, m0b);                                                                   \
+        ARM_QROUND(5, s0c, s1c, m1c, m2c, m3c, m0c);                                                                   \
+        ARM_QROUND(6, s0a, s1a, m2a, m3a, m0a, m1a);                                                                   \
+        ARM_QROUND(6, s0b, s1b, m2b, m3b, m0b, m1b);                                                                   \
+        ARM_QROUND(6, s0c, s1c, m2c, m3c, m0c, m1c);                                                                   \
+        ARM_QROUND(7, s0a, s1a, m3a, m0a, m1a, m2a);                                                                   \
+        ARM_QROUND(7, s0b, s1b, m3b, m0b, m1b, m2b);                                                                   \
+        ARM_QROUND(7, s0c, s1c, m3c, m0c, m1c, m2c);                                                                   \
+        ARM_QROUND(8, s0a, s1a, m0a, m1a, m2a, m3a);                                                                   \
+        ARM_QROUND(8, s0b, s1b, m0b, m1b, m2b, m3b);                                                                   \
+        ARM_QROUND(8, s0c, s1c, m0c, m1c, m2c, m3c);                                                                   \
+        ARM_QROUND(9, s0a, s1a, m1a, m2a, m3a, m0a);                                                                   \
+        ARM_QROUND(9, s0b, s1b, m1b, m2b, m3b, m0b);                                                                   \
+        ARM_QROUND(9, s0c, s1c, m1c, m2c, m3c, m0c);                                                                   \
+        ARM_QROUND(10, s0a, s1a, m2a, m3a, m0a, m1a);                                                                  \
+        ARM_QROUND(10, s0b, s1b, m2b, m3b, m0b, m1b);                                                                  \
+        ARM_QROUND(10, s0c, s1c, m2c, m3c, m0c, m1c);                                                                  \
+        ARM_QROUND(11, s0a, s1a, m3a, m0a, m1a, m2a);                                                                  \
+        ARM_QROUND(11, s0b, s1b, m3b, m0b, m1b, m2b);                                                                  \
+        ARM_QROUND(11, s0c, s1c, m3c, m0c, m1c, m2c);                                                                  \
+        ARM_QROUND(12, s0a, s1a, m0a, m1a, m2a, m3a);                                                                  \
+        ARM_QROUND(12, s0b, s1b, m0b, m1b, m2b, m3b);                                                                  \
+        ARM_QROUND(12, s0c, s1c, m0c, m1c, m2c, m3c);                                                                  \
+        ARM_QROUND(13, s0a, s1a, m1a, m2a, m3a, m0a);                                                                  \
+        ARM_QROUND(13, s0b, s1b, m1b, m2b, m3b, m0b);                                                                  \
+        ARM_QROUND(13, s0c, s1c, m1c, m2c, m3c, m0c);                                                                  \
+        ARM_QROUND(14, s0a, s1a, m2a, m3a, m0a, m1a);                                                                  \
+        ARM_QROUND(14, s0b, s1b, m2b, m3b, m0b, m1b);                                                                  \
+        ARM_QROUND(14, s0c, s1c, m2c, m3c, m0c, m1c);                                                                  \
+    } while (0)
+
+#define ARM_ROUNDS_3WAY(s0a, s1a, m0a, m1a, m2a, m3a, s0b, s1b, m0b, m1b, m2b, m3b, s0c, s1c, m0c, m1c, m2c, m3c) \
+    do {                                                                                                          \
+        ARM_ROUNDS_3WAY_TO60(s0a, s1a, m0a, m1a, m2a, m3a, s0b, s1b, m0b, m1b, m2b, m3b, s0c, s1c, m0c, m1c,      \
+                             m2c, m3c);                                                                           \
+        ARM_QROUND(15, s0a, s1a, m3a, m0a, m1a, m2a);                                                             \
+        ARM_QROUND(15, s0b, s1b, m3b, m0b, m1b, m2b);                                                             \
+        ARM_QROUND(15, s0c, s1c, m3c, m0c, m1c, m2c);                                                             \
+    } while (0)
+
+static inline uint32x4_t u32x4(uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+    const uint32_t v[4] = {a, b, c, d};
+    return vld1q_u32(v);
+}
+
+static inline uint32_t be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static inline void store_digest(uint32x4_t abcd, uint32x4_t efgh, uint8_t out[32]) {
+    vst1q_u8(out, vrev32q_u8(vreinterpretq_u8_u32(abcd)));
+    vst1q_u8(out + 16, vrev32q_u8(vreinterpretq_u8_u32(efgh)));
+}
+
+/* Message quads of the first hash's block 1: header tail + nonce, then fixed padding for 80 bytes. */
+#define ARM_FIRST_MSG(sfx, header76, nonce)                                                                \
+    uint32x4_t m0##sfx = u32x4(be32((header76) + 64), be32((header76) + 68), be32((header76) + 72),        \
+        __builtin_bswap32(nonce));                                                                        \
+    uint32x4_t m1##sfx = u32x4(0x80000000u, 0, 0, 0);                                                      \
+    uint32x4_t m2##sfx = vdupq_n_u32(0);                                                                   \
+    uint32x4_t m3##sfx = u32x4(0, 0, 0, 80u * 8u)
+
+/* Second hash message: the first digest (state + midstate) directly, then padding for 32 bytes. */
+#define ARM_SECOND_MSG(sfx, mid0, mid1, iv0, iv1)      \
+    do {                                               \
+        m0##sfx = vaddq_u32(s0##sfx, (mid0));          \
+        m1##sfx = vaddq_u32(s1##sfx, (mid1));          \
+        m2##sfx = u32x4(0x80000000u, 0, 0, 0);         \
+        m3##sfx = u32x4(0, 0, 0, 32u * 8u);            \
+        s0##sfx = (iv0);                               \
+        s1##sfx = (iv1);                               \
+    } while (0)
+
+static inline uint32x4_t load_be128(const uint8_t *p) {
+    return vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(p)));
+}
+
+/* Message quads of the outer hash: the first digest, then fixed padding for 32 bytes. */
+#define ARM_OUTER_MSG(abcd, efgh)                   \
+    uint32x4_t m0 = (abcd), m1 = (efgh);            \
+    uint32x4_t m2 = u32x4(0x80000000u, 0, 0, 0);    \
+    uint32x4_t m3 = u32x4(0, 0, 0, 32u * 8u)
+
+/* Outer hash of the first digest (abcd, efgh) in registers: one block from the IV, constant padding. */
+static inline void arm_second_hash(uint32x4_t abcd, uint32x4_t efgh, uint8_t out[32]) {
+    const uint32x4_t iv0 = u32x4(0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a);
+    const uint32x4_t iv1 = u32x4(0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19);
+    uint32x4_t s0 = iv0, s1 = iv1;
+    ARM_OUTER_MSG(abcd, efgh);
+    ARM_ROUNDS_1WAY(s0, s1, m0, m1, m2, m3);
+    store_digest(vaddq_u32(s0, iv0), vaddq_u32(s1, iv1), out);
+}
+
+/*
+ * H7 of the outer hash from its state after round 59 (abcd, efgh) and W60..W63: the e that round 60
+ * writes is the final h, so one scalar round replaces the last quad and the other feed-forward adds.
+ */
+static inline uint32_t arm_h7_after_quad14(uint32x4_t abcd, uint32x4_t efgh, uint32x4_t w60) {
+    const uint32_t d = vgetq_lane_u32(abcd, 3);
+    const uint32_t e = vgetq_lane_u32(efgh, 0), f = vgetq_lane_u32(efgh, 1), g = vgetq_lane_u32(efgh, 2);
+    const uint32_t h = vgetq_lane_u32(efgh, 3);
+    const uint32_t ep1 = ((e >> 6) | (e << 26)) ^ ((e >> 11) | (e << 21)) ^ ((e >> 25) | (e << 7));
+    return 0x5be0cd19u + d + h + ep1 + ((e & f) ^ (~e & g)) + K256[60] + vgetq_lane_u32(w60, 0);
+}
+
+static inline uint32_t arm_second_h7(uint32x4_t abcd, uint32x4_t efgh) {
+    uint32x4_t s0 = u32x4(0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a);
+    uint32x4_t s1 = u32x4(0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19);
+    ARM_OUTER_MSG(abcd, efgh);
+    ARM_ROUNDS_1WAY_TO60(s0, s1, m0, m1, m2, m3);
+    return arm_h7_after_quad14(s0, s1, m3);
+}
+
+void sha256_arm_double_mid(const uint32_t midstate[8], const uint8_t header76[76], uint32_t nonce,
+                           uint8_t digest[32]) {
+    const uint32x4_t mid0 = vld1q_u32(&midstate[0]);
+    const uint32x4_t mid1 = vld1q_u32(&midstate[4]);
+    uint32x4_t s0a = mid0, s1a = mid1;
+    ARM_FIRST_MSG(a, header76, nonce);
+    ARM_ROUNDS_1WAY(s0a, s1a, m0a, m1a, m2a, m3a);
+    arm_second_hash(vaddq_u32(s0a, mid0), vaddq_u32(s1a, mid1), digest);
+}
+
+uint32_t sha256_arm_h7_mid(const uint32_t midstate[8], const uint8_t header76[76], uint32_t nonce) {
+    const uint32x4_t mid0 = vld1q_u32(&midstate[0]);
+    const uint32x4_t mid1 = vld1q_u32(&midstate[4]);
+    uint32x4_t s0a = mid0, s1a = mid1;
+    ARM_FIRST_MSG(a, header76, nonce);
+    ARM_ROUNDS_1WAY(s0a, s1a, m0a, m1a, m2a, m3a);
+    return arm_second_h7(vaddq_u32(s0a, mid0), vaddq_u32(s1a, mid1));
+}
+
+void sha256_arm_double80(const uint8_t header80[80], uint8_t digest[32]) {
+    const uint32x4_t iv0 = u32x4(0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a);
+    const uint32x4_t iv1 = u32x4(0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19);
+    uint32x4_t s0 = iv0, s1 = iv1;
+    uint32x4_t m0 = load_be128(header80), m1 = load_be128(header80 + 16);
+    uint32x4_t m2 = load_be128(header80 + 32), m3 = load_be128(header80 + 48);
+    ARM_ROUNDS_1WAY(s0, s1, m0, m1, m2, m3);
+    const uint32x4_t mid0 = vaddq_u32(s0, iv0);
+    const uint32x4_t mid1 = vaddq_u32(s1, iv1);
+    s0 = mid0;
+    s1 = mid1;
+    m0 = load_be128(header80 + 64);
+    m1 = u32x4(0x80000000u, 0, 0, 0);
+    m2 = vdupq_n_u32(0);
+    m3 = u32x4(0, 0, 0, 80u * 8u);
+    ARM_ROUNDS_1WAY(s0, s1, m0, m1, m2, m3);
+    arm_second_hash(vaddq_u32(s0, mid0), vaddq_u32(s1, mid1), digest);
+}
+
+void sha256_arm_hash32(const uint8_t d32[32], uint8_t out[32]) {
+    arm_second_hash(load_be128(d32), load_be128(d32 + 16), out);
+}
+
+void sha256_arm_double_mid_2way(const uint32_t midstate[8], const uint8_t header76[76], uint32_t n0, uint32_t n1,
+                                uint8_t digests[2][32]) {
+    const uint32x4_t mid0 = vld1q_u32(&midstate[0]);
+    const uint32x4_t mid1 = vld1q_u32(&midstate[4]);
+    const uint32x4_t iv0 = u32x4(0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a);
+    const uint32x4_t iv1 = u32x4(0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19);
+    uint32x4_t s0a = mid0, s1a = mid1, s0b = mid0, s1b = mid1;
+    ARM_FIRST_MSG(a, header76, n0);
+    ARM_FIRST_MSG(b, header76, n1);
+    ARM_ROUNDS_2WAY(s0a, s1a, m0a, m1a, m2a, m3a, s0b, s1b, m0b, m1b, m2b, m3b);
+    ARM_SECOND_MSG(a, mid0, mid1, iv0, iv1);
+    ARM_SECOND_MSG(b, mid0, mid1, iv0, iv1);
+    ARM_ROUNDS_2WAY(s0a, s1a, m0a, m1a, m2a, m3a, s0b, s1b, m0b, m1b, m2b, m3b);
+    store_digest(vaddq_u32(s0a, iv0), vaddq_u32(s1a, iv1), digests[0]);
+    store_digest(vaddq_u32(s0b, iv0), vaddq_u32(s1b, iv1), digests[1]);
+}
+
+void sha256_arm_double_mid_3way(const uint32_t midstate[8], const uint8_t header76[76], uint32_t n0, uint32_t n1,
+                                uint32_t n2, uint8_t digests[3][32]) {
+    const uint32x4_t mid0 = vld1q_u32(&midstate[0]);
+    const uint32x4_t mid1 = vld1q_u32(&midstate[4]);
+    const uint32x4_t iv0 = u32x4(0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a);
+    const uint32x4_t iv1 = u32x4(0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19);
+    uint32x4_t s0a = mid0, s1a = mid1, s0b = mid0, s1b = mid1, s0c = mid0, s1c = mid1;
+    ARM_FIRST_MSG(a, header76, n0);
+    ARM_FIRST_MSG(b, header76, n1);
+    ARM_FIRST_MSG(c, header76, n2);
+    ARM_ROUNDS_3WAY(s0a, s1a, m0a, m1a, m2a, m3a, s0b, s1b, m0b, m1b, m2b, m3b, s0c, s1c, m0c, m1c, m2c, m3c);
+    ARM_SECOND_MSG(a, mid0, mid1, iv0, iv1);
+    ARM_SECOND_MSG(b, mid0, mid1, iv0, iv1);
+    ARM_SECOND_MSG(c, mid0, mid1, iv0, iv1);
+    ARM_ROUNDS_3WAY(s0a, s1a, m0a, m1a, m2a, m3a, s0b, s1b, m0b, m1b, m2b, m3b, s0c, s1c, m0c, m1c, m2c, m3c);
+    store_digest(vaddq_u32(s0a, iv0), vaddq_u32(s1a, iv1), digests[0]);
+    store_digest(vaddq_u32(s0b, iv0), vaddq_u32(s1b, iv1), digests[1]);
+    store_digest(vaddq_u32(s0c, iv0), vaddq_u32(s1c, iv1), digests[2]);
+}
+
+void sha256_arm_h7_mid_2way(const uint32_t midstate[8], const uint8_t header76[76], uint32_t n0, uint32_t n1,
+                            uint32_t h7[2]) {
+    const uint32x4_t mid0 = vld1q_u32(&midstate[0]);
+    const uint32x4_t mid1 = vld1q_u32(&midstate[4]);
+    const uint32x4_t iv0 = u32x4(0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a);
+    const uint32x4_t iv1 = u32x4(0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19);
+    uint32x4_t s0a = mid0, s1a = mid1, s0b = mid0, s1b = mid1;
+    ARM_FIRST_MSG(a, header76, n0);
+    ARM_FIRST_MSG(b, header76, n1);
+    ARM_ROUNDS_2WAY(s0a, s1a, m0a, m1a, m2a, m3a, s0b, s1b, m0b, m1b, m2b, m3b);
+    ARM_SECOND_MSG(a, mid0, mid1, iv0, iv1);
+    ARM_SECOND_MSG(b, mid0, mid1, iv0, iv1);
+    ARM_ROUNDS_2WAY_TO60(s0a, s1a, m0a, m1a, m2a, m3a, s0b, s1b, m0b, m1b, m2b, m3b);
+    h7[0] = arm_h7_after_quad14(s0a, s1a, m3a);
+    h7[1] = arm_h7_after_quad14(s0b, s1b, m3b);
+}
+
+void sha256_arm_h7_mid_3way(const uint32_t midstate[8], const uint8_t header76[76], uint32_t n0, uint32_t n1,
+                            uint32_t n2, uint32_t h7[3]) {
+    const uint32x4_t mid0 = vld1q_u32(&midstate[0]);
+    const uint32x4_t mid1 = vld1q_u32(&midstate[4]);
+    const uint32x4_t iv0 = u32x4(0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a);
+    const uint32x4_t iv1 = u32x4(0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19);
+    uint32x4_t s0a = mid0, s1a = mid1, s0b = mid0, s1b = mid1, s0c = mid0, s1c = mid1;
+    ARM_FIRST_MSG(a, header76, n0);
+    ARM_FIRST_MSG(b, header76, n1);
+    ARM_FIRST_MSG(c, header76, n2);
+    ARM_ROUNDS_3WAY(s0a, s1a, m0a, m1a, m2a, m3a, s0b, s1b, m0b, m1b, m2b, m3b, s0c, s1c, m0c, m1c, m2c, m3c);
+    ARM_SECOND_MSG(a, mid0, mid1, iv0, iv1);
+    ARM_SECOND_MSG(b, mid0, mid1, iv0, iv1);
+    ARM_SECOND_MSG(c, mid0, mid1, iv0, iv1);
+    ARM_ROUNDS_3WAY_TO60(s0a, s1a, m0a, m1a, m2a, m3a, s0b, s1b, m0b, m1b, m2b, m3b, s0c, s1c, m0c, m1c, m2c, m3c);
+    h7[0] = arm_h7_after_quad14(s0a, s1a, m3a);
+    h7[1] = arm_h7_after_quad14(s0b, s1b, m3b);
+    h7[2] = arm_h7_after_quad14(s0c, s1c, m3c);
+}
+
 #endif
@@ -9,6 +9,42 @@
 /** ARMv8 SHA256 crypto extension; one or more 64-byte big-endian blocks. */
 void sha256_arm_compress(uint32_t state[8], const uint8_t *chunk, size_t blocks);
 
+/**
+ * Double SHA-256 of header76 || nonce from [midstate] (state after the first 64 bytes). The first digest
+ * stays in registers and feeds the outer hash as one block with constant padding. Writes 32 bytes.
+ */
+void sha256_arm_double_mid(const uint32_t midstate[8], const uint8_t header76[76], uint32_t nonce,
+                           uint8_t digest[32]);
+
+/**
+ * Final H7 word (digest bytes 28–31, big-endian) of the same double hash; the outer hash stops after
+ * round 60. Lets the scan reject a nonce before finalising its digest.
+ */
+uint32_t sha256_arm_h7_mid(const uint32_t midstate[8], const uint8_t header76[76], uint32_t nonce);
+
+/** Double SHA-256 of a full 80-byte header, both hashes through the SHA2 extension. */
+void sha256_arm_double80(const uint8_t header80[80], uint8_t digest[32]);
+
+/** SHA-256 of a 32-byte message (the outer hash of sha256d) as a single padded block. */
+void sha256_arm_hash32(const uint8_t d32[32], uint8_t out[32]);
+
+/**
+ * Double SHA-256 of header76 || n0 and header76 || n1 from [midstate] (state after the first 64 bytes),
+ * with both nonces' rounds interleaved to hide the sha256h/h2 latency. Writes 32-byte digests.
+ */
+void sha256_arm_double_mid_2way(const uint32_t midstate[8], const uint8_t header76[76], uint32_t n0, uint32_t n1,
+                                uint8_t digests[2][32]);
+
+/** Three-stream variant of sha256_arm_double_mid_2way. */
+void sha256_arm_double_mid_3way(const uint32_t midstate[8], const uint8_t header76[76], uint32_t n0, uint32_t n1,
+                                uint32_t n2, uint8_t digests[3][32]);
+
+/** H7 words only (see sha256_arm_h7_mid) for the 2-way and 3-way kernels. */
+void sha256_arm_h7_mid_2way(const uint32_t midstate[8], const uint8_t header76[76], uint32_t n0, uint32_t n1,
+                            uint32_t h7[2]);
+void sha256_arm_h7_mid_3way(const uint32_t midstate[8], const uint8_t header76[76], uint32_t n0, uint32_t n1,
+                            uint32_t n2, uint32_t h7[3]);
+
 #else
 
 static inline void sha256_arm_compress(uint32_t state[8], const uint8_t *chunk, size_t blocks) {
@@ -17,6 +53,69 @@ static inline void sha256_arm_compress(uint32_t state[8], const uint8_t *chunk,
     (void)blocks;
 }
 
+static inline void sha256_arm_double_mid(const uint32_t midstate[8], const uint8_t header76[76], uint32_t nonce,
+                                         uint8_t digest[32]) {
+    (void)midstate;
+    (void)header76;
+    (void)nonce;
+    (void)digest;
+}
+
+static inline uint32_t sha256_arm_h7_mid(const uint32_t midstate[8], const uint8_t header76[76], uint32_t nonce) {
+    (void)midstate;
+    (void)header76;
+    (void)nonce;
+    return 0;
+}
+
+static inline void sha256_arm_double80(const uint8_t header80[80], uint8_t digest[32]) {
+    (void)header80;
+    (void)digest;
+}
+
+static inline void sha256_arm_hash32(const uint8_t d32[32], uint8_t out[32]) {
+    (void)d32;
+    (void)out;
+}
+
+static inline void sha256_arm_double_mid_2way(const uint32_t midstate[8], const uint8_t header76[76], uint32_t n0,
+                                              uint32_t n1, uint8_t digests[2][32]) {
+    (void)midstate;
+    (void)header76;
+    (void)n0;
+    (void)n1;
+    (void)digests;
+}
+
+static inline void sha256_arm_double_mid_3way(const uint32_t midstate[8], const uint8_t header76[76], uint32_t n0,
+                                              uint32_t n1, uint32_t n2, uint8_t digests[3][32]) {
+    (void)midstate;
+    (void)header76;
+    (void)n0;
+    (void)n1;
+    (void)n2;
+    (void)digests;
+}
+
+static inline void sha256_arm_h7_mid_2way(const uint32_t midstate[8], const uint8_t header76[76], uint32_t n0,
+                                          uint32_t n1, uint32_t h7[2]) {
+    (void)midstate;
+    (void)header76;
+    (void)n0;
+    (void)n1;
+    (void)h7;
+}
+
+static inline void sha256_arm_h7_mid_3way(const uint32_t midstate[8], const uint8_t header76[76], uint32_t n0,
+                                          uint32_t n1, uint32_t n2, uint32_t h7[3]) {
+    (void)midstate;
+    (void)header76;
+    (void)n0;
+    (void)n1;
+    (void)n2;
+    (void)h7;
+}
+
 #endif
 
 #endif
@@ -0,0 +1,63 @@
+/*
+ * Eight-lane SHA-256 (AVX2) for parallel nonce hashing; sha256_lanes_tmpl.h instantiated on
+ * 256-bit vectors. Built with -mavx2; only called after cpu_features() reports CPU_FEATURE_X86_AVX2.
+ * The SHA256_X86_AVX512VL build (sha256_avx2_8way_vl_*) uses vprord / vpternlogd on the same
+ * vectors, as sha256_sse4_4way.c does.
+ */
+
+#include "sha256_avx2_8way.h"
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+/* vpshufb works per 128-bit half, so the byte-swap mask repeats. */
+#define AVX2_BSWAP32_MASK \
+    _mm256_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL, 0x0c0d0e0f08090a0bLL, 0x0405060700010203LL)
+
+#if defined(SHA256_X86_AVX512VL)
+#define AVX2_API(name) sha256_avx2_8way_vl_##name
+#else
+#define AVX2_API(name) sha256_avx2_8way_##name
+#endif
+
+#define LANES_PREFIX avx2
+#define LANES_JOB sha256_avx2_8way_job
+#define LANES_N 8
+#define LANES_VEC __m256i
+#define LANES_ALIGN 32
+#define V_SET1(x) _mm256_set1_epi32((int)(x))
+#define V_LOADU(p) _mm256_loadu_si256((const __m256i *)(p))
+#define V_STORE(p, v) _mm256_store_si256((__m256i *)(p), (v))
+#define V_ADD(a, b) _mm256_add_epi32((a), (b))
+#define V_XOR(a, b) _mm256_xor_si256((a), (b))
+#define V_AND(a, b) _mm256_and_si256((a), (b))
+#define V_OR(a, b) _mm256_or_si256((a), (b))
+#define V_SHR(x, n) _mm256_srli_epi32((x), (n))
+#define V_BSWAP(x) _mm256_shuffle_epi8((x), AVX2_BSWAP32_MASK)
+#if defined(SHA256_X86_AVX512VL)
+#define V_ROTR(x, n) _mm256_ror_epi32((x), (n))
+#define V_XOR3(a, b, c) _mm256_ternarylogic_epi32((a), (b), (c), 0x96)
+#define V_CH(e, f, g) _mm256_ternarylogic_epi32((e), (f), (g), 0xCA)
+#define V_MAJ(a, b, c) _mm256_ternarylogic_epi32((a), (b), (c), 0xE8)
+#define V_LE_MASK(x, t) ((uint32_t)_mm256_cmple_epu32_mask((x), (t)))
+#else
+#define V_ROTR(x, n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+#define V_LE_MASK(x, t) \
+    ((uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_min_epu32((x), (t)), (x)))))
+#endif
+#include "sha256_lanes_tmpl.h"
+
+void AVX2_API(job_init)(sha256_avx2_8way_job *job, const uint32_t midstate[8], const uint8_t header76[76]) {
+    avx2_job_init(job, midstate, header76);
+}
+
+void AVX2_API(double_job)(const sha256_avx2_8way_job *job, uint32_t base, uint8_t digests[8][32]) {
+    avx2_job_double(job, base, digests);
+}
+
+uint32_t AVX2_API(mask_job)(const sha256_avx2_8way_job *job, uint32_t base, uint32_t target_top) {
+    return avx2_job_mask(job, base, target_top);
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef SHA256_AVX2_8WAY_H
+#define SHA256_AVX2_8WAY_H
+
+#include <stdint.h>
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+/** Per-job constants splatted to all eight lanes (see sha256_sse4_4way_job). */
+typedef struct {
+    __m256i mid[8];
+    __m256i tail[3];
+    __m256i pre_state[8];
+    __m256i pre_w[4];
+} sha256_avx2_8way_job;
+
+/**
+ * Midstate path, eight lanes (AVX2): [midstate] is the state after the first 64 bytes of header76;
+ * lane l hashes header76 || base + l (little-endian at offsets 76–79). Caller checks CPU_FEATURE_X86_AVX2.
+ */
+void sha256_avx2_8way_job_init(sha256_avx2_8way_job *job, const uint32_t midstate[8], const uint8_t header76[76]);
+void sha256_avx2_8way_double_job(const sha256_avx2_8way_job *job, uint32_t base, uint8_t digests[8][32]);
+
+/** Candidate lane mask of nonces base .. base + 7 (see sha256_sse4_4way_mask_job). */
+uint32_t sha256_avx2_8way_mask_job(const sha256_avx2_8way_job *job, uint32_t base, uint32_t target_top);
+
+/* AVX-512VL builds of the three functions above; only when CPU_FEATURE_X86_AVX512VL is set. */
+void sha256_avx2_8way_vl_job_init(sha256_avx2_8way_job *job, const uint32_t midstate[8],
+                                  const uint8_t header76[76]);
+void sha256_avx2_8way_vl_double_job(const sha256_avx2_8way_job *job, uint32_t base, uint8_t digests[8][32]);
+uint32_t sha256_avx2_8way_vl_mask_job(const sha256_avx2_8way_job *job, uint32_t base, uint32_t target_top);
+
+#else
+
+typedef struct {
+    uint32_t unused;
+} sha256_avx2_8way_job;
+
+static inline void sha256_avx2_8way_job_init(sha256_avx2_8way_job *job, const uint32_t midstate[8],
+                                             const uint8_t header76[76]) {
+    (void)job;
+    (void)midstate;
+    (void)header76;
+}
+
+static inline void sha256_avx2_8way_double_job(const sha256_avx2_8way_job *job, uint32_t base,
+                                               uint8_t digests[8][32]) {
+    (void)job;
+    (void)base;
+    (void)digests;
+}
+
+static inline uint32_t sha256_avx2_8way_mask_job(const sha256_avx2_8way_job *job, uint32_t base,
+                                                 uint32_t target_top) {
+    (void)job;
+    (void)base;
+    (void)target_top;
+    return 0;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,53 @@
+/*
+ * Sixteen-lane SHA-256 (AVX-512) for parallel nonce hashing; sha256_lanes_tmpl.h instantiated on
+ * 512-bit vectors with native rotates (vprord) and three-input logic (vpternlogd) for Ch, Maj and
+ * the sigma XORs. Built with -mavx512f -mavx512bw; only called after cpu_features() reports
+ * CPU_FEATURE_X86_AVX512.
+ */
+
+#include "sha256_avx512_16way.h"
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+#define AVX512_BSWAP32_MASK                                                                                  \
+    _mm512_set_epi64(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL, 0x0c0d0e0f08090a0bLL, 0x0405060700010203LL, \
+        0x0c0d0e0f08090a0bLL, 0x0405060700010203LL, 0x0c0d0e0f08090a0bLL, 0x0405060700010203LL)
+
+#define LANES_PREFIX avx512
+#define LANES_JOB sha256_avx512_16way_job
+#define LANES_N 16
+#define LANES_VEC __m512i
+#define LANES_ALIGN 64
+#define V_SET1(x) _mm512_set1_epi32((int)(x))
+#define V_LOADU(p) _mm512_loadu_si512((const void *)(p))
+#define V_STORE(p, v) _mm512_store_si512((void *)(p), (v))
+#define V_ADD(a, b) _mm512_add_epi32((a), (b))
+#define V_XOR(a, b) _mm512_xor_si512((a), (b))
+#define V_AND(a, b) _mm512_and_si512((a), (b))
+#define V_OR(a, b) _mm512_or_si512((a), (b))
+#define V_SHR(x, n) _mm512_srli_epi32((x), (n))
+#define V_ROTR(x, n) _mm512_ror_epi32((x), (n))
+#define V_BSWAP(x) _mm512_shuffle_epi8((x), AVX512_BSWAP32_MASK)
+/* vpternlogd immediates: 0x96 = a^b^c, 0xCA = a?b:c, 0xE8 = majority(a,b,c). */
+#define V_XOR3(a, b, c) _mm512_ternarylogic_epi32((a), (b), (c), 0x96)
+#define V_CH(e, f, g) _mm512_ternarylogic_epi32((e), (f), (g), 0xCA)
+#define V_MAJ(a, b, c) _mm512_ternarylogic_epi32((a), (b), (c), 0xE8)
+#define V_LE_MASK(x, t) ((uint32_t)_mm512_cmple_epu32_mask((x), (t)))
+#include "sha256_lanes_tmpl.h"
+
+void sha256_avx512_16way_job_init(sha256_avx512_16way_job *job, const uint32_t midstate[8],
+                                  const uint8_t header76[76]) {
+    avx512_job_init(job, midstate, header76);
+}
+
+void sha256_avx512_16way_double_job(const sha256_avx512_16way_job *job, uint32_t base, uint8_t digests[16][32]) {
+    avx512_job_double(job, base, digests);
+}
+
+uint32_t sha256_avx512_16way_mask_job(const sha256_avx512_16way_job *job, uint32_t base, uint32_t target_top) {
+    return avx512_job_mask(job, base, target_top);
+}
+
+#endif
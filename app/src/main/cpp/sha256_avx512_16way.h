@@ -0,0 +1,59 @@
+#ifndef SHA256_AVX512_16WAY_H
+#define SHA256_AVX512_16WAY_H
+
+#include <stdint.h>
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+/** Per-job constants splatted to all sixteen lanes (see sha256_sse4_4way_job). */
+typedef struct {
+    __m512i mid[8];
+    __m512i tail[3];
+    __m512i pre_state[8];
+    __m512i pre_w[4];
+} sha256_avx512_16way_job;
+
+/**
+ * Midstate path, sixteen lanes (AVX-512F/BW); same contract as sha256_avx2_8way_job_init and
+ * sha256_avx2_8way_double_job. Caller checks CPU_FEATURE_X86_AVX512.
+ */
+void sha256_avx512_16way_job_init(sha256_avx512_16way_job *job, const uint32_t midstate[8],
+                                  const uint8_t header76[76]);
+void sha256_avx512_16way_double_job(const sha256_avx512_16way_job *job, uint32_t base, uint8_t digests[16][32]);
+
+/** Candidate lane mask of nonces base .. base + 15 (see sha256_sse4_4way_mask_job). */
+uint32_t sha256_avx512_16way_mask_job(const sha256_avx512_16way_job *job, uint32_t base, uint32_t target_top);
+
+#else
+
+typedef struct {
+    uint32_t unused;
+} sha256_avx512_16way_job;
+
+static inline void sha256_avx512_16way_job_init(sha256_avx512_16way_job *job, const uint32_t midstate[8],
+                                                const uint8_t header76[76]) {
+    (void)job;
+    (void)midstate;
+    (void)header76;
+}
+
+static inline void sha256_avx512_16way_double_job(const sha256_avx512_16way_job *job, uint32_t base,
+                                                  uint8_t digests[16][32]) {
+    (void)job;
+    (void)base;
+    (void)digests;
+}
+
+static inline uint32_t sha256_avx512_16way_mask_job(const sha256_avx512_16way_job *job, uint32_t base,
+                                                    uint32_t target_top) {
+    (void)job;
+    (void)base;
+    (void)target_top;
+    return 0;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,122 @@
+/*
+ * On-device flavor calibration: the same prepared-job scans the miner's pool makes, timed per core
+ * cluster, because the fastest flavor differs between devices and between big and little cores.
+ */
+
+#include "sha256_calibrate.h"
+
+#include "miner_log.h"
+
+#include <time.h>
+
+#define CALIBRATE_CHUNK 4096u
+
+#define LOG_TAG "SHA256_Calibrate"
+
+/* Any header will do: with an all-zero target no nonce hits, so every chunk runs to its end. */
+static const uint8_t kCalibrateHeader76[76] = {1};
+static const uint8_t kZeroTarget[32];
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* One chunk of [job] from [n]; with the zero target a flavor that runs returns 0. */
+static int calibrate_chunk(const miner_job *job, uint32_t n, const cpu_scan_cancel *cancel) {
+    uint32_t slot;
+    cpu_scan_hits hits = {.nonces = &slot, .cap = 1, .cancel = cancel};
+    return scan_nonces_job(job, n, n + CALIBRATE_CHUNK - 1u, &hits);
+}
+
+/*
+ * Nonces per second of [flavor] on the calling thread, after one warm-up chunk; < 0 when cancelled. One
+ * token for the whole calibration, so cpuRequestInterrupt between two chunks still stops it.
+ */
+static double measure_flavor(int flavor, uint32_t ms, const cpu_scan_cancel *cancel) {
+    miner_job job;
+    miner_job_init(&job, kCalibrateHeader76, kZeroTarget, flavor);
+    uint32_t n = 0;
+    int r = calibrate_chunk(&job, n, cancel);
+    if (r == CPU_SCAN_INTERRUPTED)
+        return -1.0;
+    if (r == CPU_SHA_FLAVOR_ERROR)
+        return 0.0;
+    n += CALIBRATE_CHUNK;
+    const double budget = (double)ms * 1e-3;
+    const double t0 = now_sec();
+    uint64_t hashes = 0;
+    double dt;
+    do {
+        r = calibrate_chunk(&job, n, cancel);
+        if (r == CPU_SCAN_INTERRUPTED)
+            return -1.0;
+        if (r == CPU_SHA_FLAVOR_ERROR)
+            return 0.0;
+        hashes += CALIBRATE_CHUNK;
+        n += CALIBRATE_CHUNK;
+        dt = now_sec() - t0;
+    } while (dt < budget);
+    return dt > 0.0 ? (double)hashes / dt : 0.0;
+}
+
+int cpu_sha_calibrate(const cpu_cluster *clusters, int nclusters, uint32_t ms_per_flavor, cpu_sha_rank *out,
+                      int max_rows) {
+    int flavors[CPU_SHA_FLAVOR_COUNT];
+    int nflavors = 0;
+    for (int f = 0; f < CPU_SHA_FLAVOR_COUNT; f++) {
+        if (cpu_sha_flavor_supported(f) && cpu_sha_selftest_flavor(f))
+            flavors[nflavors++] = f;
+    }
+    const cpu_scan_cancel cancel = {.epoch = cpu_scan_epoch()};
+    uint64_t saved = 0;
+    const int pin = nclusters > 1 && cpu_topology_get_self(&saved) == 0;
+    int rows = 0;
+    int ret = 0;
+    for (int c = 0; c < nclusters && ret == 0; c++) {
+        if (pin && cpu_topology_pin_self(clusters[c].cpu_mask) != 0) {
+            __android_log_print(ANDROID_LOG_WARN, LOG_TAG, "cluster %d (mask 0x%llx) not pinnable; skipped", c,
+                (unsigned long long)clusters[c].cpu_mask);
+            continue;
+        }
+        const int first = rows;
+        for (int i = 0; i < nflavors && rows < max_rows; i++) {
+            const double hs = measure_flavor(flavors[i], ms_per_flavor, &cancel);
+            if (hs < 0.0) {
+                ret = CPU_SCAN_INTERRUPTED;
+                break;
+            }
+            if (hs <= 0.0)
+                continue;
+            /* Insert in place so this cluster's rows stay fastest first. */
+            int j = rows++;
+            for (; j > first && out[j - 1].hs < hs; j--)
+                out[j] = out[j - 1];
+            out[j] = (cpu_sha_rank){.cluster = c, .flavor = flavors[i], .hs = hs};
+        }
+        if (rows > first) {
+            __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "cluster %d (%d cpus, %u kHz): best %s %.0f H/s", c,
+                clusters[c].ncpus, clusters[c].max_khz, cpu_sha_flavor_label(out[first].flavor), out[first].hs);
+        }
+    }
+    if (pin)
+        cpu_topology_pin_self(saved);
+    return ret != 0 ? ret : rows;
+}
+
+int cpu_sha_calibration_winner(const cpu_cluster *clusters, int nclusters, const cpu_sha_rank *rows, int nrows) {
+    double score[CPU_SHA_FLAVOR_COUNT] = {0};
+    for (int i = 0; i < nrows; i++) {
+        const cpu_sha_rank *r = &rows[i];
+        if (r->flavor < 0 || r->flavor >= CPU_SHA_FLAVOR_COUNT || r->cluster < 0 || r->cluster >= nclusters)
+            continue;
+        score[r->flavor] += r->hs * (double)clusters[r->cluster].ncpus;
+    }
+    int best = -1;
+    for (int f = 0; f < CPU_SHA_FLAVOR_COUNT; f++) {
+        if (score[f] > 0.0 && (best < 0 || score[f] > score[best]))
+            best = f;
+    }
+    return best;
+}
@@ -0,0 +1,40 @@
+#ifndef SHA256_CALIBRATE_H
+#define SHA256_CALIBRATE_H
+
+#include "cpu_topology.h"
+#include "sha256_scan.h"
+
+#include <stdint.h>
+
+/*
+ * Version of the CPU kernels and flavor set; bump it with any change to either. The app keys its stored
+ * calibration on it, so a library whose kernels differ recalibrates instead of reusing a stale winner.
+ */
+#define CPU_SHA_KERNELS_VERSION 1
+
+/* Upper bound on calibration rows: every flavor on every cluster. */
+#define CPU_CALIBRATE_MAX_ROWS (CPU_TOPOLOGY_MAX_CLUSTERS * CPU_SHA_FLAVOR_COUNT)
+
+/** One measured (cluster, flavor) pair; [cluster] indexes the cluster array passed to cpu_sha_calibrate. */
+typedef struct {
+    int cluster;
+    int flavor;
+    double hs;
+} cpu_sha_rank;
+
+/**
+ * Micro-calibration for CpuSha256Flavor.AUTO. Every flavor that is supported and passes
+ * cpu_sha_selftest_flavor scans for [ms_per_flavor] on each cluster, with the calling thread pinned to
+ * that cluster (its affinity is restored afterwards). Rows are grouped by cluster, fastest flavor first.
+ * Returns the row count, or CPU_SCAN_INTERRUPTED when cpuRequestInterrupt fired meanwhile.
+ */
+int cpu_sha_calibrate(const cpu_cluster *clusters, int nclusters, uint32_t ms_per_flavor, cpu_sha_rank *out,
+                      int max_rows);
+
+/**
+ * Flavor with the best whole-device rate: per-cluster H/s times the cluster's CPU count, summed over
+ * clusters. -1 when [rows] is empty.
+ */
+int cpu_sha_calibration_winner(const cpu_cluster *clusters, int nclusters, const cpu_sha_rank *rows, int nrows);
+
+#endif
@@ -0,0 +1,378 @@
+/*
+ * Lane-width-generic double SHA-256 of Bitcoin headers, instantiated once per SIMD backend.
+ *
+ * Not a normal header: a backend .c file defines the vector policy below and then includes this
+ * file, which emits static functions named <LANES_PREFIX>_<name>. Every lane hashes the same
+ * 76-byte prefix with its own nonce, so shared header words and the fixed padding of both hashes
+ * are broadcast constants and only the nonce word (and everything after it) differs per lane.
+ *
+ * Policy (all required unless noted):
+ *   LANES_PREFIX           function name prefix, e.g. sse4
+ *   LANES_N                lanes per vector (nonces per call)
+ *   LANES_VEC              vector type of LANES_N uint32_t lanes
+ *   V_SET1(u32)            broadcast
+ *   V_LOADU(const uint32_t *p)    load LANES_N words
+ *   V_STORE(uint32_t *p, v)       store LANES_N words (p aligned to LANES_ALIGN)
+ *   V_ADD, V_XOR, V_AND, V_OR     lane-wise 32-bit ops
+ *   V_SHR(x, n), V_ROTR(x, n)     shifts / rotates by a literal
+ *   V_BSWAP(x)             byte swap within each 32-bit lane
+ *   LANES_ALIGN            alignment of the V_STORE scratch buffer (optional, default 16)
+ *   V_XOR3, V_CH, V_MAJ    optional fused forms (e.g. AVX-512 vpternlogd); defaults use the ops above
+ *   V_LE_MASK(x, t)        optional: uint32_t with bit l set where lane l of x <= t (unsigned); the
+ *                          default stores both vectors and compares per lane
+ *
+ * Emits:
+ *   <prefix>_one_block(LANES_VEC s[8], const LANES_VEC w[16])
+ *   <prefix>_double_mid(const uint32_t midstate[8], const uint8_t header76[76],
+ *                       const uint32_t nonces[LANES_N], uint8_t digests[LANES_N][32])
+ *   <prefix>_double_full(const uint8_t header76[76], const uint32_t nonces[LANES_N],
+ *                        uint8_t digests[LANES_N][32])
+ *   <prefix>_job_init / <prefix>_job_double: per-job splats and precompute, consecutive nonces built in
+ *                       registers; <prefix>_job_mask: lanes whose final H7 word can still meet a target
+ *   <prefix>_header_block0 / _first_tail / _second / _store: the pipeline stages of the above
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#if !defined(LANES_PREFIX) || !defined(LANES_N) || !defined(LANES_VEC)
+#error "define LANES_PREFIX, LANES_N and LANES_VEC before including sha256_lanes_tmpl.h"
+#endif
+#if LANES_N > 16
+#error "lane_ids covers at most 16 lanes"
+#endif
+
+#ifndef LANES_ALIGN
+#define LANES_ALIGN 16
+#endif
+#ifndef V_XOR3
+#define V_XOR3(a, b, c) V_XOR(V_XOR((a), (b)), (c))
+#endif
+#ifndef V_CH
+#define V_CH(e, f, g) V_XOR(V_AND(V_XOR((f), (g)), (e)), (g))
+#endif
+#ifndef V_MAJ
+#define V_MAJ(a, b, c) V_OR(V_AND((a), (b)), V_AND((c), V_OR((a), (b))))
+#endif
+
+#ifndef V_LE_MASK
+#define V_LE_MASK(x, t) LANES_FN(le_mask)((x), (t))
+#define LANES_GENERIC_LE_MASK 1
+#endif
+
+#define LANES_CAT_(a, b) a##_##b
+#define LANES_CAT(a, b) LANES_CAT_(a, b)
+#define LANES_FN(name) LANES_CAT(LANES_PREFIX, name)
+
+static const uint32_t LANES_FN(K)[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const uint32_t LANES_FN(IV)[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+static inline uint32_t LANES_FN(be32)(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+#ifdef LANES_GENERIC_LE_MASK
+static inline uint32_t LANES_FN(le_mask)(LANES_VEC x, LANES_VEC t) {
+    uint32_t xs[LANES_N] __attribute__((aligned(LANES_ALIGN)));
+    uint32_t ts[LANES_N] __attribute__((aligned(LANES_ALIGN)));
+    uint32_t mask = 0;
+    V_STORE(xs, x);
+    V_STORE(ts, t);
+    for (int l = 0; l < LANES_N; l++)
+        mask |= (uint32_t)(xs[l] <= ts[l]) << l;
+    return mask;
+}
+#endif
+
+/* Scalar helpers for the per-job precompute and the constant schedule terms. */
+static inline uint32_t LANES_FN(rotr)(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+static inline uint32_t LANES_FN(ssig0)(uint32_t x) {
+    return LANES_FN(rotr)(x, 7) ^ LANES_FN(rotr)(x, 18) ^ (x >> 3);
+}
+
+static inline uint32_t LANES_FN(ssig1)(uint32_t x) {
+    return LANES_FN(rotr)(x, 17) ^ LANES_FN(rotr)(x, 19) ^ (x >> 10);
+}
+
+#define LANES_SIG0(x) V_XOR3(V_ROTR((x), 7), V_ROTR((x), 18), V_SHR((x), 3))
+#define LANES_SIG1(x) V_XOR3(V_ROTR((x), 17), V_ROTR((x), 19), V_SHR((x), 10))
+
+/* W[from..to-1] from the words before them. */
+static inline void LANES_FN(schedule)(LANES_VEC w[64], int from, int to) {
+    for (int i = from; i < to; i++)
+        w[i] = V_ADD(V_ADD(LANES_SIG1(w[i - 2]), w[i - 7]), V_ADD(LANES_SIG0(w[i - 15]), w[i - 16]));
+}
+
+/* Rounds [from]..[to]-1 on the working variables [v] (a..h); no feed-forward. */
+static inline void LANES_FN(rounds)(LANES_VEC v[8], const LANES_VEC w[64], int from, int to) {
+    LANES_VEC a = v[0], b = v[1], c = v[2], d = v[3], e = v[4], f = v[5], g = v[6], h = v[7];
+    for (int i = from; i < to; i++) {
+        const LANES_VEC ep1 = V_XOR3(V_ROTR(e, 6), V_ROTR(e, 11), V_ROTR(e, 25));
+        const LANES_VEC ep0 = V_XOR3(V_ROTR(a, 2), V_ROTR(a, 13), V_ROTR(a, 22));
+        const LANES_VEC t1 = V_ADD(V_ADD(V_ADD(h, ep1), V_CH(e, f, g)), V_ADD(V_SET1(LANES_FN(K)[i]), w[i]));
+        const LANES_VEC t2 = V_ADD(ep0, V_MAJ(a, b, c));
+        h = g;
+        g = f;
+        f = e;
+        e = V_ADD(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = V_ADD(t1, t2);
+    }
+    v[0] = a;
+    v[1] = b;
+    v[2] = c;
+    v[3] = d;
+    v[4] = e;
+    v[5] = f;
+    v[6] = g;
+    v[7] = h;
+}
+
+/* One compression of 16 message words per lane into [s] (eight state vectors, a..h). */
+static void LANES_FN(one_block)(LANES_VEC s[8], const LANES_VEC in[16]) {
+    LANES_VEC w[64];
+    LANES_VEC v[8];
+    for (int i = 0; i < 16; i++)
+        w[i] = in[i];
+    LANES_FN(schedule)(w, 16, 64);
+    for (int i = 0; i < 8; i++)
+        v[i] = s[i];
+    LANES_FN(rounds)(v, w, 0, 64);
+    for (int i = 0; i < 8; i++)
+        s[i] = V_ADD(s[i], v[i]);
+}
+
+/* State after block 0 of the shared 76-byte prefix (the midstate, computed per lane). */
+static inline void LANES_FN(header_block0)(LANES_VEC s[8], const uint8_t header76[76]) {
+    LANES_VEC w[16];
+    for (int i = 0; i < 8; i++)
+        s[i] = V_SET1(LANES_FN(IV)[i]);
+    for (int i = 0; i < 16; i++)
+        w[i] = V_SET1(LANES_FN(be32)(header76 + i * 4));
+    LANES_FN(one_block)(s, w);
+}
+
+/* First hash, block 1: broadcast header tail words, the per-lane nonce word, fixed padding for 80 bytes. */
+static inline void LANES_FN(first_tail)(LANES_VEC s[8], const LANES_VEC tail[3], LANES_VEC nonce_word) {
+    LANES_VEC w[16];
+    w[0] = tail[0];
+    w[1] = tail[1];
+    w[2] = tail[2];
+    w[3] = nonce_word;
+    w[4] = V_SET1(0x80000000u);
+    for (int i = 5; i < 15; i++)
+        w[i] = V_SET1(0u);
+    w[15] = V_SET1(80u * 8u);
+    LANES_FN(one_block)(s, w);
+}
+
+/*
+ * Second hash message W0..W31: [s] (the first digest) padded for 32 bytes. W8..W15 are that fixed
+ * padding, so their terms in W16..W31 are folded to constants instead of re-expanded.
+ */
+static inline void LANES_FN(second_msg)(LANES_VEC w[64], const LANES_VEC s[8]) {
+    for (int i = 0; i < 8; i++)
+        w[i] = s[i];
+    w[8] = V_SET1(0x80000000u);
+    for (int i = 9; i < 15; i++)
+        w[i] = V_SET1(0u);
+    w[15] = V_SET1(32u * 8u);
+    w[16] = V_ADD(LANES_SIG0(w[1]), w[0]);
+    w[17] = V_ADD(V_SET1(LANES_FN(ssig1)(32u * 8u)), V_ADD(LANES_SIG0(w[2]), w[1]));
+    for (int i = 18; i < 22; i++)
+        w[i] = V_ADD(LANES_SIG1(w[i - 2]), V_ADD(LANES_SIG0(w[i - 15]), w[i - 16]));
+    w[22] = V_ADD(V_ADD(LANES_SIG1(w[20]), V_SET1(32u * 8u)), V_ADD(LANES_SIG0(w[7]), w[6]));
+    w[23] = V_ADD(V_ADD(LANES_SIG1(w[21]), w[16]), V_ADD(V_SET1(LANES_FN(ssig0)(0x80000000u)), w[7]));
+    w[24] = V_ADD(V_ADD(LANES_SIG1(w[22]), w[17]), V_SET1(0x80000000u));
+    for (int i = 25; i < 30; i++)
+        w[i] = V_ADD(LANES_SIG1(w[i - 2]), w[i - 7]);
+    w[30] = V_ADD(V_ADD(LANES_SIG1(w[28]), w[23]), V_SET1(LANES_FN(ssig0)(32u * 8u)));
+    w[31] = V_ADD(V_ADD(LANES_SIG1(w[29]), w[24]), V_ADD(LANES_SIG0(w[16]), V_SET1(32u * 8u)));
+}
+
+/* Second hash in place: [s] (the first digest) becomes the final digest state. */
+static inline void LANES_FN(second)(LANES_VEC s[8]) {
+    LANES_VEC w[64];
+    LANES_VEC v[8];
+    LANES_FN(second_msg)(w, s);
+    LANES_FN(schedule)(w, 32, 64);
+    for (int i = 0; i < 8; i++)
+        v[i] = V_SET1(LANES_FN(IV)[i]);
+    LANES_FN(rounds)(v, w, 0, 64);
+    for (int i = 0; i < 8; i++)
+        s[i] = V_ADD(v[i], V_SET1(LANES_FN(IV)[i]));
+}
+
+/*
+ * H7 (last state word) of the second hash only. The e written by round 60 is the final h, so rounds
+ * 61..63, W61..W63 and the other seven feed-forward adds are skipped.
+ */
+static inline LANES_VEC LANES_FN(second_h7)(const LANES_VEC s[8]) {
+    LANES_VEC w[64];
+    LANES_VEC v[8];
+    LANES_FN(second_msg)(w, s);
+    LANES_FN(schedule)(w, 32, 61);
+    for (int i = 0; i < 8; i++)
+        v[i] = V_SET1(LANES_FN(IV)[i]);
+    LANES_FN(rounds)(v, w, 0, 61);
+    return V_ADD(v[4], V_SET1(LANES_FN(IV)[7]));
+}
+
+/* Big-endian digest bytes per lane. */
+static inline void LANES_FN(store)(const LANES_VEC s[8], uint8_t digests[LANES_N][32]) {
+    uint32_t tmp[LANES_N] __attribute__((aligned(LANES_ALIGN)));
+    for (int i = 0; i < 8; i++) {
+        V_STORE(tmp, V_BSWAP(s[i]));
+        for (int l = 0; l < LANES_N; l++)
+            memcpy(&digests[l][i * 4], &tmp[l], 4);
+    }
+}
+
+static inline void LANES_FN(tail_words)(LANES_VEC tail[3], const uint8_t header76[76]) {
+    tail[0] = V_SET1(LANES_FN(be32)(header76 + 64));
+    tail[1] = V_SET1(LANES_FN(be32)(header76 + 68));
+    tail[2] = V_SET1(LANES_FN(be32)(header76 + 72));
+}
+
+static inline void LANES_FN(double_full)(const uint8_t header76[76], const uint32_t nonces[LANES_N],
+                                         uint8_t digests[LANES_N][32]) {
+    LANES_VEC s[8];
+    LANES_VEC tail[3];
+    LANES_FN(header_block0)(s, header76);
+    LANES_FN(tail_words)(tail, header76);
+    LANES_FN(first_tail)(s, tail, V_BSWAP(V_LOADU(nonces)));
+    LANES_FN(second)(s);
+    LANES_FN(store)(s, digests);
+}
+
+/*
+ * Job API: the midstate and header tail are splatted once per job; each call then hashes the
+ * consecutive nonces base .. base + LANES_N - 1, building the nonce word in registers.
+ *
+ * Only W3 (the nonce) of the first hash's block 1 varies within a job, so job_init also runs rounds
+ * 0..2 (W0..W2 are the merkle tail, ntime and nbits) and the nonce-free parts of W16..W19; W4..W15 are
+ * the fixed 80-byte padding. A backend may name its own job type with LANES_JOB: a struct with
+ * LANES_VEC mid[8], tail[3], pre_state[8] and pre_w[4].
+ */
+#ifndef LANES_JOB
+typedef struct {
+    LANES_VEC mid[8];
+    LANES_VEC tail[3];
+    LANES_VEC pre_state[8];
+    LANES_VEC pre_w[4];
+} LANES_FN(job);
+#define LANES_JOB LANES_FN(job)
+#endif
+
+static const uint32_t LANES_FN(lane_ids)[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
+static inline void LANES_FN(job_init)(LANES_JOB *job, const uint32_t midstate[8], const uint8_t header76[76]) {
+    uint32_t w[3];
+    uint32_t v[8];
+    for (int i = 0; i < 3; i++)
+        w[i] = LANES_FN(be32)(header76 + 64 + i * 4);
+    for (int i = 0; i < 8; i++) {
+        job->mid[i] = V_SET1(midstate[i]);
+        v[i] = midstate[i];
+    }
+    LANES_FN(tail_words)(job->tail, header76);
+    for (int i = 0; i < 3; i++) {
+        const uint32_t e = v[4], a = v[0];
+        const uint32_t ep1 = LANES_FN(rotr)(e, 6) ^ LANES_FN(rotr)(e, 11) ^ LANES_FN(rotr)(e, 25);
+        const uint32_t ep0 = LANES_FN(rotr)(a, 2) ^ LANES_FN(rotr)(a, 13) ^ LANES_FN(rotr)(a, 22);
+        const uint32_t t1 = v[7] + ep1 + ((e & v[5]) ^ (~e & v[6])) + LANES_FN(K)[i] + w[i];
+        const uint32_t t2 = ep0 + ((a & v[1]) ^ (a & v[2]) ^ (v[1] & v[2]));
+        v[7] = v[6];
+        v[6] = v[5];
+        v[5] = e;
+        v[4] = v[3] + t1;
+        v[3] = v[2];
+        v[2] = v[1];
+        v[1] = a;
+        v[0] = t1 + t2;
+    }
+    for (int i = 0; i < 8; i++)
+        job->pre_state[i] = V_SET1(v[i]);
+    const uint32_t w16 = LANES_FN(ssig0)(w[1]) + w[0];
+    const uint32_t w17 = LANES_FN(ssig1)(80u * 8u) + LANES_FN(ssig0)(w[2]) + w[1];
+    job->pre_w[0] = V_SET1(w16);
+    job->pre_w[1] = V_SET1(w17);
+    job->pre_w[2] = V_SET1(LANES_FN(ssig1)(w16) + w[2]);                 /* + sigma0(W3) */
+    job->pre_w[3] = V_SET1(LANES_FN(ssig1)(w17) + LANES_FN(ssig0)(0x80000000u)); /* + W3 */
+}
+
+/* First hash, block 1, from the job's precompute: rounds 3..63 with only the nonce-dependent schedule. */
+static inline void LANES_FN(first_tail_pre)(LANES_VEC s[8], const LANES_JOB *job, LANES_VEC nonce_word) {
+    LANES_VEC w[64];
+    LANES_VEC v[8];
+    w[0] = job->tail[0];
+    w[1] = job->tail[1];
+    w[2] = job->tail[2];
+    w[3] = nonce_word;
+    w[4] = V_SET1(0x80000000u);
+    for (int i = 5; i < 15; i++)
+        w[i] = V_SET1(0u);
+    w[15] = V_SET1(80u * 8u);
+    w[16] = job->pre_w[0];
+    w[17] = job->pre_w[1];
+    w[18] = V_ADD(job->pre_w[2], LANES_SIG0(nonce_word));
+    w[19] = V_ADD(job->pre_w[3], nonce_word);
+    w[20] = V_ADD(LANES_SIG1(w[18]), V_SET1(0x80000000u));
+    w[21] = LANES_SIG1(w[19]);
+    w[22] = V_ADD(LANES_SIG1(w[20]), V_SET1(80u * 8u));
+    for (int i = 23; i < 30; i++)
+        w[i] = V_ADD(LANES_SIG1(w[i - 2]), w[i - 7]);
+    w[30] = V_ADD(V_ADD(LANES_SIG1(w[28]), w[23]), V_SET1(LANES_FN(ssig0)(80u * 8u)));
+    w[31] = V_ADD(V_ADD(LANES_SIG1(w[29]), w[24]), V_ADD(LANES_SIG0(w[16]), V_SET1(80u * 8u)));
+    LANES_FN(schedule)(w, 32, 64);
+    for (int i = 0; i < 8; i++)
+        v[i] = job->pre_state[i];
+    LANES_FN(rounds)(v, w, 3, 64);
+    for (int i = 0; i < 8; i++)
+        s[i] = V_ADD(job->mid[i], v[i]);
+}
+
+static inline void LANES_FN(job_double)(const LANES_JOB *job, uint32_t base, uint8_t digests[LANES_N][32]) {
+    LANES_VEC s[8];
+    LANES_FN(first_tail_pre)(s, job, V_BSWAP(V_ADD(V_SET1(base), V_LOADU(LANES_FN(lane_ids)))));
+    LANES_FN(second)(s);
+    LANES_FN(store)(s, digests);
+}
+
+/*
+ * Lane mask of nonces base .. base + LANES_N - 1 that can still meet a target whose most significant
+ * word (target bytes 0..3, big-endian) is [target_top]: the byte-swapped H7 is the top word of the
+ * hash as a uint256, compared in registers. Only the masked lanes need job_double and a full compare.
+ */
+static inline uint32_t LANES_FN(job_mask)(const LANES_JOB *job, uint32_t base, uint32_t target_top) {
+    LANES_VEC s[8];
+    LANES_FN(first_tail_pre)(s, job, V_BSWAP(V_ADD(V_SET1(base), V_LOADU(LANES_FN(lane_ids)))));
+    return V_LE_MASK(V_BSWAP(LANES_FN(second_h7)(s)), V_SET1(target_top));
+}
+
+static inline void LANES_FN(double_mid)(const uint32_t midstate[8], const uint8_t header76[76],
+                                        const uint32_t nonces[LANES_N], uint8_t digests[LANES_N][32]) {
+    LANES_JOB job;
+    LANES_VEC s[8];
+    LANES_FN(job_init)(&job, midstate, header76);
+    LANES_FN(first_tail_pre)(s, &job, V_BSWAP(V_LOADU(nonces)));
+    LANES_FN(second)(s);
+    LANES_FN(store)(s, digests);
+}
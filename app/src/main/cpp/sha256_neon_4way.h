@@ -5,6 +5,37 @@
 
 #if defined(__aarch64__)
 
+#include <arm_neon.h>
+
+/**
+ * Per-job constants splatted to all four lanes: midstate, header tail words, and the nonce-independent
+ * precompute (state after rounds 0..2 of block 1, partial W16..W19).
+ */
+typedef struct {
+    uint32x4_t mid[8];
+    uint32x4_t tail[3];
+    uint32x4_t pre_state[8];
+    uint32x4_t pre_w[4];
+} sha256_neon4_job;
+
+/** Splats [midstate] and the header tail (bytes 64–75) and runs the per-job precompute. */
+void sha256_neon4_job_init(sha256_neon4_job *job, const uint32_t midstate[8], const uint8_t header76[76]);
+
+/** Double SHA-256 of nonces base .. base + 3 for [job]; the nonce word is built in registers. */
+void sha256_neon4_double_job(const sha256_neon4_job *job, uint32_t base, uint8_t digests[4][32]);
+
+/**
+ * Bit l set when nonce base + l can still meet a target whose top word (bytes 0–3, big-endian) is
+ * [target_top]; the outer hash stops after round 60 and the compare runs on the H7 lanes. Only masked
+ * lanes need sha256_neon4_double_job and a full compare.
+ */
+uint32_t sha256_neon4_mask_job(const sha256_neon4_job *job, uint32_t base, uint32_t target_top);
+
+/* ARMv8.2-A SHA3 builds (EOR3) of the three job functions above; only when CPU_FEATURE_ARM_SHA3 is set. */
+void sha256_neon4_sha3_job_init(sha256_neon4_job *job, const uint32_t midstate[8], const uint8_t header76[76]);
+void sha256_neon4_sha3_double_job(const sha256_neon4_job *job, uint32_t base, uint8_t digests[4][32]);
+uint32_t sha256_neon4_sha3_mask_job(const sha256_neon4_job *job, uint32_t base, uint32_t target_top);
+
 /**
  * Double SHA-256 for four 80-byte Bitcoin headers that share the first 76 bytes;
  * nonces are little-endian at offsets 76–79. Writes 32-byte digests per lane.
@@ -18,8 +49,65 @@ void sha256_neon4_double(const uint8_t header76[76], uint32_t n0, uint32_t n1, u
 void sha256_neon4_double_mid(const uint32_t midstate[8], const uint8_t header76[76],
                              uint32_t n0, uint32_t n1, uint32_t n2, uint32_t n3, uint8_t digests[4][32]);
 
+/* Single pipeline stages of the functions above, exported for bench/minerstages.c. */
+
+/** First SHA-256 only; [midstate] NULL hashes block 0 as well. */
+void sha256_neon4_first(const uint32_t *midstate, const uint8_t header76[76], uint32_t n0, uint32_t n1, uint32_t n2,
+                        uint32_t n3, uint8_t digests[4][32]);
+
+/** Second SHA-256 of four 32-byte digests. */
+void sha256_neon4_second(const uint8_t in[4][32], uint8_t out[4][32]);
+
+/** Big-endian serialisation of lane-major state words ([word][lane]) into per-lane digests. */
+void sha256_neon4_store_digests(const uint32_t words[8][4], uint8_t out[4][32]);
+
 #else
 
+typedef struct {
+    uint32_t unused;
+} sha256_neon4_job;
+
+static inline void sha256_neon4_job_init(sha256_neon4_job *job, const uint32_t midstate[8],
+                                         const uint8_t header76[76]) {
+    (void)job;
+    (void)midstate;
+    (void)header76;
+}
+
+static inline void sha256_neon4_double_job(const sha256_neon4_job *job, uint32_t base, uint8_t digests[4][32]) {
+    (void)job;
+    (void)base;
+    (void)digests;
+}
+
+static inline uint32_t sha256_neon4_mask_job(const sha256_neon4_job *job, uint32_t base, uint32_t target_top) {
+    (void)job;
+    (void)base;
+    (void)target_top;
+    return 0;
+}
+
+static inline void sha256_neon4_first(const uint32_t *midstate, const uint8_t header76[76], uint32_t n0, uint32_t n1,
+                                      uint32_t n2, uint32_t n3, uint8_t digests[4][32]) {
+    (void)midstate;
+    (void)header76;
+    (void)n0;
+    (void)n1;
+    (void)n2;
+    (void)n3;
+    (void)digests;
+}
+
+static inline void sha256_neon4_second(const uint8_t in[4][32], uint8_t out[4][32]) {
+    (void)in;
+    (void)out;
+}
+
+static inline void sha256_neon4_store_digests(const uint32_t words[8][4], uint8_t out[4][32]) {
+    (void)words;
+    (void)out;
+}
+
 static inline void sha256_neon4_double(const uint8_t header76[76], uint32_t n0, uint32_t n1, uint32_t n2,
                                        uint32_t n3, uint8_t digests[4][32]) {
     (void)header76;
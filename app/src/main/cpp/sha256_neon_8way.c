@@ -0,0 +1,81 @@
+/*
+ * Eight-lane SHA-256 (NEON) as two interleaved quads: each vector op of sha256_lanes_tmpl.h expands
+ * to the same op on both halves of a uint32x4x2_t, so every round issues two independent dependency
+ * chains and the wide NEON pipes of big cores stay busy. Same job API as sha256_neon_4way.c, and
+ * likewise built a second time with SHA256_NEON_SHA3 (EOR3) as sha256_neon8_sha3_*.
+ */
+
+#include "sha256_neon_8way.h"
+
+#if defined(__aarch64__)
+
+#include <arm_neon.h>
+
+#if defined(SHA256_NEON_SHA3)
+#if !defined(__ARM_FEATURE_SHA3)
+#error "SHA256_NEON_SHA3 needs -march=...+sha3"
+#endif
+#define NEON8_API(name) sha256_neon8_sha3_##name
+#else
+#define NEON8_API(name) sha256_neon8_##name
+#endif
+
+static inline uint32x4x2_t n8_pair(uint32x4_t lo, uint32x4_t hi) {
+    uint32x4x2_t r;
+    r.val[0] = lo;
+    r.val[1] = hi;
+    return r;
+}
+
+/* Both halves get the same op; [x] must be side-effect free (it is expanded twice). */
+#define N8_MAP1(op, x) n8_pair(op((x).val[0]), op((x).val[1]))
+#define N8_MAP2(op, a, b) n8_pair(op((a).val[0], (b).val[0]), op((a).val[1], (b).val[1]))
+#define N8_MAP3(op, a, b, c) n8_pair(op((a).val[0], (b).val[0], (c).val[0]), op((a).val[1], (b).val[1], (c).val[1]))
+
+#define N8_ROTR(x, n) vsriq_n_u32(vshlq_n_u32((x), 32 - (n)), (x), (n))
+#define N8_BSWAP(x) vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(x)))
+
+#define LANES_PREFIX neon8
+#define LANES_N 8
+#define LANES_VEC uint32x4x2_t
+#define LANES_JOB sha256_neon8_job
+#define V_SET1(x) n8_pair(vdupq_n_u32((uint32_t)(x)), vdupq_n_u32((uint32_t)(x)))
+#define V_LOADU(p) n8_pair(vld1q_u32(p), vld1q_u32((p) + 4))
+#define V_STORE(p, v) (vst1q_u32((p), (v).val[0]), vst1q_u32((p) + 4, (v).val[1]))
+#define V_ADD(a, b) N8_MAP2(vaddq_u32, a, b)
+#define V_XOR(a, b) N8_MAP2(veorq_u32, a, b)
+#define V_AND(a, b) N8_MAP2(vandq_u32, a, b)
+#define V_OR(a, b) N8_MAP2(vorrq_u32, a, b)
+#define V_SHR(x, n) n8_pair(vshrq_n_u32((x).val[0], (n)), vshrq_n_u32((x).val[1], (n)))
+#define V_ROTR(x, n) n8_pair(N8_ROTR((x).val[0], n), N8_ROTR((x).val[1], n))
+#define V_BSWAP(x) N8_MAP1(N8_BSWAP, x)
+#define V_CH(e, f, g) N8_MAP3(vbslq_u32, e, f, g)
+#define V_MAJ(a, b, c) N8_MAP3(vbslq_u32, V_XOR(a, b), c, a)
+#if defined(SHA256_NEON_SHA3)
+#define V_XOR3(a, b, c) N8_MAP3(veor3q_u32, a, b, c)
+#endif
+#define V_LE_MASK(x, t) neon8_lane_le_mask((x), (t))
+
+/* Lanes 0..3 from the low quad, 4..7 from the high quad (see neon4_lane_le_mask). */
+static inline uint32_t neon8_lane_le_mask(uint32x4x2_t x, uint32x4x2_t t) {
+    static const uint32_t kLaneBits[4] = {1, 2, 4, 8};
+    const uint32x4_t bits = vld1q_u32(kLaneBits);
+    return vaddvq_u32(vandq_u32(vcleq_u32(x.val[0], t.val[0]), bits)) |
+           (vaddvq_u32(vandq_u32(vcleq_u32(x.val[1], t.val[1]), bits)) << 4);
+}
+
+#include "sha256_lanes_tmpl.h"
+
+void NEON8_API(job_init)(sha256_neon8_job *job, const uint32_t midstate[8], const uint8_t header76[76]) {
+    neon8_job_init(job, midstate, header76);
+}
+
+void NEON8_API(double_job)(const sha256_neon8_job *job, uint32_t base, uint8_t digests[8][32]) {
+    neon8_job_double(job, base, digests);
+}
+
+uint32_t NEON8_API(mask_job)(const sha256_neon8_job *job, uint32_t base, uint32_t target_top) {
+    return neon8_job_mask(job, base, target_top);
+}
+
+#endif
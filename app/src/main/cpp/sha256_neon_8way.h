@@ -0,0 +1,63 @@
+#ifndef SHA256_NEON_8WAY_H
+#define SHA256_NEON_8WAY_H
+
+#include <stdint.h>
+
+#if defined(__aarch64__)
+
+#include <arm_neon.h>
+
+/** Per-job constants for the 8-way kernel, two quads each; same fields as sha256_neon4_job. */
+typedef struct {
+    uint32x4x2_t mid[8];
+    uint32x4x2_t tail[3];
+    uint32x4x2_t pre_state[8];
+    uint32x4x2_t pre_w[4];
+} sha256_neon8_job;
+
+/** Splats [midstate] and the header tail (bytes 64–75) and runs the per-job precompute. */
+void sha256_neon8_job_init(sha256_neon8_job *job, const uint32_t midstate[8], const uint8_t header76[76]);
+
+/**
+ * Double SHA-256 of nonces base .. base + 7: two independent NEON quads whose rounds are interleaved,
+ * so two dependency chains are in flight per instruction stream. Writes 32-byte digests per lane.
+ */
+void sha256_neon8_double_job(const sha256_neon8_job *job, uint32_t base, uint8_t digests[8][32]);
+
+/** Candidate lane mask of nonces base .. base + 7 (see sha256_neon4_mask_job). */
+uint32_t sha256_neon8_mask_job(const sha256_neon8_job *job, uint32_t base, uint32_t target_top);
+
+/* ARMv8.2-A SHA3 builds (EOR3) of the three job functions above; only when CPU_FEATURE_ARM_SHA3 is set. */
+void sha256_neon8_sha3_job_init(sha256_neon8_job *job, const uint32_t midstate[8], const uint8_t header76[76]);
+void sha256_neon8_sha3_double_job(const sha256_neon8_job *job, uint32_t base, uint8_t digests[8][32]);
+uint32_t sha256_neon8_sha3_mask_job(const sha256_neon8_job *job, uint32_t base, uint32_t target_top);
+
+#else
+
+typedef struct {
+    uint32_t unused;
+} sha256_neon8_job;
+
+static inline void sha256_neon8_job_init(sha256_neon8_job *job, const uint32_t midstate[8],
+                                         const uint8_t header76[76]) {
+    (void)job;
+    (void)midstate;
+    (void)header76;
+}
+
+static inline void sha256_neon8_double_job(const sha256_neon8_job *job, uint32_t base, uint8_t digests[8][32]) {
+    (void)job;
+    (void)base;
+    (void)digests;
+}
+
+static inline uint32_t sha256_neon8_mask_job(const sha256_neon8_job *job, uint32_t base, uint32_t target_top) {
+    (void)job;
+    (void)base;
+    (void)target_top;
+    return 0;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,236 @@
+/*
+ * Portable scalar double SHA-256 for SCALAR and SCALAR_MIDSTATE (and the midstate of the SIMD flavors
+ * that have no SHA instructions). Rounds are fully unrolled with the eight working names rotating
+ * through the round macro, and the schedule is a rolling 16-word window, so the state and message
+ * stay in registers. Padding words are literal constants the compiler folds into the schedule, and the
+ * nonce enters as a single byte-swapped word. sha256.c stays the reference the self-test checks against.
+ */
+
+#include "sha256_scalar_job.h"
+
+static const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const uint32_t IV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define BSIG0(x) (ROTR(x, 2) ^ ROTR(x, 13) ^ ROTR(x, 22))
+#define BSIG1(x) (ROTR(x, 6) ^ ROTR(x, 11) ^ ROTR(x, 25))
+#define SSIG0(x) (ROTR(x, 7) ^ ROTR(x, 18) ^ ((x) >> 3))
+#define SSIG1(x) (ROTR(x, 17) ^ ROTR(x, 19) ^ ((x) >> 10))
+#define CH(e, f, g) ((g) ^ ((e) & ((f) ^ (g))))
+#define MAJ(a, b, c) (((a) & (b)) | ((c) & ((a) | (b))))
+
+/* Round [i] with schedule word [wi]: only d (the new e) and h (the new a) are written. */
+#define RND(a, b, c, d, e, f, g, h, i, wi)                               \
+    do {                                                                 \
+        const uint32_t t1_ = (h) + BSIG1(e) + CH(e, f, g) + K[i] + (wi); \
+        (d) += t1_;                                                      \
+        (h) = t1_ + BSIG0(a) + MAJ(a, b, c);                             \
+    } while (0)
+
+/* Round i with the names rotated by i % 8, so eight rounds bring a..h back to their own names. */
+#define R0(i, wi) RND(a, b, c, d, e, f, g, h, i, wi)
+#define R1(i, wi) RND(h, a, b, c, d, e, f, g, i, wi)
+#define R2(i, wi) RND(g, h, a, b, c, d, e, f, i, wi)
+#define R3(i, wi) RND(f, g, h, a, b, c, d, e, i, wi)
+#define R4(i, wi) RND(e, f, g, h, a, b, c, d, i, wi)
+#define R5(i, wi) RND(d, e, f, g, h, a, b, c, i, wi)
+#define R6(i, wi) RND(c, d, e, f, g, h, a, b, i, wi)
+#define R7(i, wi) RND(b, c, d, e, f, g, h, a, i, wi)
+
+/* W[i] from the window: W[i - 16] is the slot it replaces. */
+#define WLOAD(i) (w[i])
+#define WNEXT(i) (w[(i) & 15] += SSIG1(w[((i) - 2) & 15]) + w[((i) - 7) & 15] + SSIG0(w[((i) - 15) & 15]))
+
+#define RND8(i, W)                \
+    R0((i) + 0, W((i) + 0));      \
+    R1((i) + 1, W((i) + 1));      \
+    R2((i) + 2, W((i) + 2));      \
+    R3((i) + 3, W((i) + 3));      \
+    R4((i) + 4, W((i) + 4));      \
+    R5((i) + 5, W((i) + 5));      \
+    R6((i) + 6, W((i) + 6));      \
+    R7((i) + 7, W((i) + 7))
+
+static inline uint32_t be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static inline void store_digest(const uint32_t s[8], uint8_t digest[32]) {
+    for (int i = 0; i < 8; i++) {
+        digest[i * 4 + 0] = (uint8_t)(s[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(s[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(s[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)s[i];
+    }
+}
+
+void sha256_scalar_compress(uint32_t state[8], const uint8_t block[64]) {
+    uint32_t w[16];
+    for (int i = 0; i < 16; i++)
+        w[i] = be32(block + i * 4);
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    RND8(0, WLOAD);
+    RND8(8, WLOAD);
+    RND8(16, WNEXT);
+    RND8(24, WNEXT);
+    RND8(32, WNEXT);
+    RND8(40, WNEXT);
+    RND8(48, WNEXT);
+    RND8(56, WNEXT);
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+/*
+ * Second hash of the first digest [s] (padded for 32 bytes: W8 = 0x80000000, W15 = 256, the rest
+ * zero), in place. With [h7_only] it stops after round 60, whose new e is the final h, and returns H7.
+ */
+static inline uint32_t scalar_second(uint32_t s[8], int h7_only) {
+    uint32_t w[16] = {s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7], 0x80000000u, 0, 0, 0, 0, 0, 0, 32u * 8u};
+    uint32_t a = IV[0], b = IV[1], c = IV[2], d = IV[3];
+    uint32_t e = IV[4], f = IV[5], g = IV[6], h = IV[7];
+    RND8(0, WLOAD);
+    RND8(8, WLOAD);
+    RND8(16, WNEXT);
+    RND8(24, WNEXT);
+    RND8(32, WNEXT);
+    RND8(40, WNEXT);
+    RND8(48, WNEXT);
+    R0(56, WNEXT(56));
+    R1(57, WNEXT(57));
+    R2(58, WNEXT(58));
+    R3(59, WNEXT(59));
+    R4(60, WNEXT(60));
+    if (h7_only)
+        return h + IV[7];
+    R5(61, WNEXT(61));
+    R6(62, WNEXT(62));
+    R7(63, WNEXT(63));
+    s[0] = a + IV[0];
+    s[1] = b + IV[1];
+    s[2] = c + IV[2];
+    s[3] = d + IV[3];
+    s[4] = e + IV[4];
+    s[5] = f + IV[5];
+    s[6] = g + IV[6];
+    s[7] = h + IV[7];
+    return s[7];
+}
+
+void sha256_scalar_hash32(const uint8_t d32[32], uint8_t out[32]) {
+    uint32_t s[8];
+    for (int i = 0; i < 8; i++)
+        s[i] = be32(d32 + i * 4);
+    scalar_second(s, 0);
+    store_digest(s, out);
+}
+
+void sha256_scalar_job_init(sha256_scalar_job *job, const uint32_t midstate[8], const uint8_t header76[76]) {
+    for (int i = 0; i < 8; i++)
+        job->mid[i] = midstate[i];
+    for (int i = 0; i < 3; i++)
+        job->tail[i] = be32(header76 + 64 + i * 4);
+    uint32_t a = midstate[0], b = midstate[1], c = midstate[2], d = midstate[3];
+    uint32_t e = midstate[4], f = midstate[5], g = midstate[6], h = midstate[7];
+    R0(0, job->tail[0]);
+    R1(1, job->tail[1]);
+    R2(2, job->tail[2]);
+    job->pre_state[0] = a;
+    job->pre_state[1] = b;
+    job->pre_state[2] = c;
+    job->pre_state[3] = d;
+    job->pre_state[4] = e;
+    job->pre_state[5] = f;
+    job->pre_state[6] = g;
+    job->pre_state[7] = h;
+    const uint32_t w16 = SSIG0(job->tail[1]) + job->tail[0];
+    const uint32_t w17 = SSIG1(80u * 8u) + SSIG0(job->tail[2]) + job->tail[1];
+    job->pre_w[0] = w16;
+    job->pre_w[1] = w17;
+    job->pre_w[2] = SSIG1(w16) + job->tail[2];       /* + sigma0(W3) */
+    job->pre_w[3] = SSIG1(w17) + SSIG0(0x80000000u); /* + W3 */
+}
+
+/*
+ * First hash, block 1, for [nonce]: rounds 3..63 from the job's precompute, fed forward into [s].
+ * pre_state holds the variables by name as rotation 2 left them, so rotation 3 continues from there.
+ */
+static inline void scalar_first(const sha256_scalar_job *job, uint32_t nonce, uint32_t s[8]) {
+    uint32_t w[16] = {job->tail[0], job->tail[1], job->tail[2], __builtin_bswap32(nonce), 0x80000000u, 0, 0, 0,
+                      0, 0, 0, 0, 0, 0, 0, 80u * 8u};
+    uint32_t a = job->pre_state[0], b = job->pre_state[1], c = job->pre_state[2], d = job->pre_state[3];
+    uint32_t e = job->pre_state[4], f = job->pre_state[5], g = job->pre_state[6], h = job->pre_state[7];
+    R3(3, w[3]);
+    R4(4, w[4]);
+    R5(5, w[5]);
+    R6(6, w[6]);
+    R7(7, w[7]);
+    RND8(8, WLOAD);
+    w[0] = job->pre_w[0];
+    R0(16, w[0]);
+    w[1] = job->pre_w[1];
+    R1(17, w[1]);
+    w[2] = job->pre_w[2] + SSIG0(w[3]);
+    R2(18, w[2]);
+    w[3] = job->pre_w[3] + w[3];
+    R3(19, w[3]);
+    R4(20, WNEXT(20));
+    R5(21, WNEXT(21));
+    R6(22, WNEXT(22));
+    R7(23, WNEXT(23));
+    RND8(24, WNEXT);
+    RND8(32, WNEXT);
+    RND8(40, WNEXT);
+    RND8(48, WNEXT);
+    RND8(56, WNEXT);
+    s[0] = job->mid[0] + a;
+    s[1] = job->mid[1] + b;
+    s[2] = job->mid[2] + c;
+    s[3] = job->mid[3] + d;
+    s[4] = job->mid[4] + e;
+    s[5] = job->mid[5] + f;
+    s[6] = job->mid[6] + g;
+    s[7] = job->mid[7] + h;
+}
+
+void sha256_scalar_double_job(const sha256_scalar_job *job, uint32_t nonce, uint8_t digest[32]) {
+    uint32_t s[8];
+    scalar_first(job, nonce, s);
+    scalar_second(s, 0);
+    store_digest(s, digest);
+}
+
+int sha256_scalar_may_meet_job(const sha256_scalar_job *job, uint32_t nonce, uint32_t target_top) {
+    uint32_t s[8];
+    scalar_first(job, nonce, s);
+    return __builtin_bswap32(scalar_second(s, 1)) <= target_top;
+}
+
+void sha256_scalar_double80(const uint8_t header76[76], uint32_t nonce, uint8_t digest[32]) {
+    uint32_t mid[8];
+    for (int i = 0; i < 8; i++)
+        mid[i] = IV[i];
+    sha256_scalar_compress(mid, header76);
+    sha256_scalar_job job;
+    sha256_scalar_job_init(&job, mid, header76);
+    sha256_scalar_double_job(&job, nonce, digest);
+}
@@ -0,0 +1,38 @@
+#ifndef SHA256_SCALAR_JOB_H
+#define SHA256_SCALAR_JOB_H
+
+#include <stdint.h>
+
+/**
+ * Per-job constants for the portable one-nonce kernel: midstate, header tail words, and the
+ * nonce-independent precompute (working variables after rounds 0..2 of block 1, partial W16..W19).
+ */
+typedef struct {
+    uint32_t mid[8];
+    uint32_t tail[3];
+    uint32_t pre_state[8];
+    uint32_t pre_w[4];
+} sha256_scalar_job;
+
+/** One block with a rolling 16-word schedule and unrolled rounds; same contract as sha256_compress. */
+void sha256_scalar_compress(uint32_t state[8], const uint8_t block[64]);
+
+/** Stores [midstate] and the header tail (bytes 64–75) and runs the per-job precompute. */
+void sha256_scalar_job_init(sha256_scalar_job *job, const uint32_t midstate[8], const uint8_t header76[76]);
+
+/** Double SHA-256 of header76 || nonce for [job]; only the nonce-dependent rounds and schedule run. */
+void sha256_scalar_double_job(const sha256_scalar_job *job, uint32_t nonce, uint8_t digest[32]);
+
+/**
+ * Single-word fast reject: nonzero when header76 || nonce can still meet a target whose top word
+ * (bytes 0–3, big-endian) is [target_top]. The outer hash stops after round 60.
+ */
+int sha256_scalar_may_meet_job(const sha256_scalar_job *job, uint32_t nonce, uint32_t target_top);
+
+/** Double SHA-256 of header76 || nonce with no midstate reuse (SCALAR); block 0 runs on every call. */
+void sha256_scalar_double80(const uint8_t header76[76], uint32_t nonce, uint8_t digest[32]);
+
+/** SHA-256 of a 32-byte digest (the outer hash), with the padding words folded in. */
+void sha256_scalar_hash32(const uint8_t d32[32], uint8_t out[32]);
+
+#endif
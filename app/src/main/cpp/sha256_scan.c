@@ -1,31 +1,80 @@
 /*
- * CPU nonce scanning: scalar / midstate / ARM SHA2 / NEON 4-way dispatch.
+ * CPU nonce scanning: scalar / midstate / ARM SHA2 / NEON 4- and 8-way / x86 SHA-NI / SSE4 / AVX2 / AVX-512
+ * dispatch.
  */
 
+#include "sha256_scan.h"
+#include "cpu_features.h"
+#include "miner_log.h"
 #include "sha256.h"
 #include "sha256_arm_sha2.h"
+#include "sha256_avx2_8way.h"
+#include "sha256_avx512_16way.h"
 #include "sha256_neon_4way.h"
+#include "sha256_neon_8way.h"
+#include "sha256_scalar_job.h"
+#include "sha256_sse4_4way.h"
+#include "sha256_x86_shani.h"
 
+#include <pthread.h>
 #include <stdatomic.h>
 #include <stdint.h>
 #include <string.h>
 
-#include <android/log.h>
-
 #define HEADER_PREFIX_SIZE 76
 #define BLOCK_HEADER_SIZE 80
 #define HASH_SIZE 32
 
-#define CPU_SHA_FLAVOR_ERROR (-4)
+/* Written only by cpu_scan_cancel_all; each scan loop loads it once per CPU_SCAN_POLL_NONCES. */
+static _Atomic uint32_t g_cpu_job_epoch = 0;
 
-extern atomic_int g_cpu_interrupt_requested;
+uint32_t cpu_scan_epoch(void) {
+    return atomic_load_explicit(&g_cpu_job_epoch, memory_order_acquire);
+}
 
-/* Bitcoin / bitcoinjs: compare reverse(double-SHA256(header)) to target (see bitcoinjs Block.checkProofOfWork). */
-static int hash_meets_target(const uint8_t *hash, const uint8_t *target) {
-    uint8_t rev[HASH_SIZE];
-    for (int i = 0; i < HASH_SIZE; i++)
-        rev[i] = hash[HASH_SIZE - 1 - i];
-    return memcmp(rev, target, HASH_SIZE) <= 0;
+void cpu_scan_cancel_all(void) {
+    atomic_fetch_add_explicit(&g_cpu_job_epoch, 1u, memory_order_release);
+}
+
+/*
+ * Bitcoin / bitcoinjs: reverse(double-SHA256(header)) <= target (see bitcoinjs Block.checkProofOfWork),
+ * compared a word at a time from the top. Digest bytes 28..31 read little-endian are the hash's most
+ * significant word, so nearly every miss is decided by the first compare.
+ */
+static inline uint32_t hash_word(const uint8_t *hash, int i) {
+    const uint8_t *p = hash + HASH_SIZE - 4 - 4 * i;
+    return ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | (uint32_t)p[0];
+}
+
+/* [tw] is the target as words, w[0] most significant (miner_job.target_w). */
+static int hash_meets_target(const uint8_t *hash, const uint256 *tw) {
+    for (int i = 0; i < 8; i++) {
+        const uint32_t h = hash_word(hash, i);
+        if (h != tw->w[i])
+            return h < tw->w[i];
+    }
+    return 1;
+}
+
+/* Strictly lower as PoW integers; [a] and [b] are both digests. */
+static int hash_below(const uint8_t *a, const uint8_t *b) {
+    for (int i = 0; i < 8; i++) {
+        const uint32_t x = hash_word(a, i);
+        const uint32_t y = hash_word(b, i);
+        if (x != y)
+            return x < y;
+    }
+    return 0;
+}
+
+/* Big-endian serialisation of the final state words (the digest_from_state stage). */
+static inline void digest_from_state(const uint32_t s[8], uint8_t digest32[32]) {
+    for (int i = 0; i < 8; i++) {
+        digest32[i * 4 + 0] = (uint8_t)(s[i] >> 24);
+        digest32[i * 4 + 1] = (uint8_t)(s[i] >> 16);
+        digest32[i * 4 + 2] = (uint8_t)(s[i] >> 8);
+        digest32[i * 4 + 3] = (uint8_t)s[i];
+    }
 }
 
 static void midstate_after_block0(const uint8_t *header76, uint32_t mid[8], void (*compress)(uint32_t *, const uint8_t *, size_t)) {
@@ -48,17 +97,12 @@ static void first_hash_mid(const uint32_t mid[8], const uint8_t *header76, uint3
     uint32_t s[8];
     memcpy(s, mid, sizeof(s));
     compress(s, block, 1);
-    for (int i = 0; i < 8; i++) {
-        digest32[i * 4 + 0] = (uint8_t)(s[i] >> 24);
-        digest32[i * 4 + 1] = (uint8_t)(s[i] >> 16);
-        digest32[i * 4 + 2] = (uint8_t)(s[i] >> 8);
-        digest32[i * 4 + 3] = (uint8_t)s[i];
-    }
+    digest_from_state(s, digest32);
 }
 
 static void scalar_compress_fn(uint32_t *st, const uint8_t *c, size_t blocks) {
     while (blocks--) {
-        sha256_compress(st, c);
+        sha256_scalar_compress(st, c);
         c += 64;
     }
 }
@@ -67,17 +111,21 @@ static void scalar_compress_fn(uint32_t *st, const uint8_t *c, size_t blocks) {
 static void arm_compress_fn(uint32_t *st, const uint8_t *c, size_t blocks) {
     sha256_arm_compress(st, c, blocks);
 }
-#else
-static void arm_compress_fn(uint32_t *st, const uint8_t *c, size_t blocks) {
-    (void)st;
-    (void)c;
-    (void)blocks;
-}
 #endif
 
-/** Bitcoin double-SHA256 outer step only: [d32] is already SHA256(header80). */
-static void double_from_mid_digest(const uint8_t d32[32], uint8_t final_hash[32]) {
-    sha256(d32, SHA256_DIGEST_SIZE, final_hash);
+/** Outer step through [compress]: the 32-byte digest plus fixed padding is exactly one block. */
+static void double_from_mid_digest_fn(const uint8_t d32[32], uint8_t final_hash[32],
+                                      void (*compress)(uint32_t *, const uint8_t *, size_t)) {
+    uint8_t block[64];
+    memcpy(block, d32, 32);
+    block[32] = 0x80;
+    memset(block + 33, 0, 29);
+    block[62] = 0x01; /* bit length 256 */
+    block[63] = 0x00;
+    uint32_t st[8];
+    sha256_initial_state(st);
+    compress(st, block, 1);
+    digest_from_state(st, final_hash);
 }
 
 static void header80_from_76_nonce(const uint8_t *header76, uint32_t nonce, uint8_t *header80) {
@@ -88,227 +136,676 @@ static void header80_from_76_nonce(const uint8_t *header76, uint32_t nonce, uint
     header80[79] = (uint8_t)(nonce >> 24);
 }
 
-static int scan_scalar_full(const uint8_t *header76, uint32_t start, uint32_t end, const uint8_t *target) {
-    uint8_t h80[BLOCK_HEADER_SIZE];
-    uint8_t hash[HASH_SIZE];
-    memcpy(h80, header76, HEADER_PREFIX_SIZE);
-    for (uint32_t nonce = start; nonce <= end; nonce++) {
-        if (((nonce - start) & 0xFFFFu) == 0u &&
-            atomic_exchange_explicit(&g_cpu_interrupt_requested, 0, memory_order_acq_rel)) {
-            return -3;
-        }
-        h80[76] = (uint8_t)nonce;
-        h80[77] = (uint8_t)(nonce >> 8);
-        h80[78] = (uint8_t)(nonce >> 16);
-        h80[79] = (uint8_t)(nonce >> 24);
-        sha256_double(h80, BLOCK_HEADER_SIZE, hash);
-        if (hash_meets_target(hash, target)) return (int)nonce;
+/*
+ * Every scanner below records each winning nonce through scan_hit and ends with one of: 0 after
+ * the whole range (scan_done), CPU_SCAN_FULL right after the hit that filled the buffer, or
+ * CPU_SCAN_INTERRUPTED (scan_interrupted). All three leave hits->scanned = nonces hashed from start.
+ * Loops break after hashing [end] rather than testing past it, so a range ending at UINT32_MAX does not
+ * wrap to nonce 0.
+ */
+#define CPU_SCAN_FULL 1
+
+/* Records [nonce]; nonzero once the buffer is full and the scan has to stop. */
+static inline int scan_hit(cpu_scan_hits *hits, uint32_t start, uint32_t nonce) {
+    hits->nonces[hits->count++] = nonce;
+    if (hits->count < hits->cap)
+        return 0;
+    hits->scanned = (uint64_t)(nonce - start) + 1u;
+    return 1;
+}
+
+/* Plain loads, no read-modify-write: a cancelled token stays cancelled for every scan holding it. */
+static inline int scan_cancelled(const cpu_scan_hits *hits) {
+    const cpu_scan_cancel *c = hits->cancel;
+    return c && (atomic_load_explicit(&g_cpu_job_epoch, memory_order_relaxed) != c->epoch ||
+                 (c->stop && atomic_load_explicit(c->stop, memory_order_relaxed)));
+}
+
+static inline int scan_interrupted(cpu_scan_hits *hits, uint32_t start, uint32_t next) {
+    hits->scanned = (uint64_t)(next - start);
+    return CPU_SCAN_INTERRUPTED;
+}
+
+static inline int scan_done(cpu_scan_hits *hits, uint32_t start, uint32_t end) {
+    hits->scanned = (uint64_t)(end - start) + 1u;
+    return 0;
+}
+
+/*
+ * Per-digest bookkeeping: keeps the lowest hash in hits->best_* (the top-word compare settles nearly
+ * every call) and records [nonce] when the hash meets the target. Nonzero once the buffer is full.
+ */
+static inline int scan_check(cpu_scan_hits *hits, const uint256 *tw, uint32_t start, const uint8_t *hash,
+                             uint32_t nonce) {
+    const uint32_t top = hash_word(hash, 0);
+    if (top <= hits->best_top && (top < hits->best_top || hash_below(hash, hits->best_hash))) {
+        hits->best_top = top;
+        hits->best_nonce = nonce;
+        memcpy(hits->best_hash, hash, HASH_SIZE);
     }
-    return -1;
+    return hash_meets_target(hash, tw) && scan_hit(hits, start, nonce);
 }
 
-static int scan_scalar_mid(const uint8_t *header76, uint32_t start, uint32_t end, const uint8_t *target) {
-    uint32_t mid[8];
-    midstate_after_block0(header76, mid, scalar_compress_fn);
-    uint8_t d32[32];
+static int scan_scalar_full(const miner_job *job, uint32_t start, uint32_t end, cpu_scan_hits *hits) {
+    const uint256 *tw = &job->target_w;
     uint8_t hash[HASH_SIZE];
-    for (uint32_t nonce = start; nonce <= end; nonce++) {
-        if (((nonce - start) & 0xFFFFu) == 0u &&
-            atomic_exchange_explicit(&g_cpu_interrupt_requested, 0, memory_order_acq_rel)) {
-            return -3;
+    for (uint32_t nonce = start;; nonce++) {
+        if (((nonce - start) & (CPU_SCAN_POLL_NONCES - 1u)) == 0u && scan_cancelled(hits)) {
+            return scan_interrupted(hits, start, nonce);
         }
-        first_hash_mid(mid, header76, nonce, d32, scalar_compress_fn);
-        double_from_mid_digest(d32, hash);
-        if (hash_meets_target(hash, target)) return (int)nonce;
+        sha256_scalar_double80(job->header76, nonce, hash);
+        if (scan_check(hits, tw, start, hash, nonce))
+            return CPU_SCAN_FULL;
+        if (nonce == end)
+            break;
     }
-    return -1;
+    return scan_done(hits, start, end);
 }
 
 #if defined(__aarch64__)
 
-static int scan_arm_full(const uint8_t *header76, uint32_t start, uint32_t end, const uint8_t *target) {
-    uint8_t h80[BLOCK_HEADER_SIZE];
-    uint8_t hash[HASH_SIZE];
-    uint8_t dig32[32];
-    for (uint32_t nonce = start; nonce <= end; nonce++) {
-        if (((nonce - start) & 0xFFFFu) == 0u &&
-            atomic_exchange_explicit(&g_cpu_interrupt_requested, 0, memory_order_acq_rel)) {
-            return -3;
-        }
-        header80_from_76_nonce(header76, nonce, h80);
-        uint32_t st[8];
-        sha256_initial_state(st);
-        sha256_arm_compress(st, h80, 1);
-        uint8_t b1[64];
-        sha256_pad_second_block_80(h80 + 64, b1);
-        sha256_arm_compress(st, b1, 1);
-        for (int i = 0; i < 8; i++) {
-            dig32[i * 4 + 0] = (uint8_t)(st[i] >> 24);
-            dig32[i * 4 + 1] = (uint8_t)(st[i] >> 16);
-            dig32[i * 4 + 2] = (uint8_t)(st[i] >> 8);
-            dig32[i * 4 + 3] = (uint8_t)st[i];
-        }
-        sha256(dig32, SHA256_DIGEST_SIZE, hash);
-        if (hash_meets_target(hash, target)) return (int)nonce;
-    }
-    return -1;
+/* First SHA-256 of a full 80-byte header: both blocks through the SHA2 extension, no midstate. */
+static void arm_first_hash_full(const uint8_t h80[BLOCK_HEADER_SIZE], uint8_t d32[32]) {
+    uint32_t st[8];
+    sha256_initial_state(st);
+    sha256_arm_compress(st, h80, 1);
+    uint8_t b1[64];
+    sha256_pad_second_block_80(h80 + 64, b1);
+    sha256_arm_compress(st, b1, 1);
+    digest_from_state(st, d32);
 }
 
-static int scan_arm_mid(const uint8_t *header76, uint32_t start, uint32_t end, const uint8_t *target) {
-    uint32_t mid[8];
-    midstate_after_block0(header76, mid, arm_compress_fn);
-    uint8_t d32[32];
+static int scan_arm_full(const miner_job *job, uint32_t start, uint32_t end, cpu_scan_hits *hits) {
+    const uint256 *tw = &job->target_w;
+    uint8_t h80[BLOCK_HEADER_SIZE];
     uint8_t hash[HASH_SIZE];
-    for (uint32_t nonce = start; nonce <= end; nonce++) {
-        if (((nonce - start) & 0xFFFFu) == 0u &&
-            atomic_exchange_explicit(&g_cpu_interrupt_requested, 0, memory_order_acq_rel)) {
-            return -3;
+    memcpy(h80, job->header76, HEADER_PREFIX_SIZE);
+    for (uint32_t nonce = start;; nonce++) {
+        if (((nonce - start) & (CPU_SCAN_POLL_NONCES - 1u)) == 0u && scan_cancelled(hits)) {
+            return scan_interrupted(hits, start, nonce);
         }
-        first_hash_mid(mid, header76, nonce, d32, arm_compress_fn);
-        double_from_mid_digest(d32, hash);
-        if (hash_meets_target(hash, target)) return (int)nonce;
+        h80[76] = (uint8_t)nonce;
+        h80[77] = (uint8_t)(nonce >> 8);
+        h80[78] = (uint8_t)(nonce >> 16);
+        h80[79] = (uint8_t)(nonce >> 24);
+        sha256_arm_double80(h80, hash);
+        if (scan_check(hits, tw, start, hash, nonce))
+            return CPU_SCAN_FULL;
+        if (nonce == end)
+            break;
     }
-    return -1;
+    return scan_done(hits, start, end);
 }
 
-static int scan_neon4_full(const uint8_t *header76, uint32_t start, uint32_t end, const uint8_t *target) {
+static int scan_neon4_full(const miner_job *job, uint32_t start, uint32_t end, cpu_scan_hits *hits) {
+    const uint8_t *header76 = job->header76;
+    const uint256 *tw = &job->target_w;
     uint32_t n = start;
     uint8_t dig[4][32];
-    while (n <= end) {
-        if (((n - start) & 0xFFFFu) == 0u &&
-            atomic_exchange_explicit(&g_cpu_interrupt_requested, 0, memory_order_acq_rel)) {
-            return -3;
+    for (;;) {
+        if (((n - start) & (CPU_SCAN_POLL_NONCES - 1u)) == 0u && scan_cancelled(hits)) {
+            return scan_interrupted(hits, start, n);
         }
-        if (n + 3 <= end) {
+        if (end - n >= 3u) {
             sha256_neon4_double(header76, n, n + 1, n + 2, n + 3, dig);
             for (int l = 0; l < 4; l++) {
-                if (hash_meets_target(dig[l], target)) return (int)(n + (uint32_t)l);
+                if (scan_check(hits, tw, start, dig[l], n + (uint32_t)l))
+                    return CPU_SCAN_FULL;
             }
+            if (end - n == 3u)
+                break;
             n += 4;
         } else {
             uint8_t h80[80];
             header80_from_76_nonce(header76, n, h80);
             uint8_t one[32];
             sha256_double(h80, BLOCK_HEADER_SIZE, one);
-            if (hash_meets_target(one, target)) return (int)n;
+            if (scan_check(hits, tw, start, one, n))
+                return CPU_SCAN_FULL;
+            if (n == end)
+                break;
             n++;
         }
     }
-    return -1;
-}
-
-static int scan_neon4_mid(const uint8_t *header76, uint32_t start, uint32_t end, const uint8_t *target) {
-    uint32_t mid[8];
-    midstate_after_block0(header76, mid, scalar_compress_fn);
-    uint32_t n = start;
-    uint8_t dig[4][32];
-    uint8_t d32[32];
-    uint8_t hash[HASH_SIZE];
-    while (n <= end) {
-        if (((n - start) & 0xFFFFu) == 0u &&
-            atomic_exchange_explicit(&g_cpu_interrupt_requested, 0, memory_order_acq_rel)) {
-            return -3;
-        }
-        if (n + 3 <= end) {
-            sha256_neon4_double_mid(mid, header76, n, n + 1, n + 2, n + 3, dig);
-            for (int l = 0; l < 4; l++) {
-                if (hash_meets_target(dig[l], target)) return (int)(n + (uint32_t)l);
-            }
-            n += 4;
-        } else {
-            first_hash_mid(mid, header76, n, d32, scalar_compress_fn);
-            double_from_mid_digest(d32, hash);
-            if (hash_meets_target(hash, target)) return (int)n;
-            n++;
-        }
-    }
-    return -1;
+    return scan_done(hits, start, end);
 }
 
 #else
 
-static int scan_arm_full(const uint8_t *h, uint32_t a, uint32_t b, const uint8_t *t) {
-    (void)h;
+static int scan_arm_full(const miner_job *job, uint32_t a, uint32_t b, cpu_scan_hits *hits) {
+    (void)job;
     (void)a;
     (void)b;
-    (void)t;
+    (void)hits;
     return CPU_SHA_FLAVOR_ERROR;
 }
-static int scan_arm_mid(const uint8_t *h, uint32_t a, uint32_t b, const uint8_t *t) {
-    (void)h;
+static int scan_neon4_full(const miner_job *job, uint32_t a, uint32_t b, cpu_scan_hits *hits) {
+    (void)job;
     (void)a;
     (void)b;
-    (void)t;
+    (void)hits;
     return CPU_SHA_FLAVOR_ERROR;
 }
-static int scan_neon4_full(const uint8_t *h, uint32_t a, uint32_t b, const uint8_t *t) {
-    (void)h;
-    (void)a;
-    (void)b;
-    (void)t;
-    return CPU_SHA_FLAVOR_ERROR;
+#endif
+
+#if defined(__x86_64__)
+
+static int scan_shani_mid(const miner_job *job, uint32_t start, uint32_t end, cpu_scan_hits *hits) {
+    const uint256 *tw = &job->target_w;
+    uint8_t d32[32];
+    uint8_t hash[HASH_SIZE];
+    for (uint32_t nonce = start;; nonce++) {
+        if (((nonce - start) & (CPU_SCAN_POLL_NONCES - 1u)) == 0u && scan_cancelled(hits)) {
+            return scan_interrupted(hits, start, nonce);
+        }
+        first_hash_mid(job->midstate, job->header76, nonce, d32, sha256_x86_compress);
+        double_from_mid_digest_fn(d32, hash, sha256_x86_compress);
+        if (scan_check(hits, tw, start, hash, nonce))
+            return CPU_SCAN_FULL;
+        if (nonce == end)
+            break;
+    }
+    return scan_done(hits, start, end);
 }
-static int scan_neon4_mid(const uint8_t *h, uint32_t a, uint32_t b, const uint8_t *t) {
-    (void)h;
+
+#else
+
+static int scan_shani_mid(const miner_job *job, uint32_t a, uint32_t b, cpu_scan_hits *hits) {
+    (void)job;
     (void)a;
     (void)b;
-    (void)t;
+    (void)hits;
     return CPU_SHA_FLAVOR_ERROR;
 }
 
 #endif
 
-int scan_nonces_dispatch(int flavor, const uint8_t *header76, uint32_t start, uint32_t end, const uint8_t *target) {
+/*
+ * Multi-lane kernels share one contract: digests of header76 || n .. n + lanes - 1 for a job image set
+ * up once per job from the midstate (miner_job.lanes). [compress] hashes the single-nonce tail when
+ * fewer than [lanes] nonces remain. [full] kernels hash block 0 themselves on every call.
+ * One-lane kernels (SCALAR_MIDSTATE, HW_SHA2_MIDSTATE) use the same loop with [lanes] = 1.
+ *
+ * [probe], when set, returns the mask of lanes whose final H7 word (the outer hash stops after round
+ * 60) can still meet the target's top word: a digest's top 32 bits as a uint256 are bswap(H7). The
+ * compare runs on the state lanes, so [kernel] and the full compare run only for the rare candidates.
+ * The probe threshold also admits lanes that tie or beat the best hash's top word, which after the
+ * first few vectors of a call is rarer still (a new minimum roughly once per doubling of the nonces).
+ */
+#define LANES_MAX 16
+#define LANES_JOB_BYTES MINER_JOB_LANES_BYTES
+_Static_assert(LANES_MAX <= CPU_SCAN_POLL_NONCES, "a lane step must not skip a poll window");
+
+typedef struct {
+    void (*compress)(uint32_t *, const uint8_t *, size_t);
+    void (*job_init)(void *job, const uint32_t mid[8], const uint8_t *header76);
+    void (*kernel)(const void *job, uint32_t n, uint8_t (*digests)[32]);
+    int lanes;
+    int full;
+    uint32_t (*probe)(const void *job, uint32_t n, uint32_t target_top);
+} lanes_kernel;
+
+/* Job for kernels that take the midstate and header directly rather than pre-splatted vectors. */
+typedef struct {
+    uint32_t mid[8];
+    const uint8_t *header76;
+} plain_lanes_job;
+
+static void plain_lanes_job_init(void *job, const uint32_t mid[8], const uint8_t *header76) {
+    plain_lanes_job *j = (plain_lanes_job *)job;
+    memcpy(j->mid, mid, sizeof(j->mid));
+    j->header76 = header76;
+}
+
+static void scalar_job_init_fn(void *job, const uint32_t mid[8], const uint8_t *header76) {
+    sha256_scalar_job_init((sha256_scalar_job *)job, mid, header76);
+}
+
+static void scalar_lanes(const void *job, uint32_t n, uint8_t (*digests)[32]) {
+    sha256_scalar_double_job((const sha256_scalar_job *)job, n, digests[0]);
+}
+
+static uint32_t scalar_probe(const void *job, uint32_t n, uint32_t target_top) {
+    return (uint32_t)sha256_scalar_may_meet_job((const sha256_scalar_job *)job, n, target_top);
+}
+
+_Static_assert(sizeof(sha256_scalar_job) <= LANES_JOB_BYTES, "LANES_JOB_BYTES too small");
+
+static const lanes_kernel kScalarLanes = {scalar_compress_fn, scalar_job_init_fn, scalar_lanes, 1, 0,
+                                          scalar_probe};
+
+#if defined(__aarch64__)
+
+static void neon4_job_init_fn(void *job, const uint32_t mid[8], const uint8_t *header76) {
+    sha256_neon4_job_init((sha256_neon4_job *)job, mid, header76);
+}
+
+static void neon4_lanes(const void *job, uint32_t n, uint8_t (*digests)[32]) {
+    sha256_neon4_double_job((const sha256_neon4_job *)job, n, digests);
+}
+
+static uint32_t neon4_probe(const void *job, uint32_t n, uint32_t target_top) {
+    return sha256_neon4_mask_job((const sha256_neon4_job *)job, n, target_top);
+}
+
+_Static_assert(sizeof(sha256_neon4_job) <= LANES_JOB_BYTES, "LANES_JOB_BYTES too small");
+
+static void neon8_job_init_fn(void *job, const uint32_t mid[8], const uint8_t *header76) {
+    sha256_neon8_job_init((sha256_neon8_job *)job, mid, header76);
+}
+
+static void neon8_lanes(const void *job, uint32_t n, uint8_t (*digests)[32]) {
+    sha256_neon8_double_job((const sha256_neon8_job *)job, n, digests);
+}
+
+static uint32_t neon8_probe(const void *job, uint32_t n, uint32_t target_top) {
+    return sha256_neon8_mask_job((const sha256_neon8_job *)job, n, target_top);
+}
+
+_Static_assert(sizeof(sha256_neon8_job) <= LANES_JOB_BYTES, "LANES_JOB_BYTES too small");
+
+/* ARMv8.2 SHA3 builds of the two NEON kernels; same job layout, so only the entry points differ. */
+static void neon4_sha3_job_init_fn(void *job, const uint32_t mid[8], const uint8_t *header76) {
+    sha256_neon4_sha3_job_init((sha256_neon4_job *)job, mid, header76);
+}
+
+static void neon4_sha3_lanes(const void *job, uint32_t n, uint8_t (*digests)[32]) {
+    sha256_neon4_sha3_double_job((const sha256_neon4_job *)job, n, digests);
+}
+
+static uint32_t neon4_sha3_probe(const void *job, uint32_t n, uint32_t target_top) {
+    return sha256_neon4_sha3_mask_job((const sha256_neon4_job *)job, n, target_top);
+}
+
+static void neon8_sha3_job_init_fn(void *job, const uint32_t mid[8], const uint8_t *header76) {
+    sha256_neon8_sha3_job_init((sha256_neon8_job *)job, mid, header76);
+}
+
+static void neon8_sha3_lanes(const void *job, uint32_t n, uint8_t (*digests)[32]) {
+    sha256_neon8_sha3_double_job((const sha256_neon8_job *)job, n, digests);
+}
+
+static uint32_t neon8_sha3_probe(const void *job, uint32_t n, uint32_t target_top) {
+    return sha256_neon8_sha3_mask_job((const sha256_neon8_job *)job, n, target_top);
+}
+
+static void arm2_lanes(const void *job, uint32_t n, uint8_t (*digests)[32]) {
+    const plain_lanes_job *j = (const plain_lanes_job *)job;
+    sha256_arm_double_mid_2way(j->mid, j->header76, n, n + 1u, digests);
+}
+
+static void arm3_lanes(const void *job, uint32_t n, uint8_t (*digests)[32]) {
+    const plain_lanes_job *j = (const plain_lanes_job *)job;
+    sha256_arm_double_mid_3way(j->mid, j->header76, n, n + 1u, n + 2u, digests);
+}
+
+static void arm1_lanes(const void *job, uint32_t n, uint8_t (*digests)[32]) {
+    const plain_lanes_job *j = (const plain_lanes_job *)job;
+    sha256_arm_double_mid(j->mid, j->header76, n, digests[0]);
+}
+
+/* The SHA2-extension kernels keep H7 in a scalar lane, so their mask is built from the words. */
+static uint32_t arm1_probe(const void *job, uint32_t n, uint32_t target_top) {
+    const plain_lanes_job *j = (const plain_lanes_job *)job;
+    return (uint32_t)(__builtin_bswap32(sha256_arm_h7_mid(j->mid, j->header76, n)) <= target_top);
+}
+
+static uint32_t arm2_probe(const void *job, uint32_t n, uint32_t target_top) {
+    const plain_lanes_job *j = (const plain_lanes_job *)job;
+    uint32_t h7[2];
+    sha256_arm_h7_mid_2way(j->mid, j->header76, n, n + 1u, h7);
+    return (uint32_t)(__builtin_bswap32(h7[0]) <= target_top) |
+           ((uint32_t)(__builtin_bswap32(h7[1]) <= target_top) << 1);
+}
+
+static uint32_t arm3_probe(const void *job, uint32_t n, uint32_t target_top) {
+    const plain_lanes_job *j = (const plain_lanes_job *)job;
+    uint32_t h7[3];
+    sha256_arm_h7_mid_3way(j->mid, j->header76, n, n + 1u, n + 2u, h7);
+    uint32_t mask = 0;
+    for (int l = 0; l < 3; l++)
+        mask |= (uint32_t)(__builtin_bswap32(h7[l]) <= target_top) << l;
+    return mask;
+}
+
+static const lanes_kernel kArm1Lanes = {arm_compress_fn, plain_lanes_job_init, arm1_lanes, 1, 0, arm1_probe};
+static const lanes_kernel kNeon4Lanes = {scalar_compress_fn, neon4_job_init_fn, neon4_lanes, 4, 0, neon4_probe};
+static const lanes_kernel kNeon8Lanes = {scalar_compress_fn, neon8_job_init_fn, neon8_lanes, 8, 0, neon8_probe};
+static const lanes_kernel kArm2Lanes = {arm_compress_fn, plain_lanes_job_init, arm2_lanes, 2, 0, arm2_probe};
+static const lanes_kernel kArm3Lanes = {arm_compress_fn, plain_lanes_job_init, arm3_lanes, 3, 0, arm3_probe};
+static const lanes_kernel kNeon4Sha3Lanes = {scalar_compress_fn, neon4_sha3_job_init_fn, neon4_sha3_lanes, 4, 0,
+                                             neon4_sha3_probe};
+static const lanes_kernel kNeon8Sha3Lanes = {scalar_compress_fn, neon8_sha3_job_init_fn, neon8_sha3_lanes, 8, 0,
+                                             neon8_sha3_probe};
+
+#endif
+
+#if defined(__x86_64__)
+
+static void shani2_lanes(const void *job, uint32_t n, uint8_t (*digests)[32]) {
+    const plain_lanes_job *j = (const plain_lanes_job *)job;
+    sha256_x86_double_mid_2way(j->mid, j->header76, n, n + 1u, digests);
+}
+
+static void sse4_4way_full_lanes(const void *job, uint32_t n, uint8_t (*digests)[32]) {
+    const plain_lanes_job *j = (const plain_lanes_job *)job;
+    sha256_sse4_4way_double(j->header76, n, n + 1u, n + 2u, n + 3u, digests);
+}
+
+static void sse4_4way_job_init_fn(void *job, const uint32_t mid[8], const uint8_t *header76) {
+    sha256_sse4_4way_job_init((sha256_sse4_4way_job *)job, mid, header76);
+}
+
+static void sse4_4way_mid_lanes(const void *job, uint32_t n, uint8_t (*digests)[32]) {
+    sha256_sse4_4way_double_job((const sha256_sse4_4way_job *)job, n, digests);
+}
+
+static uint32_t sse4_4way_mid_probe(const void *job, uint32_t n, uint32_t target_top) {
+    return sha256_sse4_4way_mask_job((const sha256_sse4_4way_job *)job, n, target_top);
+}
+
+_Static_assert(sizeof(sha256_sse4_4way_job) <= LANES_JOB_BYTES, "LANES_JOB_BYTES too small");
+
+static void avx2_8way_job_init_fn(void *job, const uint32_t mid[8], const uint8_t *header76) {
+    sha256_avx2_8way_job_init((sha256_avx2_8way_job *)job, mid, header76);
+}
+
+static void avx2_8way_lanes(const void *job, uint32_t n, uint8_t (*digests)[32]) {
+    sha256_avx2_8way_double_job((const sha256_avx2_8way_job *)job, n, digests);
+}
+
+static uint32_t avx2_8way_probe(const void *job, uint32_t n, uint32_t target_top) {
+    return sha256_avx2_8way_mask_job((const sha256_avx2_8way_job *)job, n, target_top);
+}
+
+_Static_assert(sizeof(sha256_avx2_8way_job) <= LANES_JOB_BYTES, "LANES_JOB_BYTES too small");
+
+static void avx512_16way_job_init_fn(void *job, const uint32_t mid[8], const uint8_t *header76) {
+    sha256_avx512_16way_job_init((sha256_avx512_16way_job *)job, mid, header76);
+}
+
+static void avx512_16way_lanes(const void *job, uint32_t n, uint8_t (*digests)[32]) {
+    sha256_avx512_16way_double_job((const sha256_avx512_16way_job *)job, n, digests);
+}
+
+static uint32_t avx512_16way_probe(const void *job, uint32_t n, uint32_t target_top) {
+    return sha256_avx512_16way_mask_job((const sha256_avx512_16way_job *)job, n, target_top);
+}
+
+_Static_assert(sizeof(sha256_avx512_16way_job) <= LANES_JOB_BYTES, "LANES_JOB_BYTES too small");
+
+/* AVX-512VL builds of the SSE4 and AVX2 kernels (vprord / vpternlogd on 128- and 256-bit vectors). */
+static void sse4_4way_vl_full_lanes(const void *job, uint32_t n, uint8_t (*digests)[32]) {
+    const plain_lanes_job *j = (const plain_lanes_job *)job;
+    sha256_sse4_4way_vl_double(j->header76, n, n + 1u, n + 2u, n + 3u, digests);
+}
+
+static void sse4_4way_vl_job_init_fn(void *job, const uint32_t mid[8], const uint8_t *header76) {
+    sha256_sse4_4way_vl_job_init((sha256_sse4_4way_job *)job, mid, header76);
+}
+
+static void sse4_4way_vl_mid_lanes(const void *job, uint32_t n, uint8_t (*digests)[32]) {
+    sha256_sse4_4way_vl_double_job((const sha256_sse4_4way_job *)job, n, digests);
+}
+
+static uint32_t sse4_4way_vl_mid_probe(const void *job, uint32_t n, uint32_t target_top) {
+    return sha256_sse4_4way_vl_mask_job((const sha256_sse4_4way_job *)job, n, target_top);
+}
+
+static void avx2_8way_vl_job_init_fn(void *job, const uint32_t mid[8], const uint8_t *header76) {
+    sha256_avx2_8way_vl_job_init((sha256_avx2_8way_job *)job, mid, header76);
+}
+
+static void avx2_8way_vl_lanes(const void *job, uint32_t n, uint8_t (*digests)[32]) {
+    sha256_avx2_8way_vl_double_job((const sha256_avx2_8way_job *)job, n, digests);
+}
+
+static uint32_t avx2_8way_vl_probe(const void *job, uint32_t n, uint32_t target_top) {
+    return sha256_avx2_8way_vl_mask_job((const sha256_avx2_8way_job *)job, n, target_top);
+}
+
+static const lanes_kernel kShani2Lanes = {sha256_x86_compress, plain_lanes_job_init, shani2_lanes, 2, 0, NULL};
+/* SSE4 / AVX2 / AVX-512 CPUs need not have SHA-NI, so their midstate and tail stay scalar. */
+static const lanes_kernel kAvx2Lanes = {scalar_compress_fn, avx2_8way_job_init_fn, avx2_8way_lanes, 8, 0,
+                                        avx2_8way_probe};
+static const lanes_kernel kAvx512Lanes = {scalar_compress_fn, avx512_16way_job_init_fn, avx512_16way_lanes, 16, 0,
+                                          avx512_16way_probe};
+static const lanes_kernel kSse4MidLanes = {scalar_compress_fn, sse4_4way_job_init_fn, sse4_4way_mid_lanes, 4, 0,
+                                           sse4_4way_mid_probe};
+static const lanes_kernel kSse4FullLanes = {scalar_compress_fn, plain_lanes_job_init, sse4_4way_full_lanes, 4, 1, NULL};
+static const lanes_kernel kAvx2VlLanes = {scalar_compress_fn, avx2_8way_vl_job_init_fn, avx2_8way_vl_lanes, 8, 0,
+                                          avx2_8way_vl_probe};
+static const lanes_kernel kSse4VlMidLanes = {scalar_compress_fn, sse4_4way_vl_job_init_fn, sse4_4way_vl_mid_lanes,
+                                             4, 0, sse4_4way_vl_mid_probe};
+static const lanes_kernel kSse4VlFullLanes = {scalar_compress_fn, plain_lanes_job_init, sse4_4way_vl_full_lanes, 4, 1,
+                                              NULL};
+
+#endif
+
+/* Baseline-ISA lane kernels built into this binary (SCALAR_MIDSTATE, SHA_NI_2WAY, ...); NULL otherwise. */
+static const lanes_kernel *baseline_lanes_kernel(int flavor) {
     switch (flavor) {
+        case 4:
+            return &kScalarLanes;
+#if defined(__x86_64__)
+        case 7:
+            return &kShani2Lanes;
+        case 8:
+            return &kAvx2Lanes;
+        case 9:
+            return &kAvx512Lanes;
+        case 10:
+            return &kSse4MidLanes;
+        case 11:
+            return &kSse4FullLanes;
+#endif
+#if defined(__aarch64__)
         case 0:
-            return scan_arm_mid(header76, start, end, target);
-        case 1:
-            return scan_arm_full(header76, start, end, target);
+            return &kArm1Lanes;
         case 2:
-            return scan_neon4_mid(header76, start, end, target);
+            return &kNeon4Lanes;
+        case 12:
+            return &kNeon8Lanes;
+        case 13:
+            return &kArm2Lanes;
+        case 14:
+            return &kArm3Lanes;
+#endif
+        default:
+            return NULL;
+    }
+}
+
+/*
+ * Flavor -> lane kernel for this CPU: the baseline builds, upgraded to the newer-ISA builds CMake adds
+ * for the same kernels (NEON with SHA3 EOR3, SSE4 / AVX2 with AVX-512VL) where cpu_features() allows.
+ * Filled once under pthread_once, so every scan thread sees the finished table.
+ */
+static const lanes_kernel *g_lanes_table[CPU_SHA_FLAVOR_COUNT];
+static const char *g_lanes_isa[CPU_SHA_FLAVOR_COUNT];
+static pthread_once_t g_lanes_once = PTHREAD_ONCE_INIT;
+
+static void lanes_table_init(void) {
+    for (int f = 0; f < CPU_SHA_FLAVOR_COUNT; f++) {
+        g_lanes_table[f] = baseline_lanes_kernel(f);
+        g_lanes_isa[f] = "base";
+    }
+    const uint32_t feat = cpu_features();
+#if defined(__aarch64__)
+    if (feat & CPU_FEATURE_ARM_SHA3) {
+        g_lanes_table[2] = &kNeon4Sha3Lanes;
+        g_lanes_table[12] = &kNeon8Sha3Lanes;
+        g_lanes_isa[2] = g_lanes_isa[12] = "sha3";
+    }
+#elif defined(__x86_64__)
+    if (feat & CPU_FEATURE_X86_AVX512VL) {
+        g_lanes_table[8] = &kAvx2VlLanes;
+        g_lanes_table[10] = &kSse4VlMidLanes;
+        g_lanes_table[11] = &kSse4VlFullLanes;
+        g_lanes_isa[8] = g_lanes_isa[10] = g_lanes_isa[11] = "avx512vl";
+    }
+#endif
+    (void)feat;
+}
+
+static const lanes_kernel *lanes_kernel_for_flavor(int flavor) {
+    if (flavor < 0 || flavor >= CPU_SHA_FLAVOR_COUNT)
+        return NULL;
+    pthread_once(&g_lanes_once, lanes_table_init);
+    return g_lanes_table[flavor];
+}
+
+const char *cpu_sha_flavor_isa(int flavor) {
+    if (flavor < 0 || flavor >= CPU_SHA_FLAVOR_COUNT)
+        return "?";
+    pthread_once(&g_lanes_once, lanes_table_init);
+    return g_lanes_isa[flavor];
+}
+
+/* [job]'s lane image must have been prepared for [k] (cpu_sha_prepare_job). */
+static int scan_lanes(const lanes_kernel *k, const miner_job *mj, uint32_t start, uint32_t end, cpu_scan_hits *hits) {
+    if (!k)
+        return CPU_SHA_FLAVOR_ERROR;
+    const void *job = mj->lanes;
+    const uint32_t step = (uint32_t)k->lanes;
+    const uint256 *tw = &mj->target_w;
+    uint32_t n = start;
+    uint8_t dig[LANES_MAX][32];
+    uint8_t d32[32];
+    uint8_t hash[HASH_SIZE];
+    for (;;) {
+        /* Once per poll window, also when [step] is not a power of two. */
+        if (((n - start) & (CPU_SCAN_POLL_NONCES - 1u)) < step && scan_cancelled(hits)) {
+            return scan_interrupted(hits, start, n);
+        }
+        if (end - n >= step - 1u) {
+            if (k->probe) {
+                /* Lanes that can meet the target or beat the best hash so far. */
+                uint32_t cand = k->probe(job, n, tw->w[0] > hits->best_top ? tw->w[0] : hits->best_top);
+                if (cand) {
+                    k->kernel(job, n, dig);
+                    for (; cand; cand &= cand - 1u) {
+                        const uint32_t l = (uint32_t)__builtin_ctz(cand);
+                        if (scan_check(hits, tw, start, dig[l], n + l))
+                            return CPU_SCAN_FULL;
+                    }
+                }
+            } else {
+                k->kernel(job, n, dig);
+                for (uint32_t l = 0; l < step; l++) {
+                    if (scan_check(hits, tw, start, dig[l], n + l))
+                        return CPU_SCAN_FULL;
+                }
+            }
+            if (end - n == step - 1u)
+                break;
+            n += step;
+        } else {
+            first_hash_mid(mj->midstate, mj->header76, n, d32, k->compress);
+            double_from_mid_digest_fn(d32, hash, k->compress);
+            if (scan_check(hits, tw, start, hash, n))
+                return CPU_SCAN_FULL;
+            if (n == end)
+                break;
+            n++;
+        }
+    }
+    return scan_done(hits, start, end);
+}
+
+/* [nonce] through the kernel, in lane nonce % lanes so successive self-test nonces cover several lanes. */
+static void lanes_double(const lanes_kernel *k, const uint8_t *header76, uint32_t nonce, uint8_t out[32]) {
+    if (!k) {
+        memset(out, 0, 32);
+        return;
+    }
+    uint32_t mid[8];
+    midstate_after_block0(header76, mid, k->compress);
+    _Alignas(64) unsigned char job[LANES_JOB_BYTES];
+    k->job_init(job, mid, header76);
+    uint8_t dig[LANES_MAX][32];
+    const uint32_t lane = nonce % (uint32_t)k->lanes;
+    k->kernel(job, nonce - lane, dig);
+    memcpy(out, dig[lane], 32);
+}
+
+static int scan_flavor(const miner_job *job, uint32_t start, uint32_t end, cpu_scan_hits *hits) {
+    switch (job->flavor) {
+        case 1:
+            return scan_arm_full(job, start, end, hits);
         case 3:
-            return scan_neon4_full(header76, start, end, target);
-        case 4:
-            return scan_scalar_mid(header76, start, end, target);
+            return scan_neon4_full(job, start, end, hits);
         case 5:
-            return scan_scalar_full(header76, start, end, target);
+            return scan_scalar_full(job, start, end, hits);
+        case 6:
+            return scan_shani_mid(job, start, end, hits);
+        case 0:
+        case 2:
+        case 4:
+        case 7:
+        case 8:
+        case 9:
+        case 10:
+        case 11:
+        case 12:
+        case 13:
+        case 14:
+            return scan_lanes(lanes_kernel_for_flavor(job->flavor), job, start, end, hits);
         default:
             return CPU_SHA_FLAVOR_ERROR;
     }
 }
 
+void cpu_sha_prepare_job(miner_job *job) {
+    const lanes_kernel *k = cpu_sha_flavor_supported(job->flavor) ? lanes_kernel_for_flavor(job->flavor) : NULL;
+    if (k)
+        k->job_init(job->lanes, job->midstate, job->header76);
+}
+
+int scan_nonces_job(const miner_job *job, uint32_t start, uint32_t end, cpu_scan_hits *hits) {
+    hits->count = 0;
+    hits->scanned = 0;
+    hits->best_nonce = start;
+    hits->best_top = UINT32_MAX;
+    memset(hits->best_hash, 0xff, sizeof(hits->best_hash));
+    /* Runtime gate: a flavor compiled in but missing on this CPU would fault (SIGILL). */
+    if (!cpu_sha_flavor_supported(job->flavor))
+        return CPU_SHA_FLAVOR_ERROR;
+    if (!hits->nonces || hits->cap == 0 || end < start)
+        return 0;
+    const int r = scan_flavor(job, start, end, hits);
+    return r < 0 ? r : (int)hits->count;
+}
+
+int scan_nonces_multi(int flavor, const uint8_t *header76, uint32_t start, uint32_t end, const uint8_t *target,
+                      cpu_scan_hits *hits) {
+    miner_job job;
+    miner_job_init(&job, header76, target, flavor);
+    return scan_nonces_job(&job, start, end, hits);
+}
+
+int scan_nonces_dispatch(int flavor, const uint8_t *header76, uint32_t start, uint32_t end, const uint8_t *target) {
+    uint32_t nonce = 0;
+    const cpu_scan_cancel cancel = {.epoch = cpu_scan_epoch()};
+    cpu_scan_hits hits = {.nonces = &nonce, .cap = 1, .cancel = &cancel};
+    const int r = scan_nonces_multi(flavor, header76, start, end, target, &hits);
+    if (r < 0)
+        return r;
+    return r > 0 ? (int)nonce : CPU_SCAN_MISS;
+}
+
 void cpu_sha256_double_flavor(int flavor, const uint8_t *header76, uint32_t nonce, uint8_t out[32]) {
     uint8_t h80[BLOCK_HEADER_SIZE];
     header80_from_76_nonce(header76, nonce, h80);
     uint8_t d32[32];
     switch (flavor) {
-        case 0: {
-            uint32_t mid[8];
-            midstate_after_block0(header76, mid, arm_compress_fn);
-            first_hash_mid(mid, header76, nonce, d32, arm_compress_fn);
-            double_from_mid_digest(d32, out);
-            break;
-        }
-        case 1: {
+        case 1:
 #if defined(__aarch64__)
-            uint32_t st[8];
-            sha256_initial_state(st);
-            sha256_arm_compress(st, h80, 1);
-            uint8_t b1[64];
-            sha256_pad_second_block_80(h80 + 64, b1);
-            sha256_arm_compress(st, b1, 1);
-            for (int i = 0; i < 8; i++) {
-                d32[i * 4 + 0] = (uint8_t)(st[i] >> 24);
-                d32[i * 4 + 1] = (uint8_t)(st[i] >> 16);
-                d32[i * 4 + 2] = (uint8_t)(st[i] >> 8);
-                d32[i * 4 + 3] = (uint8_t)st[i];
-            }
-            sha256(d32, SHA256_DIGEST_SIZE, out);
+            sha256_arm_double80(h80, out);
 #else
             memset(out, 0, 32);
 #endif
             break;
-        }
         case 2: {
 #if defined(__aarch64__)
             uint32_t mid[8];
@@ -331,14 +828,32 @@ void cpu_sha256_double_flavor(int flavor, const uint8_t *header76, uint32_t nonc
 #endif
             break;
         }
-        case 4: {
+        case 6: {
+#if defined(__x86_64__)
             uint32_t mid[8];
-            midstate_after_block0(header76, mid, scalar_compress_fn);
-            first_hash_mid(mid, header76, nonce, d32, scalar_compress_fn);
-            double_from_mid_digest(d32, out);
+            midstate_after_block0(header76, mid, sha256_x86_compress);
+            first_hash_mid(mid, header76, nonce, d32, sha256_x86_compress);
+            double_from_mid_digest_fn(d32, out, sha256_x86_compress);
+#else
+            memset(out, 0, 32);
+#endif
             break;
         }
+        case 0:
+        case 4:
+        case 7:
+        case 8:
+        case 9:
+        case 10:
+        case 11:
+        case 12:
+        case 13:
+        case 14:
+            lanes_double(lanes_kernel_for_flavor(flavor), header76, nonce, out);
+            break;
         case 5:
+            sha256_scalar_double80(header76, nonce, out);
+            break;
         default:
             sha256_double(h80, BLOCK_HEADER_SIZE, out);
             break;
@@ -354,8 +869,62 @@ static void sha256_bytes_to_hex(const uint8_t b[HASH_SIZE], char out[HASH_SIZE *
     out[HASH_SIZE * 2] = '\0';
 }
 
+int cpu_sha_flavor_supported(int flavor) {
+    switch (flavor) {
+        case 0:
+        case 1:
+        case 13:
+        case 14:
+#if defined(__aarch64__)
+            return (cpu_features() & CPU_FEATURE_ARM_SHA2) != 0;
+#else
+            return 0;
+#endif
+        case 2:
+        case 3:
+        case 12:
+#if defined(__aarch64__)
+            return 1;
+#else
+            return 0;
+#endif
+        case 4:
+        case 5:
+            return 1;
+        case 6:
+        case 7:
+#if defined(__x86_64__)
+            return (cpu_features() & CPU_FEATURE_X86_SHANI) != 0;
+#else
+            return 0;
+#endif
+        case 8:
+#if defined(__x86_64__)
+            return (cpu_features() & CPU_FEATURE_X86_AVX2) != 0;
+#else
+            return 0;
+#endif
+        case 9:
+#if defined(__x86_64__)
+            return (cpu_features() & CPU_FEATURE_X86_AVX512) != 0;
+#else
+            return 0;
+#endif
+        case 10:
+        case 11:
+#if defined(__x86_64__)
+            return (cpu_features() & (CPU_FEATURE_X86_SSSE3 | CPU_FEATURE_X86_SSE41)) ==
+                (CPU_FEATURE_X86_SSSE3 | CPU_FEATURE_X86_SSE41);
+#else
+            return 0;
+#endif
+        default:
+            return 0;
+    }
+}
+
 /** Must match [com.btcminer.android.config.CpuSha256Flavor] ordinal order. */
-static const char *cpu_sha_flavor_label(int flavor) {
+const char *cpu_sha_flavor_label(int flavor) {
     static const char *const names[] = {
         "HW_SHA2_MIDSTATE",
         "HW_SHA2",
@@ -363,12 +932,367 @@ static const char *cpu_sha_flavor_label(int flavor) {
         "NEON4",
         "SCALAR_MIDSTATE",
         "SCALAR",
+        "SHA_NI_MIDSTATE",
+        "SHA_NI_2WAY",
+        "AVX2_8WAY",
+        "AVX512_16WAY",
+        "SSE4_4WAY_MIDSTATE",
+        "SSE4_4WAY",
+        "NEON8_MIDSTATE",
+        "HW_SHA2_2WAY",
+        "HW_SHA2_3WAY",
     };
-    if (flavor < 0 || flavor > 5)
+    if (flavor < 0 || flavor >= CPU_SHA_FLAVOR_COUNT)
         return "?";
     return names[flavor];
 }
 
+const char *cpu_stage_label(int stage) {
+    static const char *const names[CPU_STAGE_COUNT] = {
+        "midstate",
+        "first_hash",
+        "second_hash",
+        "digest_serialise",
+        "target_check",
+        "double_hash",
+    };
+    if (stage < 0 || stage >= CPU_STAGE_COUNT)
+        return "?";
+    return names[stage];
+}
+
+/* Forces the stage's output to memory each iteration, as the scan loops do, so nothing is elided. */
+#define STAGE_CLOBBER(p) __asm__ __volatile__("" : : "r"(p) : "memory")
+
+/*
+ * How a one-lane flavor runs each stage; [first_full] is NULL for midstate flavors. [fused] (midstate)
+ * / [fused_full], when set, are what the scan loop calls for the whole double hash.
+ */
+typedef struct {
+    void (*compress)(uint32_t *, const uint8_t *, size_t);
+    void (*first_full)(const uint8_t h80[BLOCK_HEADER_SIZE], uint8_t d32[32]);
+    void (*second)(const uint8_t d32[32], uint8_t out[32]);
+    const lanes_kernel *fused;
+    void (*fused_full)(const uint8_t h80[BLOCK_HEADER_SIZE], uint8_t out[32]);
+} one_lane_pipeline;
+
+static void scalar_first_hash_full(const uint8_t h80[BLOCK_HEADER_SIZE], uint8_t d32[32]) {
+    uint32_t st[8];
+    sha256_initial_state(st);
+    sha256_scalar_compress(st, h80);
+    uint8_t b1[64];
+    sha256_pad_second_block_80(h80 + 64, b1);
+    sha256_scalar_compress(st, b1);
+    digest_from_state(st, d32);
+}
+
+static void scalar_double80_fn(const uint8_t h80[BLOCK_HEADER_SIZE], uint8_t out[32]) {
+    const uint32_t nonce = (uint32_t)h80[76] | ((uint32_t)h80[77] << 8) | ((uint32_t)h80[78] << 16) |
+                           ((uint32_t)h80[79] << 24);
+    sha256_scalar_double80(h80, nonce, out);
+}
+
+#if defined(__x86_64__)
+static void shani_second_hash(const uint8_t d32[32], uint8_t out[32]) {
+    double_from_mid_digest_fn(d32, out, sha256_x86_compress);
+}
+#endif
+
+/*
+ * One-lane flavors (HW_SHA2*, SCALAR*, SHA_NI_MIDSTATE): each stage is the same call the scan loop
+ * makes. Inputs are perturbed with the iteration index so no work is loop-invariant.
+ */
+static int stage_bench_one_lane(int stage, const one_lane_pipeline *p, const uint8_t *header76, const uint8_t *target,
+                                uint32_t iters, uint32_t *sink) {
+    uint8_t hdr[HEADER_PREFIX_SIZE];
+    memcpy(hdr, header76, sizeof(hdr));
+    uint32_t mid[8];
+    midstate_after_block0(hdr, mid, p->compress);
+    uint8_t h80[BLOCK_HEADER_SIZE];
+    header80_from_76_nonce(hdr, 0, h80);
+    uint8_t d32[32];
+    uint8_t hash[HASH_SIZE];
+    first_hash_mid(mid, hdr, 0, d32, p->compress);
+    p->second(d32, hash);
+    uint256 tw;
+    uint32_t acc = 0;
+    switch (stage) {
+        case CPU_STAGE_MIDSTATE:
+            if (p->first_full)
+                return CPU_SHA_FLAVOR_ERROR;
+            for (uint32_t i = 0; i < iters; i++) {
+                hdr[0] = (uint8_t)i;
+                midstate_after_block0(hdr, mid, p->compress);
+                STAGE_CLOBBER(mid);
+                acc += mid[0];
+            }
+            break;
+        case CPU_STAGE_DOUBLE_HASH:
+            if (p->fused && !p->first_full) {
+                _Alignas(64) unsigned char job[LANES_JOB_BYTES];
+                p->fused->job_init(job, mid, hdr);
+                uint8_t dig[1][32];
+                for (uint32_t i = 0; i < iters; i++) {
+                    p->fused->kernel(job, i, dig);
+                    STAGE_CLOBBER(dig);
+                    acc += dig[0][0];
+                }
+                break;
+            }
+            if (p->fused_full && p->first_full) {
+                for (uint32_t i = 0; i < iters; i++) {
+                    h80[76] = (uint8_t)i;
+                    h80[77] = (uint8_t)(i >> 8);
+                    h80[78] = (uint8_t)(i >> 16);
+                    h80[79] = (uint8_t)(i >> 24);
+                    p->fused_full(h80, hash);
+                    STAGE_CLOBBER(hash);
+                    acc += hash[0];
+                }
+                break;
+            }
+            /* fall through */
+        case CPU_STAGE_FIRST_HASH:
+            for (uint32_t i = 0; i < iters; i++) {
+                if (!p->first_full) {
+                    first_hash_mid(mid, hdr, i, d32, p->compress);
+                } else {
+                    h80[76] = (uint8_t)i;
+                    h80[77] = (uint8_t)(i >> 8);
+                    h80[78] = (uint8_t)(i >> 16);
+                    h80[79] = (uint8_t)(i >> 24);
+                    p->first_full(h80, d32);
+                }
+                if (stage == CPU_STAGE_DOUBLE_HASH) {
+                    p->second(d32, hash);
+                    STAGE_CLOBBER(hash);
+                    acc += hash[0];
+                } else {
+                    STAGE_CLOBBER(d32);
+                    acc += d32[0];
+                }
+            }
+            break;
+        case CPU_STAGE_SECOND_HASH:
+            for (uint32_t i = 0; i < iters; i++) {
+                d32[0] = (uint8_t)i;
+                p->second(d32, hash);
+                STAGE_CLOBBER(hash);
+                acc += hash[0];
+            }
+            break;
+        case CPU_STAGE_SERIALISE:
+            for (uint32_t i = 0; i < iters; i++) {
+                mid[0] += i;
+                digest_from_state(mid, d32);
+                STAGE_CLOBBER(d32);
+                acc += d32[3];
+            }
+            break;
+        case CPU_STAGE_TARGET_CHECK:
+            uint256_from_be(&tw, target);
+            for (uint32_t i = 0; i < iters; i++) {
+                hash[0] = (uint8_t)i;
+                STAGE_CLOBBER(hash);
+                acc += (uint32_t)hash_meets_target(hash, &tw);
+            }
+            break;
+        default:
+            return CPU_SHA_FLAVOR_ERROR;
+    }
+    *sink += acc;
+    return 1;
+}
+
+/* Multi-lane kernels: both hashes and the digest store are fused, so only the whole kernel is timed. */
+static int stage_bench_lanes(int stage, const lanes_kernel *k, const uint8_t *header76, const uint8_t *target,
+                             uint32_t iters, uint32_t *sink) {
+    if (!k)
+        return CPU_SHA_FLAVOR_ERROR;
+    uint8_t hdr[HEADER_PREFIX_SIZE];
+    memcpy(hdr, header76, sizeof(hdr));
+    uint32_t mid[8];
+    midstate_after_block0(hdr, mid, k->compress);
+    _Alignas(64) unsigned char job[LANES_JOB_BYTES];
+    k->job_init(job, mid, hdr);
+    uint8_t dig[LANES_MAX][32];
+    k->kernel(job, 0, dig);
+    uint256 tw;
+    uint32_t acc = 0;
+    switch (stage) {
+        case CPU_STAGE_MIDSTATE:
+            if (k->full)
+                return CPU_SHA_FLAVOR_ERROR;
+            for (uint32_t i = 0; i < iters; i++) {
+                hdr[0] = (uint8_t)i;
+                midstate_after_block0(hdr, mid, k->compress);
+                STAGE_CLOBBER(mid);
+                acc += mid[0];
+            }
+            break;
+        case CPU_STAGE_DOUBLE_HASH:
+            for (uint32_t i = 0; i < iters; i++) {
+                k->kernel(job, i * (uint32_t)k->lanes, dig);
+                STAGE_CLOBBER(dig);
+                acc += dig[0][0];
+            }
+            break;
+        case CPU_STAGE_TARGET_CHECK:
+            uint256_from_be(&tw, target);
+            for (uint32_t i = 0; i < iters; i++) {
+                dig[0][0] = (uint8_t)i;
+                STAGE_CLOBBER(dig);
+                for (int l = 0; l < k->lanes; l++)
+                    acc += (uint32_t)hash_meets_target(dig[l], &tw);
+            }
+            break;
+        default:
+            return CPU_SHA_FLAVOR_ERROR;
+    }
+    *sink += acc;
+    return k->lanes;
+}
+
+/* NEON 4-way flavors: one op covers four nonces; the midstate itself is scalar, as in scan_neon4_mid. */
+static int stage_bench_neon4(int stage, int full, const uint8_t *header76, const uint8_t *target, uint32_t iters,
+                             uint32_t *sink) {
+#if defined(__aarch64__)
+    uint8_t hdr[HEADER_PREFIX_SIZE];
+    memcpy(hdr, header76, sizeof(hdr));
+    uint32_t mid[8];
+    midstate_after_block0(hdr, mid, scalar_compress_fn);
+    uint8_t quad[4][32];
+    uint8_t hashes[4][32];
+    sha256_neon4_job job;
+    sha256_neon4_job_init(&job, mid, hdr);
+    sha256_neon4_first(mid, hdr, 0, 1, 2, 3, quad);
+    sha256_neon4_second(quad, hashes);
+    uint32_t words[8][4];
+    for (int w = 0; w < 8; w++)
+        for (int l = 0; l < 4; l++)
+            words[w][l] = mid[w] + (uint32_t)l;
+    uint256 tw;
+    uint32_t acc = 0;
+    switch (stage) {
+        case CPU_STAGE_MIDSTATE:
+            if (full)
+                return CPU_SHA_FLAVOR_ERROR;
+            for (uint32_t i = 0; i < iters; i++) {
+                hdr[0] = (uint8_t)i;
+                midstate_after_block0(hdr, mid, scalar_compress_fn);
+                STAGE_CLOBBER(mid);
+                acc += mid[0];
+            }
+            break;
+        case CPU_STAGE_FIRST_HASH:
+            for (uint32_t i = 0; i < iters; i++) {
+                const uint32_t n = i * 4u;
+                sha256_neon4_first(full ? NULL : mid, hdr, n, n + 1u, n + 2u, n + 3u, quad);
+                STAGE_CLOBBER(quad);
+                acc += quad[0][0];
+            }
+            break;
+        case CPU_STAGE_DOUBLE_HASH:
+            for (uint32_t i = 0; i < iters; i++) {
+                const uint32_t n = i * 4u;
+                if (full)
+                    sha256_neon4_double(hdr, n, n + 1u, n + 2u, n + 3u, hashes);
+                else
+                    sha256_neon4_double_job(&job, n, hashes);
+                STAGE_CLOBBER(hashes);
+                acc += hashes[0][0];
+            }
+            break;
+        case CPU_STAGE_SECOND_HASH:
+            for (uint32_t i = 0; i < iters; i++) {
+                quad[0][0] = (uint8_t)i;
+                sha256_neon4_second((const uint8_t(*)[32])quad, hashes);
+                STAGE_CLOBBER(hashes);
+                acc += hashes[0][0];
+            }
+            break;
+        case CPU_STAGE_SERIALISE:
+            for (uint32_t i = 0; i < iters; i++) {
+                words[0][0] += i;
+                sha256_neon4_store_digests((const uint32_t(*)[4])words, quad);
+                STAGE_CLOBBER(quad);
+                acc += quad[0][3];
+            }
+            break;
+        case CPU_STAGE_TARGET_CHECK:
+            uint256_from_be(&tw, target);
+            for (uint32_t i = 0; i < iters; i++) {
+                hashes[0][0] = (uint8_t)i;
+                STAGE_CLOBBER(hashes);
+                for (int l = 0; l < 4; l++)
+                    acc += (uint32_t)hash_meets_target(hashes[l], &tw);
+            }
+            break;
+        default:
+            return CPU_SHA_FLAVOR_ERROR;
+    }
+    *sink += acc;
+    return 4;
+#else
+    (void)stage;
+    (void)full;
+    (void)header76;
+    (void)target;
+    (void)iters;
+    (void)sink;
+    return CPU_SHA_FLAVOR_ERROR;
+#endif
+}
+
+int cpu_sha_stage_bench(int flavor, int stage, const uint8_t *header76, const uint8_t *target, uint32_t iters,
+                        uint32_t *sink) {
+    static const one_lane_pipeline scalar_mid = {scalar_compress_fn, NULL, sha256_scalar_hash32, &kScalarLanes,
+                                                 NULL};
+    static const one_lane_pipeline scalar_full = {scalar_compress_fn, scalar_first_hash_full, sha256_scalar_hash32,
+                                                  NULL, scalar_double80_fn};
+#if defined(__aarch64__)
+    static const one_lane_pipeline arm_mid = {arm_compress_fn, NULL, sha256_arm_hash32, &kArm1Lanes, NULL};
+    static const one_lane_pipeline arm_full = {arm_compress_fn, arm_first_hash_full, sha256_arm_hash32, NULL,
+                                               sha256_arm_double80};
+#endif
+#if defined(__x86_64__)
+    static const one_lane_pipeline shani_mid = {sha256_x86_compress, NULL, shani_second_hash, NULL, NULL};
+#endif
+    if (!cpu_sha_flavor_supported(flavor))
+        return CPU_SHA_FLAVOR_ERROR;
+    switch (flavor) {
+#if defined(__aarch64__)
+        case 0:
+            return stage_bench_one_lane(stage, &arm_mid, header76, target, iters, sink);
+        case 1:
+            return stage_bench_one_lane(stage, &arm_full, header76, target, iters, sink);
+#endif
+        case 2:
+            return stage_bench_neon4(stage, 0, header76, target, iters, sink);
+        case 3:
+            return stage_bench_neon4(stage, 1, header76, target, iters, sink);
+        case 4:
+            return stage_bench_one_lane(stage, &scalar_mid, header76, target, iters, sink);
+        case 5:
+            return stage_bench_one_lane(stage, &scalar_full, header76, target, iters, sink);
+#if defined(__x86_64__)
+        case 6:
+            return stage_bench_one_lane(stage, &shani_mid, header76, target, iters, sink);
+#endif
+        case 7:
+        case 8:
+        case 9:
+        case 10:
+        case 11:
+        case 12:
+        case 13:
+        case 14:
+            return stage_bench_lanes(stage, lanes_kernel_for_flavor(flavor), header76, target, iters, sink);
+        default:
+            return CPU_SHA_FLAVOR_ERROR;
+    }
+}
+
 /* Fixed test header (76 bytes); tweak bytes for regression vectors. */
 static const uint8_t kSelftestHeader76[HEADER_PREFIX_SIZE] = {
     1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32,
@@ -376,8 +1300,55 @@ static const uint8_t kSelftestHeader76[HEADER_PREFIX_SIZE] = {
     65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76,
 };
 
+/*
+ * The lane-mask reject must never drop a hit: each lane's bit has to be set for a top word equal to the
+ * finalised digest's top word and clear one below it, and a scan whose target is exactly one nonce's
+ * hash (the equality boundary) has to find the same first hit as the reference.
+ */
+static int lanes_probe_selftest(int flavor, const lanes_kernel *k) {
+    uint32_t mid[8];
+    midstate_after_block0(kSelftestHeader76, mid, k->compress);
+    _Alignas(64) unsigned char job[LANES_JOB_BYTES];
+    k->job_init(job, mid, kSelftestHeader76);
+    uint8_t dig[LANES_MAX][32];
+    for (uint32_t n = 0; n < 64u; n += (uint32_t)k->lanes) {
+        k->kernel(job, n, dig);
+        for (int l = 0; l < k->lanes; l++) {
+            const uint8_t *w7 = &dig[l][28];
+            const uint32_t top = ((uint32_t)w7[3] << 24) | ((uint32_t)w7[2] << 16) | ((uint32_t)w7[1] << 8) | w7[0];
+            if (!((k->probe(job, n, top) >> l) & 1u))
+                return 0;
+            if (top != 0u && ((k->probe(job, n, top - 1u) >> l) & 1u))
+                return 0;
+        }
+    }
+    const uint32_t hit = 37u;
+    uint8_t h80[BLOCK_HEADER_SIZE];
+    uint8_t ref[HASH_SIZE];
+    uint8_t target[HASH_SIZE];
+    header80_from_76_nonce(kSelftestHeader76, hit, h80);
+    sha256_double(h80, BLOCK_HEADER_SIZE, ref);
+    for (int i = 0; i < HASH_SIZE; i++)
+        target[i] = ref[HASH_SIZE - 1 - i];
+    uint256 tw;
+    uint256_from_be(&tw, target);
+    int expect = -1;
+    for (uint32_t n = 0; n <= hit && expect < 0; n++) {
+        header80_from_76_nonce(kSelftestHeader76, n, h80);
+        sha256_double(h80, BLOCK_HEADER_SIZE, ref);
+        if (hash_meets_target(ref, &tw))
+            expect = (int)n;
+    }
+    uint32_t first = 0;
+    cpu_scan_hits hits = {.nonces = &first, .cap = 1};
+    miner_job mj;
+    miner_job_init(&mj, kSelftestHeader76, target, flavor);
+    scan_lanes(k, &mj, 0, hit + 40u, &hits);
+    return hits.count == 1 && (int)first == expect;
+}
+
 int cpu_sha_selftest_flavor(int flavor) {
-    if (flavor < 0 || flavor > 5) return 0;
+    if (flavor < 0 || flavor >= CPU_SHA_FLAVOR_COUNT) return 0;
     uint8_t ref[32];
     uint8_t got[32];
     for (uint32_t nonce = 1; nonce <= 4; nonce++) {
@@ -413,6 +1384,12 @@ int cpu_sha_selftest_flavor(int flavor) {
             return 0;
         }
     }
+    const lanes_kernel *k = lanes_kernel_for_flavor(flavor);
+    if (k && k->probe && !lanes_probe_selftest(flavor, k)) {
+        __android_log_print(ANDROID_LOG_INFO, "SHA256_SelfTest",
+            "flavor=%d (%s) lane_mask_reject_ok=0", flavor, cpu_sha_flavor_label(flavor));
+        return 0;
+    }
     __android_log_print(ANDROID_LOG_INFO, "SHA256_SelfTest",
         "flavor=%d (%s) all_nonces_ok=1", flavor, cpu_sha_flavor_label(flavor));
     return 1;
@@ -1,9 +1,114 @@
 #ifndef SHA256_SCAN_H
 #define SHA256_SCAN_H
 
+#include "miner_job.h"
+
+#include <stdatomic.h>
 #include <stdint.h>
 
+/** Number of CPU SHA kernels; must match the [com.btcminer.android.config.CpuSha256Flavor] entries before AUTO. */
+#define CPU_SHA_FLAVOR_COUNT 15
+/* CpuSha256Flavor.AUTO: resolved by the app from cpu_sha_calibrate (sha256_calibrate.h); never scanned. */
+#define CPU_SHA_FLAVOR_AUTO 15
+
+/* scan_nonces_dispatch return codes (winning nonce is returned as a non-negative int). */
+#define CPU_SCAN_MISS (-1)
+#define CPU_SCAN_INTERRUPTED (-3)
+#define CPU_SHA_FLAVOR_ERROR (-4)
+
+/* Nonces between cancellation polls in every scan loop (~tens of microseconds on a phone core). */
+#define CPU_SCAN_POLL_NONCES 64u
+
+/**
+ * CPU job epoch. cpu_scan_cancel_all (cpuRequestInterrupt) bumps it; a scan whose token holds an older
+ * epoch ends with CPU_SCAN_INTERRUPTED at its next poll. Scans only ever load it, so polling from every
+ * core keeps its cache line shared.
+ */
+uint32_t cpu_scan_epoch(void);
+void cpu_scan_cancel_all(void);
+
+/** What a cancellable scan polls: the epoch its job was taken under, plus an optional per-worker flag. */
+typedef struct {
+    uint32_t epoch;
+    /* Nonzero stops just this worker's scan; NULL when the caller has no flag of its own. */
+    const atomic_int *stop;
+} cpu_scan_cancel;
+
+/* Single-hit scan, cancellable by cpu_scan_cancel_all during the call. */
 int scan_nonces_dispatch(int flavor, const uint8_t *header76, uint32_t start, uint32_t end, const uint8_t *target);
+
+/**
+ * Caller-owned hit buffer for scan_nonces_multi; everything after [cancel] is output. [cancel] may be
+ * NULL (self-tests, benchmarks) for a scan nothing can stop. [best_hash] is the lowest SHA256d digest
+ * among the [scanned] nonces (digest byte order, as uint256_from_hash reads it), from [best_nonce];
+ * [best_top] is its most significant word. Meaningless while [scanned] is 0.
+ */
+typedef struct {
+    uint32_t *nonces;
+    uint32_t cap;
+    const cpu_scan_cancel *cancel;
+    uint32_t count;
+    uint64_t scanned;
+    uint32_t best_nonce;
+    uint32_t best_top;
+    uint8_t best_hash[32];
+} cpu_scan_hits;
+
+/**
+ * Like scan_nonces_dispatch, but the scan continues past a hit: every nonce in [start, end] whose hash
+ * meets [target] is written to hits->nonces in ascending order. Stops early only when the buffer is
+ * full (right after the hit that filled it) or when [cancel] fires. hits->scanned is the number of nonces
+ * hashed from [start] in every case, so start + scanned is where a caller resumes; the best hash covers
+ * the same nonces. Returns the hit count, or CPU_SCAN_INTERRUPTED (hits found before it stay valid) /
+ * CPU_SHA_FLAVOR_ERROR.
+ */
+int scan_nonces_multi(int flavor, const uint8_t *header76, uint32_t start, uint32_t end, const uint8_t *target,
+                      cpu_scan_hits *hits);
+
+/**
+ * scan_nonces_multi over a prepared job (miner_job.h) with job->flavor: no per-call midstate, kernel
+ * setup or target conversion. The pool's workers scan every chunk of a round this way.
+ */
+int scan_nonces_job(const miner_job *job, uint32_t start, uint32_t end, cpu_scan_hits *hits);
+
+/** Fills job->lanes for job->flavor when that is a lane kernel this CPU runs (miner_job_init calls it). */
+void cpu_sha_prepare_job(miner_job *job);
 int cpu_sha_selftest_flavor(int flavor);
 
+/** Double SHA-256 of header76 || nonce through [flavor]'s kernel (self-test / diagnostics). */
+void cpu_sha256_double_flavor(int flavor, const uint8_t *header76, uint32_t nonce, uint8_t out[32]);
+
+/** 1 when [flavor] is compiled into this build and the running CPU has the required features. */
+int cpu_sha_flavor_supported(int flavor);
+
+/** Flavor name as in CpuSha256Flavor, or "?" when out of range. */
+const char *cpu_sha_flavor_label(int flavor);
+
+/**
+ * Which build of [flavor]'s kernel this CPU runs: "base", or the newer ISA level picked at first use
+ * ("sha3" for the NEON kernels on ARMv8.2 SHA3, "avx512vl" for SSE4 / AVX2 on AVX-512VL).
+ */
+const char *cpu_sha_flavor_isa(int flavor);
+
+/* Double-SHA pipeline stages timed by cpu_sha_stage_bench (bench/minerstages.c). */
+#define CPU_STAGE_MIDSTATE 0
+#define CPU_STAGE_FIRST_HASH 1
+#define CPU_STAGE_SECOND_HASH 2
+#define CPU_STAGE_SERIALISE 3
+#define CPU_STAGE_TARGET_CHECK 4
+/* First + second hash as one call; the only stage for fused kernels that never expose the first digest. */
+#define CPU_STAGE_DOUBLE_HASH 5
+#define CPU_STAGE_COUNT 6
+
+/**
+ * Runs [stage] of [flavor]'s pipeline [iters] times back to back (setup excluded from the loop), folding
+ * results into [sink]. Returns nonces per op (lane count), or CPU_SHA_FLAVOR_ERROR when the flavor is not
+ * supported or has no such stage (full-header flavors have no midstate; fused kernels only double_hash).
+ */
+int cpu_sha_stage_bench(int flavor, int stage, const uint8_t *header76, const uint8_t *target, uint32_t iters,
+                        uint32_t *sink);
+
+/** Stage name used in minerstages output, or "?" when out of range. */
+const char *cpu_stage_label(int stage);
+
 #endif
@@ -0,0 +1,70 @@
+/*
+ * Four-lane SHA-256 (SSSE3/SSE4.1) for parallel nonce hashing: the x86 counterpart of
+ * sha256_neon_4way.c, with the lane layout of Bitcoin Core src/crypto/sha256_sse4.cpp (MIT).
+ * Rounds come from sha256_lanes_tmpl.h. Built with -mssse3 -msse4.1; only called after
+ * cpu_features() reports both.
+ *
+ * CMake also builds it with SHA256_X86_AVX512VL (-mavx512f -mavx512vl) as sha256_sse4_4way_vl_*:
+ * same lanes, but VEX/EVEX three-operand forms, vprord rotates and vpternlogd for Ch, Maj and the
+ * sigma XORs. sha256_scan.c switches to that copy on CPU_FEATURE_X86_AVX512VL.
+ */
+
+#include "sha256_sse4_4way.h"
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+#if defined(SHA256_X86_AVX512VL)
+#define SSE4_API(name) sha256_sse4_4way_vl_##name
+#else
+#define SSE4_API(name) sha256_sse4_4way_##name
+#endif
+
+#define LANES_PREFIX sse4
+#define LANES_JOB sha256_sse4_4way_job
+#define LANES_N 4
+#define LANES_VEC __m128i
+#define V_SET1(x) _mm_set1_epi32((int)(x))
+#define V_LOADU(p) _mm_loadu_si128((const __m128i *)(p))
+#define V_STORE(p, v) _mm_store_si128((__m128i *)(p), (v))
+#define V_ADD(a, b) _mm_add_epi32((a), (b))
+#define V_XOR(a, b) _mm_xor_si128((a), (b))
+#define V_AND(a, b) _mm_and_si128((a), (b))
+#define V_OR(a, b) _mm_or_si128((a), (b))
+#define V_SHR(x, n) _mm_srli_epi32((x), (n))
+#define V_BSWAP(x) _mm_shuffle_epi8((x), _mm_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL))
+#if defined(SHA256_X86_AVX512VL)
+/* vpternlogd immediates as in sha256_avx512_16way.c. */
+#define V_ROTR(x, n) _mm_ror_epi32((x), (n))
+#define V_XOR3(a, b, c) _mm_ternarylogic_epi32((a), (b), (c), 0x96)
+#define V_CH(e, f, g) _mm_ternarylogic_epi32((e), (f), (g), 0xCA)
+#define V_MAJ(a, b, c) _mm_ternarylogic_epi32((a), (b), (c), 0xE8)
+#define V_LE_MASK(x, t) ((uint32_t)_mm_cmple_epu32_mask((x), (t)))
+#else
+#define V_ROTR(x, n) _mm_or_si128(_mm_srli_epi32((x), (n)), _mm_slli_epi32((x), 32 - (n)))
+/* Unsigned x <= t as min(x, t) == x (SSE4.1 pminud), one sign bit per lane. */
+#define V_LE_MASK(x, t) \
+    ((uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_min_epu32((x), (t)), (x)))))
+#endif
+#include "sha256_lanes_tmpl.h"
+
+void SSE4_API(double)(const uint8_t header76[76], uint32_t n0, uint32_t n1, uint32_t n2, uint32_t n3,
+                      uint8_t digests[4][32]) {
+    const uint32_t nonces[4] = {n0, n1, n2, n3};
+    sse4_double_full(header76, nonces, digests);
+}
+
+void SSE4_API(job_init)(sha256_sse4_4way_job *job, const uint32_t midstate[8], const uint8_t header76[76]) {
+    sse4_job_init(job, midstate, header76);
+}
+
+void SSE4_API(double_job)(const sha256_sse4_4way_job *job, uint32_t base, uint8_t digests[4][32]) {
+    sse4_job_double(job, base, digests);
+}
+
+uint32_t SSE4_API(mask_job)(const sha256_sse4_4way_job *job, uint32_t base, uint32_t target_top) {
+    return sse4_job_mask(job, base, target_top);
+}
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef SHA256_SSE4_4WAY_H
+#define SHA256_SSE4_4WAY_H
+
+#include <stdint.h>
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+/** Per-job constants splatted to all four lanes; same layout as sha256_neon4_job. */
+typedef struct {
+    __m128i mid[8];
+    __m128i tail[3];
+    __m128i pre_state[8];
+    __m128i pre_w[4];
+} sha256_sse4_4way_job;
+
+/**
+ * Double SHA-256 for four 80-byte Bitcoin headers that share the first 76 bytes (SSSE3/SSE4.1);
+ * nonces are little-endian at offsets 76–79. Writes 32-byte digests per lane. Same API as
+ * sha256_neon4_double; caller checks CPU_FEATURE_X86_SSE41 | CPU_FEATURE_X86_SSSE3.
+ */
+void sha256_sse4_4way_double(const uint8_t header76[76], uint32_t n0, uint32_t n1, uint32_t n2, uint32_t n3,
+                             uint8_t digests[4][32]);
+
+/** Splats [midstate] (state after the first 64 bytes of header76) and the header tail; per-job precompute. */
+void sha256_sse4_4way_job_init(sha256_sse4_4way_job *job, const uint32_t midstate[8], const uint8_t header76[76]);
+
+/** Double SHA-256 of nonces base .. base + 3 for [job] (see sha256_neon4_double_job). */
+void sha256_sse4_4way_double_job(const sha256_sse4_4way_job *job, uint32_t base, uint8_t digests[4][32]);
+
+/**
+ * Bit l set when nonce base + l can still meet a target whose top word (bytes 0–3, big-endian) is
+ * [target_top]; the outer hash stops after round 60 and the compare runs on the H7 lanes.
+ */
+uint32_t sha256_sse4_4way_mask_job(const sha256_sse4_4way_job *job, uint32_t base, uint32_t target_top);
+
+/* AVX-512VL builds of the four functions above (same job layout); only when CPU_FEATURE_X86_AVX512VL is set. */
+void sha256_sse4_4way_vl_double(const uint8_t header76[76], uint32_t n0, uint32_t n1, uint32_t n2, uint32_t n3,
+                                uint8_t digests[4][32]);
+void sha256_sse4_4way_vl_job_init(sha256_sse4_4way_job *job, const uint32_t midstate[8],
+                                  const uint8_t header76[76]);
+void sha256_sse4_4way_vl_double_job(const sha256_sse4_4way_job *job, uint32_t base, uint8_t digests[4][32]);
+uint32_t sha256_sse4_4way_vl_mask_job(const sha256_sse4_4way_job *job, uint32_t base, uint32_t target_top);
+
+#else
+
+typedef struct {
+    uint32_t unused;
+} sha256_sse4_4way_job;
+
+static inline void sha256_sse4_4way_double(const uint8_t header76[76], uint32_t n0, uint32_t n1, uint32_t n2,
+                                           uint32_t n3, uint8_t digests[4][32]) {
+    (void)header76;
+    (void)n0;
+    (void)n1;
+    (void)n2;
+    (void)n3;
+    (void)digests;
+}
+
+static inline void sha256_sse4_4way_job_init(sha256_sse4_4way_job *job, const uint32_t midstate[8],
+                                             const uint8_t header76[76]) {
+    (void)job;
+    (void)midstate;
+    (void)header76;
+}
+
+static inline void sha256_sse4_4way_double_job(const sha256_sse4_4way_job *job, uint32_t base,
+                                               uint8_t digests[4][32]) {
+    (void)job;
+    (void)base;
+    (void)digests;
+}
+
+static inline uint32_t sha256_sse4_4way_mask_job(const sha256_sse4_4way_job *job, uint32_t base,
+                                                 uint32_t target_top) {
+    (void)job;
+    (void)base;
+    (void)target_top;
+    return 0;
+}
+
+#endif
+
+#endif
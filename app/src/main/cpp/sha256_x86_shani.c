@@ -0,0 +1,199 @@
+/*
+ * SHA-256 compression using the x86 SHA extensions (SHA-NI).
+ * Round and message-schedule layout follows Intel's SHA extensions reference and the public-domain
+ * SHA-Intrinsics (Jeffrey Walton), as used by Bitcoin Core src/crypto/sha256_x86_shani.cpp (MIT).
+ * Built with -msse4.1 -msha; only called after cpu_features() reports CPU_FEATURE_X86_SHANI.
+ */
+
+#include "sha256_x86_shani.h"
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+static const uint32_t K256[64] __attribute__((aligned(16))) = {
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+/* Byte swap within each 32-bit word (message load / digest store). */
+#define BSWAP32_MASK _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL)
+
+/*
+ * Rounds 4i..4i+3 on (s0 = ABEF, s1 = CDGH). [m0] holds W[4i..4i+3]; [m1]/[m3] are the next/previous
+ * message quads, updated in place for the schedule (msg2 for quads 3..14, msg1 for quads 1..12).
+ */
+#define SHANI_QROUND(i, s0, s1, m0, m1, m2, m3)                                    \
+    do {                                                                           \
+        __m128i msg_ = _mm_add_epi32((m0), _mm_load_si128((const __m128i *)&K256[4 * (i)])); \
+        (s1) = _mm_sha256rnds2_epu32((s1), (s0), msg_);                            \
+        if ((i) >= 3 && (i) <= 14) {                                               \
+            (m1) = _mm_add_epi32((m1), _mm_alignr_epi8((m0), (m3), 4));            \
+            (m1) = _mm_sha256msg2_epu32((m1), (m0));                               \
+        }                                                                          \
+        msg_ = _mm_shuffle_epi32(msg_, 0x0E);                                      \
+        (s0) = _mm_sha256rnds2_epu32((s0), (s1), msg_);                            \
+        if ((i) >= 1 && (i) <= 12)                                                 \
+            (m3) = _mm_sha256msg1_epu32((m3), (m0));                               \
+    } while (0)
+
+#define SHANI_ROUNDS(s0, s1, m0, m1, m2, m3)           \
+    do {                                               \
+        SHANI_QROUND(0, s0, s1, m0, m1, m2, m3);       \
+        SHANI_QROUND(1, s0, s1, m1, m2, m3, m0);       \
+        SHANI_QROUND(2, s0, s1, m2, m3, m0, m1);       \
+        SHANI_QROUND(3, s0, s1, m3, m0, m1, m2);       \
+        SHANI_QROUND(4, s0, s1, m0, m1, m2, m3);       \
+        SHANI_QROUND(5, s0, s1, m1, m2, m3, m0);       \
+        SHANI_QROUND(6, s0, s1, m2, m3, m0, m1);       \
+        SHANI_QROUND(7, s0, s1, m3, m0, m1, m2);       \
+        SHANI_QROUND(8, s0, s1, m0, m1, m2, m3);       \
+        SHANI_QROUND(9, s0, s1, m1, m2, m3, m0);       \
+        SHANI_QROUND(10, s0, s1, m2, m3, m0, m1);      \
+        SHANI_QROUND(11, s0, s1, m3, m0, m1, m2);      \
+        SHANI_QROUND(12, s0, s1, m0, m1, m2, m3);      \
+        SHANI_QROUND(13, s0, s1, m1, m2, m3, m0);      \
+        SHANI_QROUND(14, s0, s1, m2, m3, m0, m1);      \
+        SHANI_QROUND(15, s0, s1, m3, m0, m1, m2);      \
+    } while (0)
+
+/* Same rounds for two independent streams, quad by quad, so both chains are in flight together. */
+#define SHANI_ROUNDS_2WAY(s0a, s1a, m0a, m1a, m2a, m3a, s0b, s1b, m0b, m1b, m2b, m3b) \
+    do {                                                                            \
+        SHANI_QROUND(0, s0a, s1a, m0a, m1a, m2a, m3a);                              \
+        SHANI_QROUND(0, s0b, s1b, m0b, m1b, m2b, m3b);                              \
+        SHANI_QROUND(1, s0a, s1a, m1a, m2a, m3a, m0a);                              \
+        SHANI_QROUND(1, s0b, s1b, m1b, m2b, m3b, m0b);                              \
+        SHANI_QROUND(2, s0a, s1a, m2a, m3a, m0a, m1a);                              \
+        SHANI_QROUND(2, s0b, s1b, m2b, m3b, m0b, m1b);                              \
+        SHANI_QROUND(3, s0a, s1a, m3a, m0a, m1a, m2a);                              \
+        SHANI_QROUND(3, s0b, s1b, m3b, m0b, m1b, m2b);                              \
+        SHANI_QROUND(4, s0a, s1a, m0a, m1a, m2a, m3a);                              \
+        SHANI_QROUND(4, s0b, s1b, m0b, m1b, m2b, m3b);                              \
+        SHANI_QROUND(5, s0a, s1a, m1a, m2a, m3a, m0a);                              \
+        SHANI_QROUND(5, s0b, s1b, m1b, m2b, m3b, m0b);                              \
+        SHANI_QROUND(6, s0a, s1a, m2a, m3a, m0a, m1a);                              \
+        SHANI_QROUND(6, s0b, s1b, m2b, m3b, m0b, m1b);                              \
+        SHANI_QROUND(7, s0a, s1a, m3a, m0a, m1a, m2a);                              \
+        SHANI_QROUND(7, s0b, s1b, m3b, m0b, m1b, m2b);                              \
+        SHANI_QROUND(8, s0a, s1a, m0a, m1a, m2a, m3a);                              \
+        SHANI_QROUND(8, s0b, s1b, m0b, m1b, m2b, m3b);                              \
+        SHANI_QROUND(9, s0a, s1a, m1a, m2a, m3a, m0a);                              \
+        SHANI_QROUND(9, s0b, s1b, m1b, m2b, m3b, m0b);                              \
+        SHANI_QROUND(10, s0a, s1a, m2a, m3a, m0a, m1a);                             \
+        SHANI_QROUND(10, s0b, s1b, m2b, m3b, m0b, m1b);                             \
+        SHANI_QROUND(11, s0a, s1a, m3a, m0a, m1a, m2a);                             \
+        SHANI_QROUND(11, s0b, s1b, m3b, m0b, m1b, m2b);                             \
+        SHANI_QROUND(12, s0a, s1a, m0a, m1a, m2a, m3a);                             \
+        SHANI_QROUND(12, s0b, s1b, m0b, m1b, m2b, m3b);                             \
+        SHANI_QROUND(13, s0a, s1a, m1a, m2a, m3a, m0a);                             \
+        SHANI_QROUND(13, s0b, s1b, m1b, m2b, m3b, m0b);                             \
+        SHANI_QROUND(14, s0a, s1a, m2a, m3a, m0a, m1a);                             \
+        SHANI_QROUND(14, s0b, s1b, m2b, m3b, m0b, m1b);                             \
+        SHANI_QROUND(15, s0a, s1a, m3a, m0a, m1a, m2a);                             \
+        SHANI_QROUND(15, s0b, s1b, m3b, m0b, m1b, m2b);                             \
+    } while (0)
+
+/* a..h words -> SHA-NI register layout (s0 = ABEF, s1 = CDGH). */
+static inline void state_to_abef(const uint32_t s[8], __m128i *s0, __m128i *s1) {
+    __m128i abcd = _mm_loadu_si128((const __m128i *)&s[0]);
+    __m128i efgh = _mm_loadu_si128((const __m128i *)&s[4]);
+    abcd = _mm_shuffle_epi32(abcd, 0xB1); /* CDAB */
+    efgh = _mm_shuffle_epi32(efgh, 0x1B); /* EFGH -> HGFE */
+    *s0 = _mm_alignr_epi8(abcd, efgh, 8); /* ABEF */
+    *s1 = _mm_blend_epi16(efgh, abcd, 0xF0); /* CDGH */
+}
+
+/* SHA-NI layout -> (a,b,c,d) and (e,f,g,h) vectors, lane 0 first. */
+static inline void abef_to_words(__m128i s0, __m128i s1, __m128i *abcd, __m128i *efgh) {
+    __m128i feba = _mm_shuffle_epi32(s0, 0x1B);
+    __m128i dchg = _mm_shuffle_epi32(s1, 0xB1);
+    *abcd = _mm_blend_epi16(feba, dchg, 0xF0);
+    *efgh = _mm_alignr_epi8(dchg, feba, 8);
+}
+
+void sha256_x86_compress(uint32_t s[8], const uint8_t *chunk, size_t blocks) {
+    const __m128i mask = BSWAP32_MASK;
+    __m128i s0, s1;
+    state_to_abef(s, &s0, &s1);
+
+    while (blocks--) {
+        const __m128i abef_save = s0;
+        const __m128i cdgh_save = s1;
+        __m128i m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(chunk + 0)), mask);
+        __m128i m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(chunk + 16)), mask);
+        __m128i m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(chunk + 32)), mask);
+        __m128i m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(chunk + 48)), mask);
+        chunk += 64;
+        SHANI_ROUNDS(s0, s1, m0, m1, m2, m3);
+        s0 = _mm_add_epi32(s0, abef_save);
+        s1 = _mm_add_epi32(s1, cdgh_save);
+    }
+
+    __m128i abcd, efgh;
+    abef_to_words(s0, s1, &abcd, &efgh);
+    _mm_storeu_si128((__m128i *)&s[0], abcd);
+    _mm_storeu_si128((__m128i *)&s[4], efgh);
+}
+
+static inline uint32_t be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+void sha256_x86_double_mid_2way(const uint32_t midstate[8], const uint8_t header76[76], uint32_t n0, uint32_t n1,
+                                uint8_t digests[2][32]) {
+    const __m128i mask = BSWAP32_MASK;
+    const uint32_t w0 = be32(header76 + 64);
+    const uint32_t w1 = be32(header76 + 68);
+    const uint32_t w2 = be32(header76 + 72);
+
+    /* First hash, block 2: header tail + nonce, then the fixed padding for an 80-byte message. */
+    __m128i mid0, mid1;
+    state_to_abef(midstate, &mid0, &mid1);
+    __m128i s0a = mid0, s1a = mid1, s0b = mid0, s1b = mid1;
+    __m128i m0a = _mm_setr_epi32((int)w0, (int)w1, (int)w2, (int)__builtin_bswap32(n0));
+    __m128i m0b = _mm_setr_epi32((int)w0, (int)w1, (int)w2, (int)__builtin_bswap32(n1));
+    __m128i m1a = _mm_setr_epi32((int)0x80000000u, 0, 0, 0), m1b = m1a;
+    __m128i m2a = _mm_setzero_si128(), m2b = m2a;
+    __m128i m3a = _mm_setr_epi32(0, 0, 0, 80 * 8), m3b = m3a;
+    SHANI_ROUNDS_2WAY(s0a, s1a, m0a, m1a, m2a, m3a, s0b, s1b, m0b, m1b, m2b, m3b);
+    s0a = _mm_add_epi32(s0a, mid0);
+    s1a = _mm_add_epi32(s1a, mid1);
+    s0b = _mm_add_epi32(s0b, mid0);
+    s1b = _mm_add_epi32(s1b, mid1);
+
+    /* Second hash: the first digest's words are the message directly, then 32-byte padding. */
+    abef_to_words(s0a, s1a, &m0a, &m1a);
+    abef_to_words(s0b, s1b, &m0b, &m1b);
+    m2a = _mm_setr_epi32((int)0x80000000u, 0, 0, 0);
+    m2b = m2a;
+    m3a = _mm_setr_epi32(0, 0, 0, 32 * 8);
+    m3b = m3a;
+    const __m128i iv0 = _mm_set_epi32(0x6a09e667, (int)0xbb67ae85, 0x510e527f, (int)0x9b05688c); /* ABEF */
+    const __m128i iv1 = _mm_set_epi32(0x3c6ef372, (int)0xa54ff53a, 0x1f83d9ab, 0x5be0cd19);      /* CDGH */
+    s0a = iv0;
+    s1a = iv1;
+    s0b = iv0;
+    s1b = iv1;
+    SHANI_ROUNDS_2WAY(s0a, s1a, m0a, m1a, m2a, m3a, s0b, s1b, m0b, m1b, m2b, m3b);
+    s0a = _mm_add_epi32(s0a, iv0);
+    s1a = _mm_add_epi32(s1a, iv1);
+    s0b = _mm_add_epi32(s0b, iv0);
+    s1b = _mm_add_epi32(s1b, iv1);
+
+    __m128i abcd, efgh;
+    abef_to_words(s0a, s1a, &abcd, &efgh);
+    _mm_storeu_si128((__m128i *)&digests[0][0], _mm_shuffle_epi8(abcd, mask));
+    _mm_storeu_si128((__m128i *)&digests[0][16], _mm_shuffle_epi8(efgh, mask));
+    abef_to_words(s0b, s1b, &abcd, &efgh);
+    _mm_storeu_si128((__m128i *)&digests[1][0], _mm_shuffle_epi8(abcd, mask));
+    _mm_storeu_si128((__m128i *)&digests[1][16], _mm_shuffle_epi8(efgh, mask));
+}
+
+#endif
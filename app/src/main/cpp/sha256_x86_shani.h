@@ -0,0 +1,38 @@
+#ifndef SHA256_X86_SHANI_H
+#define SHA256_X86_SHANI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__x86_64__)
+
+/** x86 SHA extensions (SHA-NI); one or more 64-byte big-endian blocks. Caller checks CPU_FEATURE_X86_SHANI. */
+void sha256_x86_compress(uint32_t state[8], const uint8_t *chunk, size_t blocks);
+
+/**
+ * Double SHA-256 of header76 || n0 and header76 || n1 from [midstate] (state after the first 64 bytes),
+ * with the two nonces' rounds interleaved so they share the SHA-NI pipeline. Writes 32-byte digests.
+ */
+void sha256_x86_double_mid_2way(const uint32_t midstate[8], const uint8_t header76[76], uint32_t n0, uint32_t n1,
+                                uint8_t digests[2][32]);
+
+#else
+
+static inline void sha256_x86_compress(uint32_t state[8], const uint8_t *chunk, size_t blocks) {
+    (void)state;
+    (void)chunk;
+    (void)blocks;
+}
+
+static inline void sha256_x86_double_mid_2way(const uint32_t midstate[8], const uint8_t header76[76], uint32_t n0,
+                                              uint32_t n1, uint8_t digests[2][32]) {
+    (void)midstate;
+    (void)header76;
+    (void)n0;
+    (void)n1;
+    (void)digests;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,121 @@
+/*
+ * 256-bit share targets and difficulties without a bignum library. The only division needed is
+ * difficulty-1 target / difficulty, and a double is a 53-bit integer times a power of two, so a
+ * bit-serial long division with a 64-bit remainder gives the exact floor.
+ */
+
+#include "uint256.h"
+
+#include <math.h>
+#include <string.h>
+
+void uint256_from_be(uint256 *v, const uint8_t be[32]) {
+    for (int i = 0; i < 8; i++) {
+        const uint8_t *p = be + 4 * i;
+        v->w[i] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+    }
+}
+
+void uint256_to_be(const uint256 *v, uint8_t be[32]) {
+    for (int i = 0; i < 8; i++) {
+        be[4 * i + 0] = (uint8_t)(v->w[i] >> 24);
+        be[4 * i + 1] = (uint8_t)(v->w[i] >> 16);
+        be[4 * i + 2] = (uint8_t)(v->w[i] >> 8);
+        be[4 * i + 3] = (uint8_t)v->w[i];
+    }
+}
+
+void uint256_from_hash(uint256 *v, const uint8_t hash[32]) {
+    for (int i = 0; i < 8; i++) {
+        const uint8_t *p = hash + 28 - 4 * i;
+        v->w[i] = ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | (uint32_t)p[0];
+    }
+}
+
+int uint256_cmp(const uint256 *a, const uint256 *b) {
+    for (int i = 0; i < 8; i++) {
+        if (a->w[i] != b->w[i])
+            return a->w[i] < b->w[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+double uint256_to_double(const uint256 *v) {
+    int i = 0;
+    while (i < 8 && v->w[i] == 0)
+        i++;
+    if (i == 8)
+        return 0.0;
+    const int lz = __builtin_clz(v->w[i]);
+    uint64_t top = (uint64_t)v->w[i] << (32 + lz);
+    if (i + 1 < 8)
+        top |= (uint64_t)v->w[i + 1] << lz;
+    if (i + 2 < 8 && lz > 0)
+        top |= v->w[i + 2] >> (32 - lz);
+    /* top's bit 63 is bit 32 * (7 - i) + 31 - lz of the value. */
+    return ldexp((double)top, 32 * (7 - i) + 31 - lz - 63);
+}
+
+/* v <<= 1; returns the bit shifted out. */
+static uint32_t shl1(uint256 *v) {
+    const uint32_t out = v->w[0] >> 31;
+    for (int i = 0; i < 7; i++)
+        v->w[i] = (v->w[i] << 1) | (v->w[i + 1] >> 31);
+    v->w[7] <<= 1;
+    return out;
+}
+
+void uint256_target_from_difficulty(double difficulty, uint8_t target_be[32]) {
+    uint256 q;
+    memset(&q, 0, sizeof(q));
+    if (!(difficulty > 0.0)) {
+        q.w[1] = 0xffff0000u;
+        uint256_to_be(&q, target_be);
+        return;
+    }
+    if (isinf(difficulty)) {
+        uint256_to_be(&q, target_be);
+        return;
+    }
+    /* difficulty = m * 2^(e - 53) exactly, m < 2^53; target = floor(0xffff * 2^(261 - e) / m). */
+    int e;
+    const uint64_t m = (uint64_t)ldexp(frexp(difficulty, &e), 53);
+    const int s = 261 - e;
+    /* The quotient is at least 2^(16 + s - 54): past 2^256 it can only clamp. */
+    if (16 + s >= 310) {
+        memset(target_be, 0xff, 32);
+        return;
+    }
+    const uint32_t num = s >= 0 ? 0xffffu : (s > -16 ? 0xffffu >> -s : 0u);
+    const int nbits = 16 + (s > 0 ? s : 0);
+    uint64_t rem = 0;
+    for (int i = 0; i < nbits; i++) {
+        rem = (rem << 1) | (i < 16 ? (num >> (15 - i)) & 1u : 0u);
+        const uint32_t bit = rem >= m;
+        if (bit)
+            rem -= m;
+        if (shl1(&q)) {
+            memset(target_be, 0xff, 32);
+            return;
+        }
+        q.w[7] |= bit;
+    }
+    uint256_to_be(&q, target_be);
+}
+
+double uint256_difficulty(const uint256 *v) {
+    const double d = uint256_to_double(v);
+    return d > 0.0 ? UINT256_TRUEDIFFONE / d : UINT256_TRUEDIFFONE;
+}
+
+double uint256_difficulty_from_hash(const uint8_t hash[32]) {
+    uint256 v;
+    uint256_from_hash(&v, hash);
+    return uint256_difficulty(&v);
+}
+
+double uint256_difficulty_from_target(const uint8_t target_be[32]) {
+    uint256 v;
+    uint256_from_be(&v, target_be);
+    return uint256_difficulty(&v);
+}
@@ -0,0 +1,45 @@
+#ifndef UINT256_H
+#define UINT256_H
+
+#include <stdint.h>
+
+/* Bitcoin difficulty-1 target (nbits 0x1d00ffff), 0xffff * 2^208, as a double ("truediffone"). */
+#define UINT256_TRUEDIFFONE 26959535291011309493156476344723991336010898738574164086137773096960.0
+
+/** Unsigned 256-bit integer as eight words, w[0] most significant (the order targets are compared in). */
+typedef struct {
+    uint32_t w[8];
+} uint256;
+
+/** Big-endian 32 bytes (share targets) to / from words. */
+void uint256_from_be(uint256 *v, const uint8_t be[32]);
+void uint256_to_be(const uint256 *v, uint8_t be[32]);
+
+/** A SHA256d digest as the PoW integer: little-endian buffer, digest[31] is the most significant byte. */
+void uint256_from_hash(uint256 *v, const uint8_t hash[32]);
+
+/** -1, 0 or 1 as a <, ==, > b. */
+int uint256_cmp(const uint256 *a, const uint256 *b);
+
+/** Nearest double, rounded once from the 64 bits starting at the leading one. */
+double uint256_to_double(const uint256 *v);
+
+/**
+ * Share target for pool [difficulty]: floor(difficulty-1 target / difficulty), written big-endian.
+ * Exact for every finite double: the quotient is a long division by the double's 53-bit mantissa.
+ * Results easier than 2^256 - 1 clamp to all 0xff; difficulty <= 0 or NaN gives the difficulty-1
+ * target and +inf gives zero. StratumHeaderBuilder.buildTargetFromDifficulty divides by the shortest
+ * decimal form of the double instead, so fractional difficulties can differ in the last few bits.
+ */
+void uint256_target_from_difficulty(double difficulty, uint8_t target_be[32]);
+
+/** truediffone / [v]; truediffone when [v] is zero. */
+double uint256_difficulty(const uint256 *v);
+
+/** Share difficulty of a SHA256d digest (pool / public-pool DifficultyUtils convention). */
+double uint256_difficulty_from_hash(const uint8_t hash[32]);
+
+/** Difficulty a big-endian share target stands for; inverse of uint256_target_from_difficulty. */
+double uint256_difficulty_from_target(const uint8_t target_be[32]);
+
+#endif
@@ -1,10 +1,14 @@
 /*
  * Vulkan GPU miner JNI.
  * gpuIsAvailable(): initializes Vulkan (instance, device, compute queue). Returns true if Vulkan is present.
- * gpuScanNoncesInto(): scans nonce range via compute shader; writes status + nonce into jlong[2] (GPU JNI codes only).
+ * gpuScanJob(): scans a nonce range of a prepared job (miner_job.h) via compute shader; status, nonce and
+ * scanned count go into a direct-buffer channel (miner_channel.h) (GPU JNI codes only).
  */
 #include "sha256.h"
 #include "btc_header_sha256.h"
+#include "gpu_ubo.h"
+#include "miner_channel.h"
+#include "miner_job.h"
 #include <jni.h>
 #include <stdatomic.h>
 #include <stdint.h>
@@ -21,17 +25,6 @@
 #define HEADER_PREFIX_SIZE 76
 #define BLOCK_HEADER_SIZE 80
 #define HASH_SIZE 32
-#define UBO_SIZE 256
-#define UBO_HEADER_WORDS (HEADER_PREFIX_SIZE / 4)
-#define UBO_OFFSET_MIDSTATE (HEADER_PREFIX_SIZE)
-#define UBO_OFFSET_NONCE_START (HEADER_PREFIX_SIZE + 32u)
-#define UBO_OFFSET_NONCE_END (UBO_OFFSET_NONCE_START + 4u)
-#define UBO_OFFSET_TARGET (UBO_OFFSET_NONCE_END + 4u)
-#define UBO_OFFSET_GPU_USE_MIDSTATE (UBO_OFFSET_TARGET + (uint32_t)HASH_SIZE)
-#define UBO_OFFSET_GPU_SELFTEST (UBO_OFFSET_GPU_USE_MIDSTATE + 4u)
-#define UBO_HOST_PAYLOAD_BYTES (UBO_OFFSET_GPU_SELFTEST + 4u)
-_Static_assert(UBO_HOST_PAYLOAD_BYTES <= UBO_SIZE, "UBO host layout exceeds UBO_SIZE; update vulkan_miner.c and miner.comp");
-_Static_assert(HEADER_PREFIX_SIZE % 4 == 0, "UBO header must be a multiple of 4 bytes");
 #define RESULT_BUFFER_SIZE 128
 #define GPU_SELFTEST_TAG "GPU_SHA_SelfTest"
 #define LOG_TAG "VulkanMiner"
@@ -599,33 +592,6 @@ static void cleanup_vulkan(void) {
     g_vulkan_available = -1;
 }
 
-/* Write 4 bytes to dst as little-endian so GPU (LE) reads the same uint value as C (BE word) */
-static void write_le32(uint8_t *dst, uint32_t val) {
-    dst[0] = (uint8_t)(val);
-    dst[1] = (uint8_t)(val >> 8);
-    dst[2] = (uint8_t)(val >> 16);
-    dst[3] = (uint8_t)(val >> 24);
-}
-
-static void fill_ubo_mining(uint8_t *ubo, const uint8_t *header76, uint32_t nonceStart, uint32_t nonceEnd,
-                            const uint8_t *target, int useMidstate, int selftestWriteDigest, const uint32_t mid[8]) {
-    memset(ubo, 0, UBO_SIZE);
-    for (int i = 0; i < UBO_HEADER_WORDS; i++) {
-        uint32_t w = (uint32_t)header76[i * 4] << 24 | (uint32_t)header76[i * 4 + 1] << 16 |
-                     (uint32_t)header76[i * 4 + 2] << 8 | (uint32_t)header76[i * 4 + 3];
-        write_le32(ubo + i * 4, w);
-    }
-    if (useMidstate) {
-        for (int i = 0; i < 8; i++)
-            write_le32(ubo + UBO_OFFSET_MIDSTATE + i * 4, mid[i]);
-    }
-    write_le32(ubo + UBO_OFFSET_NONCE_START, nonceStart);
-    write_le32(ubo + UBO_OFFSET_NONCE_END, nonceEnd);
-    memcpy(ubo + UBO_OFFSET_TARGET, target, HASH_SIZE);
-    write_le32(ubo + UBO_OFFSET_GPU_USE_MIDSTATE, useMidstate ? 1u : 0u);
-    write_le32(ubo + UBO_OFFSET_GPU_SELFTEST, selftestWriteDigest ? 1u : 0u);
-}
-
 static void sha256_words_to_digest_be(const uint32_t w[8], uint8_t out[32]) {
     for (int i = 0; i < 8; i++) {
         out[i * 4 + 0] = (uint8_t)(w[i] >> 24);
@@ -748,7 +714,7 @@ static int gpu_sha_vulkan_selftest_inner(int useMidstate) {
     uint8_t target[HASH_SIZE];
     memset(target, 0, sizeof(target));
     uint8_t ubo[UBO_SIZE];
-    fill_ubo_mining(ubo, h76, 1u, 1u, target, useMidstate, 1, mid);
+    gpu_ubo_fill(ubo, h76, 1u, 1u, target, useMidstate, 1, mid);
 
     void *ptr;
     VkResult mapRes = vkMapMemory(g_device, g_uboMemory, 0, UBO_SIZE, 0, &ptr);
@@ -827,9 +793,12 @@ static int gpu_sha_vulkan_selftest_inner(int useMidstate) {
     return (same_first && same_final && found == RES_SELFTEST_FOUND_MAGIC) ? 1 : 0;
 }
 
-/* Returns GPU_UNAVAILABLE on failure; else 0. Sets *hit_out 0/1; if 1, *nonce_out is the winning nonce (may be 0xFFFFFFFFu). */
-static int run_gpu_scan(const uint8_t *header76, uint32_t nonceStart, uint32_t nonceEnd,
-                        const uint8_t *target, int gpuCores, int useMidstate, int *hit_out, uint32_t *nonce_out) {
+/*
+ * Returns GPU_UNAVAILABLE on failure; else 0. Sets *hit_out 0/1; if 1, *nonce_out is the winning nonce (may be 0xFFFFFFFFu).
+ * The uniform buffer starts from [job]'s prepared image; each dispatch only writes its nonce range.
+ */
+static int run_gpu_scan(const miner_job *job, uint32_t nonceStart, uint32_t nonceEnd, int gpuCores, int useMidstate,
+                        int *hit_out, uint32_t *nonce_out) {
     if (gpuCores < 1) gpuCores = 1;
     uint32_t maxSteps = g_maxWorkGroupSize / 32;
     if (maxSteps > MAX_GPU_WORKGROUP_STEPS)
@@ -873,10 +842,8 @@ static int run_gpu_scan(const uint8_t *header76, uint32_t nonceStart, uint32_t n
         g_workgroup_size_logged = 1;
     }
 
-    uint32_t mid[8] = {0};
-    if (useMidstate)
-        btc_midstate_header76(header76, mid);
     uint8_t ubo[UBO_SIZE];
+    memcpy(ubo, job->gpu_ubo, UBO_SIZE);
 
     /* One vkCmdDispatch is limited to maxComputeWorkGroupCount[0] groups. Without looping, part of a
      * large Java "chunk" would never be scanned while Kotlin still credits the full chunk — misses
@@ -903,7 +870,7 @@ static int run_gpu_scan(const uint8_t *header76, uint32_t nonceStart, uint32_t n
         if (groupCountX == 0)
             return GPU_UNAVAILABLE;
 
-        fill_ubo_mining(ubo, header76, cursor, subEnd, target, useMidstate, 0, mid);
+        gpu_ubo_set_range(ubo, cursor, subEnd, useMidstate);
 
         void *ptr;
         VkResult mapRes = vkMapMemory(g_device, g_uboMemory, 0, UBO_SIZE, 0, &ptr);
@@ -1044,61 +1011,45 @@ Java_com_btcminer_android_mining_NativeMiner_gpuShaVulkanSelftest(JNIEnv *env, j
 #endif
 }
 
-/* Parameter order must match Kotlin [NativeMiner.gpuScanNoncesInto] (out is last). */
-JNIEXPORT void JNICALL
-Java_com_btcminer_android_mining_NativeMiner_gpuScanNoncesInto(JNIEnv *env, jclass clazz, jbyteArray header76Java,
-                                                               jint nonceStart, jint nonceEnd, jbyteArray targetJava,
-                                                               jint gpuCores, jint gpuSha256Mode, jlongArray outJava) {
+/*
+ * Parameter order must match Kotlin [NativeMiner.gpuScanJob]. Scans a prepared job (nativeJobCreate, miner_job.h)
+ * that the caller keeps alive for the call; status, winning nonce and nonces scanned go into the channel
+ * (miner_channel.h). Returns the status. Takes only primitives but blocks for the whole dispatch, so it stays a
+ * normal JNI call rather than @CriticalNative.
+ */
+JNIEXPORT jint JNICALL
+Java_com_btcminer_android_mining_NativeMiner_gpuScanJob(JNIEnv *env, jclass clazz, jlong job, jlong channel,
+                                                        jint nonceStart, jint nonceEnd, jint gpuCores,
+                                                        jint gpuSha256Mode) {
+    (void)env;
     (void)clazz;
-    if (!outJava || (*env)->GetArrayLength(env, outJava) < 2) {
-        return;
-    }
-    jlong *out = (*env)->GetLongArrayElements(env, outJava, NULL);
-    if (!out)
-        return;
-    if (!header76Java || !targetJava ||
-        (*env)->GetArrayLength(env, header76Java) != HEADER_PREFIX_SIZE ||
-        (*env)->GetArrayLength(env, targetJava) != HASH_SIZE) {
-        out[0] = (jlong)GPU_JNI_STATUS_UNAVAILABLE;
-        out[1] = 0;
-        (*env)->ReleaseLongArrayElements(env, outJava, out, 0);
-        return;
-    }
-
-    uint8_t header76[HEADER_PREFIX_SIZE];
-    uint8_t target[HASH_SIZE];
-
+    miner_channel *ch = (miner_channel *)(intptr_t)channel;
+    const miner_job *mj = (const miner_job *)(intptr_t)job;
+    if (!ch)
+        return GPU_JNI_STATUS_UNAVAILABLE;
+    ch->status = GPU_JNI_STATUS_UNAVAILABLE;
+    ch->nonce = 0;
+    ch->scanned = 0;
 #ifdef __ANDROID__
-    if (!try_init_vulkan()) {
-        out[0] = (jlong)GPU_JNI_STATUS_UNAVAILABLE;
-        out[1] = 0;
-        (*env)->ReleaseLongArrayElements(env, outJava, out, 0);
-        return;
-    }
-    (*env)->GetByteArrayRegion(env, header76Java, 0, HEADER_PREFIX_SIZE, (jbyte *)header76);
-    (*env)->GetByteArrayRegion(env, targetJava, 0, HASH_SIZE, (jbyte *)target);
-    int useMid = (gpuSha256Mode != 0);
-    int hit = 0;
-    uint32_t winNonce = 0u;
-    int rr = run_gpu_scan(header76, (uint32_t)nonceStart, (uint32_t)nonceEnd, target, (int)gpuCores, useMid, &hit,
-        &winNonce);
-    if (rr == GPU_UNAVAILABLE) {
-        out[0] = (jlong)GPU_JNI_STATUS_UNAVAILABLE;
-        out[1] = 0;
-    } else if (hit) {
-        out[0] = (jlong)GPU_JNI_STATUS_HIT;
-        out[1] = (jlong)(uint32_t)winNonce;
-    } else {
-        out[0] = (jlong)GPU_JNI_STATUS_MISS;
-        out[1] = 0;
+    if (mj && try_init_vulkan()) {
+        int hit = 0;
+        uint32_t winNonce = 0u;
+        const int rr = run_gpu_scan(mj, (uint32_t)nonceStart, (uint32_t)nonceEnd, (int)gpuCores, gpuSha256Mode != 0,
+            &hit, &winNonce);
+        if (rr != GPU_UNAVAILABLE) {
+            /* A hit ends the chunk at the winning nonce. */
+            const uint32_t last = hit ? winNonce : (uint32_t)nonceEnd;
+            ch->status = hit ? GPU_JNI_STATUS_HIT : GPU_JNI_STATUS_MISS;
+            ch->nonce = hit ? winNonce : 0u;
+            ch->scanned = (uint64_t)(last - (uint32_t)nonceStart) + 1u;
+        }
     }
 #else
+    (void)mj;
     (void)nonceStart;
     (void)nonceEnd;
     (void)gpuCores;
     (void)gpuSha256Mode;
-    out[0] = (jlong)GPU_JNI_STATUS_UNAVAILABLE;
-    out[1] = 0;
 #endif
-    (*env)->ReleaseLongArrayElements(env, outJava, out, 0);
+    return (jint)ch->status;
 }
@@ -187,6 +187,7 @@ class ConfigActivity : AppCompatActivity() {
         binding.configWorkerName.editText?.setText(c.workerName)
         binding.configPartialWakeLock.isChecked = c.usePartialWakeLock
         binding.configUseLegacyAlarm.isChecked = c.useLegacyAlarm
+        binding.configPerWorkerExtranonce2.isChecked = c.perWorkerExtranonce2
         val alarmSec = c.alarmWakeIntervalSec.coerceIn(MiningConfig.ALARM_WAKE_INTERVAL_SEC_MIN, MiningConfig.ALARM_WAKE_INTERVAL_SEC_MAX)
         binding.configSliderAlarmWakeInterval.valueFrom = MiningConfig.ALARM_WAKE_INTERVAL_SEC_MIN.toFloat()
         binding.configSliderAlarmWakeInterval.valueTo = MiningConfig.ALARM_WAKE_INTERVAL_SEC_MAX.toFloat()
@@ -242,6 +243,16 @@ class ConfigActivity : AppCompatActivity() {
         CpuSha256Flavor.NEON4 -> R.id.config_radio_cpu_sha_3
         CpuSha256Flavor.SCALAR_MIDSTATE -> R.id.config_radio_cpu_sha_4
         CpuSha256Flavor.SCALAR -> R.id.config_radio_cpu_sha_5
+        CpuSha256Flavor.SHA_NI_MIDSTATE -> R.id.config_radio_cpu_sha_6
+        CpuSha256Flavor.SHA_NI_2WAY -> R.id.config_radio_cpu_sha_7
+        CpuSha256Flavor.AVX2_8WAY -> R.id.config_radio_cpu_sha_8
+        CpuSha256Flavor.AVX512_16WAY -> R.id.config_radio_cpu_sha_9
+        CpuSha256Flavor.SSE4_4WAY_MIDSTATE -> R.id.config_radio_cpu_sha_10
+        CpuSha256Flavor.SSE4_4WAY -> R.id.config_radio_cpu_sha_11
+        CpuSha256Flavor.NEON8_MIDSTATE -> R.id.config_radio_cpu_sha_12
+        CpuSha256Flavor.HW_SHA2_2WAY -> R.id.config_radio_cpu_sha_13
+        CpuSha256Flavor.HW_SHA2_3WAY -> R.id.config_radio_cpu_sha_14
+        CpuSha256Flavor.AUTO -> R.id.config_radio_cpu_sha_15
     }
 
     private fun flavorForCheckedRadio(): CpuSha256Flavor = when (binding.configRadioGroupCpuSha.checkedRadioButtonId) {
@@ -251,6 +262,16 @@ class ConfigActivity : AppCompatActivity() {
         R.id.config_radio_cpu_sha_3 -> CpuSha256Flavor.NEON4
         R.id.config_radio_cpu_sha_4 -> CpuSha256Flavor.SCALAR_MIDSTATE
         R.id.config_radio_cpu_sha_5 -> CpuSha256Flavor.SCALAR
+        R.id.config_radio_cpu_sha_6 -> CpuSha256Flavor.SHA_NI_MIDSTATE
+        R.id.config_radio_cpu_sha_7 -> CpuSha256Flavor.SHA_NI_2WAY
+        R.id.config_radio_cpu_sha_8 -> CpuSha256Flavor.AVX2_8WAY
+        R.id.config_radio_cpu_sha_9 -> CpuSha256Flavor.AVX512_16WAY
+        R.id.config_radio_cpu_sha_10 -> CpuSha256Flavor.SSE4_4WAY_MIDSTATE
+        R.id.config_radio_cpu_sha_11 -> CpuSha256Flavor.SSE4_4WAY
+        R.id.config_radio_cpu_sha_12 -> CpuSha256Flavor.NEON8_MIDSTATE
+        R.id.config_radio_cpu_sha_13 -> CpuSha256Flavor.HW_SHA2_2WAY
+        R.id.config_radio_cpu_sha_14 -> CpuSha256Flavor.HW_SHA2_3WAY
+        R.id.config_radio_cpu_sha_15 -> CpuSha256Flavor.AUTO
         else -> CpuSha256Flavor.SCALAR
     }
 
@@ -270,6 +291,16 @@ class ConfigActivity : AppCompatActivity() {
         applyRb(binding.configRadioCpuSha3, CpuSha256Flavor.NEON4, getString(R.string.config_cpu_sha_neon))
         applyRb(binding.configRadioCpuSha4, CpuSha256Flavor.SCALAR_MIDSTATE, getString(R.string.config_cpu_sha_scalar_mid))
         applyRb(binding.configRadioCpuSha5, CpuSha256Flavor.SCALAR, getString(R.string.config_cpu_sha_scalar))
+        applyRb(binding.configRadioCpuSha6, CpuSha256Flavor.SHA_NI_MIDSTATE, getString(R.string.config_cpu_sha_shani_mid))
+        applyRb(binding.configRadioCpuSha7, CpuSha256Flavor.SHA_NI_2WAY, getString(R.string.config_cpu_sha_shani_2way))
+        applyRb(binding.configRadioCpuSha8, CpuSha256Flavor.AVX2_8WAY, getString(R.string.config_cpu_sha_avx2_8way))
+        applyRb(binding.configRadioCpuSha9, CpuSha256Flavor.AVX512_16WAY, getString(R.string.config_cpu_sha_avx512_16way))
+        applyRb(binding.configRadioCpuSha10, CpuSha256Flavor.SSE4_4WAY_MIDSTATE, getString(R.string.config_cpu_sha_sse4_mid))
+        applyRb(binding.configRadioCpuSha11, CpuSha256Flavor.SSE4_4WAY, getString(R.string.config_cpu_sha_sse4))
+        applyRb(binding.configRadioCpuSha12, CpuSha256Flavor.NEON8_MIDSTATE, getString(R.string.config_cpu_sha_neon8_mid))
+        applyRb(binding.configRadioCpuSha13, CpuSha256Flavor.HW_SHA2_2WAY, getString(R.string.config_cpu_sha_hw_2way))
+        applyRb(binding.configRadioCpuSha14, CpuSha256Flavor.HW_SHA2_3WAY, getString(R.string.config_cpu_sha_hw_3way))
+        applyRb(binding.configRadioCpuSha15, CpuSha256Flavor.AUTO, getString(R.string.config_cpu_sha_auto))
     }
 
     private fun saveConfig() {
@@ -333,6 +364,7 @@ class ConfigActivity : AppCompatActivity() {
             ),
             cpuSha256Flavor = cpuShaFlavor,
             gpuSha256Mode = gpuSha256Mode,
+            perWorkerExtranonce2 = binding.configPerWorkerExtranonce2.isChecked,
         )
 
         if (config.bitcoinAddress.isNotBlank() && !BitcoinAddressValidator.isValidAddress(config.bitcoinAddress)) {
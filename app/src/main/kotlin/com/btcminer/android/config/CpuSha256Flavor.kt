@@ -10,14 +10,46 @@ enum class CpuSha256Flavor {
     NEON4,
     SCALAR_MIDSTATE,
     SCALAR,
+    /** x86_64 SHA extensions, one nonce per call. */
+    SHA_NI_MIDSTATE,
+    /** x86_64 SHA extensions, two nonces interleaved per call. */
+    SHA_NI_2WAY,
+    /** x86_64 AVX2, eight nonces per call. */
+    AVX2_8WAY,
+    /** x86_64 AVX-512, sixteen nonces per call. */
+    AVX512_16WAY,
+    /** x86_64 SSSE3/SSE4.1, four nonces per call from the midstate. */
+    SSE4_4WAY_MIDSTATE,
+    /** x86_64 SSSE3/SSE4.1, four nonces per call, full header each call. */
+    SSE4_4WAY,
+    /** AArch64 NEON, two interleaved quads (eight nonces) per call from the midstate. */
+    NEON8_MIDSTATE,
+    /** AArch64 SHA2 crypto extensions, two nonces interleaved per call from the midstate. */
+    HW_SHA2_2WAY,
+    /** AArch64 SHA2 crypto extensions, three nonces interleaved per call from the midstate. */
+    HW_SHA2_3WAY,
+    /**
+     * Fastest flavor measured on this device ([CpuShaCalibration]); resolved before mining, never passed
+     * to the native scan.
+     */
+    AUTO,
     ;
 
     companion object {
         /** Priority order for [CpuShaCapabilities.coerceToSupported]. */
         val COERCE_PRIORITY: List<CpuSha256Flavor> = listOf(
+            HW_SHA2_2WAY,
+            HW_SHA2_3WAY,
             HW_SHA2_MIDSTATE,
             HW_SHA2,
+            AVX512_16WAY,
+            SHA_NI_2WAY,
+            AVX2_8WAY,
+            SHA_NI_MIDSTATE,
+            SSE4_4WAY_MIDSTATE,
+            SSE4_4WAY,
             NEON4_MIDSTATE,
+            NEON8_MIDSTATE,
             NEON4,
             SCALAR_MIDSTATE,
             SCALAR,
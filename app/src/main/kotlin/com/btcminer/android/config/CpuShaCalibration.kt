@@ -0,0 +1,89 @@
+package com.btcminer.android.config
+
+import android.os.Build
+import com.btcminer.android.AppLog
+import com.btcminer.android.BuildConfig
+import com.btcminer.android.mining.NativeMiner
+
+/**
+ * Result of [NativeMiner.nativeCalibrateCpuSha256]: the flavor [CpuSha256Flavor.AUTO] resolves to, plus the
+ * per-cluster table it was picked from. Stored with the [deviceKey] it was measured under so a new SoC,
+ * ABI or native build recalibrates instead of reusing stale numbers.
+ */
+data class CpuShaCalibration(
+    val deviceKey: String,
+    val winner: CpuSha256Flavor,
+    val rows: List<Row>,
+) {
+    data class Row(val cluster: Int, val cpuMask: Long, val flavor: CpuSha256Flavor, val hashesPerSec: Long)
+
+    /** `cluster:mask:flavor:hs` per row, `;`-separated; parsed back by [decodeRows]. */
+    fun encodeRows(): String =
+        rows.joinToString(";") { "${it.cluster}:${it.cpuMask}:${it.flavor.ordinal}:${it.hashesPerSec}" }
+
+    companion object {
+        private const val TAG = "CpuShaCalibration"
+
+        /** Per flavor and cluster; ~15 flavors x 2-3 clusters keeps a first start under ~7 s. */
+        const val MS_PER_FLAVOR = 150
+
+        private const val MAX_CLUSTERS = 8
+        private const val MAX_FLAVORS = 15
+
+        /**
+         * Identifies what the calibration depends on: SoC, primary ABI and the library build (the app's version
+         * code and the native kernels' version, so a new kernel or flavor recalibrates even on a dev build).
+         */
+        fun deviceKey(): String {
+            val soc = if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.S) {
+                "${Build.SOC_MANUFACTURER}/${Build.SOC_MODEL}"
+            } else {
+                "${Build.HARDWARE}/${Build.BOARD}"
+            }
+            val abi = Build.SUPPORTED_64_BIT_ABIS.firstOrNull() ?: Build.SUPPORTED_ABIS.firstOrNull()
+            val kernels = try {
+                NativeMiner.nativeKernelsVersion().toString()
+            } catch (_: Throwable) {
+                "?"
+            }
+            return "$soc|$abi|${BuildConfig.VERSION_CODE}|$kernels"
+        }
+
+        /**
+         * Runs the native calibration on the calling thread (blocks for roughly
+         * [MS_PER_FLAVOR] x flavors x clusters). Null when interrupted, nothing passed its self-test, or the
+         * library is unavailable.
+         */
+        fun run(): CpuShaCalibration? {
+            val out = LongArray(
+                NativeMiner.CPU_CALIBRATION_HEADER + NativeMiner.CPU_CALIBRATION_ROW * MAX_CLUSTERS * MAX_FLAVORS
+            )
+            try {
+                NativeMiner.nativeCalibrateCpuSha256(MS_PER_FLAVOR, out)
+            } catch (e: Throwable) {
+                AppLog.e(TAG) { "calibration failed: ${e.message}" }
+                return null
+            }
+            val winner = CpuSha256Flavor.fromOrdinal(out[0].toInt())
+                ?.takeIf { it != CpuSha256Flavor.AUTO && CpuShaCapabilities.isSelectable(it) }
+                ?: return null
+            val n = out[1].toInt()
+            val rows = (0 until n).mapNotNull { i ->
+                val o = NativeMiner.CPU_CALIBRATION_HEADER + i * NativeMiner.CPU_CALIBRATION_ROW
+                CpuSha256Flavor.fromOrdinal(out[o + 2].toInt())?.let { f ->
+                    Row(out[o].toInt(), out[o + 1], f, out[o + 3])
+                }
+            }
+            return CpuShaCalibration(deviceKey(), winner, rows)
+        }
+
+        fun decodeRows(s: String): List<Row> =
+            s.split(';').mapNotNull { r ->
+                val p = r.split(':')
+                if (p.size != 4) return@mapNotNull null
+                val flavor = p[2].toIntOrNull()?.let { CpuSha256Flavor.fromOrdinal(it) } ?: return@mapNotNull null
+                Row(p[0].toIntOrNull() ?: return@mapNotNull null, p[1].toLongOrNull() ?: 0L, flavor,
+                    p[3].toLongOrNull() ?: 0L)
+            }
+    }
+}
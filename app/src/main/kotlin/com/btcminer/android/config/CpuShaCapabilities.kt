@@ -8,12 +8,15 @@ import com.btcminer.android.mining.NativeMiner
  */
 object CpuShaCapabilities {
 
+    private val primaryAbi: String?
+        get() = Build.SUPPORTED_64_BIT_ABIS.firstOrNull()
+            ?: Build.SUPPORTED_ABIS.firstOrNull()
+
     val hasNeon4Build: Boolean
-        get() {
-            val primary = Build.SUPPORTED_64_BIT_ABIS.firstOrNull()
-                ?: Build.SUPPORTED_ABIS.firstOrNull()
-            return primary == "arm64-v8a"
-        }
+        get() = primaryAbi == "arm64-v8a"
+
+    val hasX86_64Build: Boolean
+        get() = primaryAbi == "x86_64"
 
     val hasHwSha2: Boolean
         get() = try {
@@ -22,13 +25,52 @@ object CpuShaCapabilities {
             false
         }
 
+    val hasShaNi: Boolean
+        get() = try {
+            NativeMiner.nativeCpuidShaNi()
+        } catch (_: Throwable) {
+            false
+        }
+
+    val hasSse41: Boolean
+        get() = try {
+            NativeMiner.nativeCpuidSse41()
+        } catch (_: Throwable) {
+            false
+        }
+
+    val hasAvx2: Boolean
+        get() = try {
+            NativeMiner.nativeCpuidAvx2()
+        } catch (_: Throwable) {
+            false
+        }
+
+    val hasAvx512: Boolean
+        get() = try {
+            NativeMiner.nativeCpuidAvx512()
+        } catch (_: Throwable) {
+            false
+        }
+
     fun isSelectable(flavor: CpuSha256Flavor): Boolean = when (flavor) {
-        CpuSha256Flavor.HW_SHA2_MIDSTATE, CpuSha256Flavor.HW_SHA2 ->
+        CpuSha256Flavor.HW_SHA2_MIDSTATE, CpuSha256Flavor.HW_SHA2,
+        CpuSha256Flavor.HW_SHA2_2WAY, CpuSha256Flavor.HW_SHA2_3WAY ->
             hasNeon4Build && hasHwSha2
-        CpuSha256Flavor.NEON4_MIDSTATE, CpuSha256Flavor.NEON4 ->
+        CpuSha256Flavor.NEON4_MIDSTATE, CpuSha256Flavor.NEON4, CpuSha256Flavor.NEON8_MIDSTATE ->
             hasNeon4Build
         CpuSha256Flavor.SCALAR_MIDSTATE, CpuSha256Flavor.SCALAR ->
             true
+        CpuSha256Flavor.SHA_NI_MIDSTATE, CpuSha256Flavor.SHA_NI_2WAY ->
+            hasX86_64Build && hasShaNi
+        CpuSha256Flavor.AVX2_8WAY ->
+            hasX86_64Build && hasAvx2
+        CpuSha256Flavor.AVX512_16WAY ->
+            hasX86_64Build && hasAvx512
+        CpuSha256Flavor.SSE4_4WAY_MIDSTATE, CpuSha256Flavor.SSE4_4WAY ->
+            hasX86_64Build && hasSse41
+        CpuSha256Flavor.AUTO ->
+            true
     }
 
     /** Pick first flavor in priority order that is [isSelectable], else [CpuSha256Flavor.SCALAR]. */
@@ -28,8 +28,10 @@ data class MiningConfig(
     val useLegacyAlarm: Boolean = false,
     val miningThreadPriority: Int = 0,
     val alarmWakeIntervalSec: Int = 60,
-    val cpuSha256Flavor: CpuSha256Flavor = CpuSha256Flavor.SCALAR,
+    val cpuSha256Flavor: CpuSha256Flavor = CpuSha256Flavor.AUTO,
     val gpuSha256Mode: GpuSha256Mode = GpuSha256Mode.GPU_FULL,
+    /** Each CPU worker and the GPU mine their own extranonce2 sequence instead of sharing one header per round. */
+    val perWorkerExtranonce2: Boolean = false,
 ) {
     fun isValidForMining(): Boolean =
         stratumUrl.isNotBlank() && stratumUser.isNotBlank()
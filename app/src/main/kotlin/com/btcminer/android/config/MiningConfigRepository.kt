@@ -58,7 +58,7 @@ class MiningConfigRepository(context: Context) {
         cpuSha256Flavor = run {
             val rawOrd = storage.getInt(
                 SecureConfigStorage.KEY_CPU_SHA256_FLAVOR,
-                CpuSha256Flavor.SCALAR.ordinal
+                CpuSha256Flavor.AUTO.ordinal
             )
             val raw = CpuSha256Flavor.fromOrdinal(rawOrd) ?: CpuSha256Flavor.SCALAR
             CpuShaCapabilities.coerceToSupported(raw)
@@ -66,8 +66,57 @@ class MiningConfigRepository(context: Context) {
         gpuSha256Mode = GpuSha256Mode.fromOrdinal(
             storage.getInt(SecureConfigStorage.KEY_GPU_SHA256_MODE, GpuSha256Mode.GPU_FULL.ordinal)
         ),
+        perWorkerExtranonce2 = storage.getBoolean(SecureConfigStorage.KEY_PER_WORKER_EXTRANONCE2, false),
     )
 
+    /**
+     * Concrete flavor to mine with. [CpuSha256Flavor.AUTO] maps to the stored calibration winner when it was
+     * measured on this [CpuShaCalibration.deviceKey]; otherwise calibrates now (blocking, call off the main
+     * thread) and stores the result. Falls back to the best supported flavor when calibration fails.
+     */
+    fun resolveCpuSha256Flavor(flavor: CpuSha256Flavor): CpuSha256Flavor {
+        if (flavor != CpuSha256Flavor.AUTO) return flavor
+        if (hasCurrentCpuShaCalibration()) {
+            CpuSha256Flavor.fromOrdinal(storage.getInt(SecureConfigStorage.KEY_CPU_SHA_CALIBRATION_FLAVOR, -1))
+                ?.takeIf { it != CpuSha256Flavor.AUTO && CpuShaCapabilities.isSelectable(it) }
+                ?.let { return it }
+        }
+        val cal = CpuShaCalibration.run()
+            ?: return CpuShaCapabilities.coerceToSupported(CpuSha256Flavor.COERCE_PRIORITY.first())
+        storage.commitBatch { edit ->
+            edit.putString(SecureConfigStorage.KEY_CPU_SHA_CALIBRATION_DEVICE, cal.deviceKey)
+            edit.putInt(SecureConfigStorage.KEY_CPU_SHA_CALIBRATION_FLAVOR, cal.winner.ordinal)
+            edit.putString(SecureConfigStorage.KEY_CPU_SHA_CALIBRATION_TABLE, cal.encodeRows())
+        }
+        return cal.winner
+    }
+
+    /**
+     * Per-cluster timings of the stored calibration when it was measured on this [CpuShaCalibration.deviceKey]
+     * (for [com.btcminer.android.mining.CpuPlacement]); empty otherwise. Never calibrates.
+     */
+    fun storedCpuShaCalibrationRows(): List<CpuShaCalibration.Row> {
+        if (!hasCurrentCpuShaCalibration()) return emptyList()
+        return CpuShaCalibration.decodeRows(storage.getStr(SecureConfigStorage.KEY_CPU_SHA_CALIBRATION_TABLE))
+    }
+
+    /**
+     * Whether the stored calibration was measured under this [CpuShaCalibration.deviceKey]. One from another
+     * SoC or library build is dropped here, winner and table together.
+     */
+    private fun hasCurrentCpuShaCalibration(): Boolean {
+        val stored = storage.getStr(SecureConfigStorage.KEY_CPU_SHA_CALIBRATION_DEVICE)
+        if (stored == CpuShaCalibration.deviceKey()) return true
+        if (stored.isNotEmpty()) {
+            storage.commitBatch { edit ->
+                edit.remove(SecureConfigStorage.KEY_CPU_SHA_CALIBRATION_DEVICE)
+                edit.remove(SecureConfigStorage.KEY_CPU_SHA_CALIBRATION_FLAVOR)
+                edit.remove(SecureConfigStorage.KEY_CPU_SHA_CALIBRATION_TABLE)
+            }
+        }
+        return false
+    }
+
     /** Returns the stored stratum cert pin for the given host, or null if none. Host should be normalized (no scheme, first segment). */
     fun getStratumPin(host: String): String? =
         storage.getStr(SecureConfigStorage.KEY_STRATUM_PIN_PREFIX + host, "").takeIf { it.isNotBlank() }
@@ -137,6 +186,7 @@ class MiningConfigRepository(context: Context) {
                 config.cpuSha256Flavor.ordinal
             )
             edit.putInt(SecureConfigStorage.KEY_GPU_SHA256_MODE, config.gpuSha256Mode.ordinal)
+            edit.putBoolean(SecureConfigStorage.KEY_PER_WORKER_EXTRANONCE2, config.perWorkerExtranonce2)
         }
     }
 }
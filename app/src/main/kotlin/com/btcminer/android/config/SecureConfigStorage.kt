@@ -82,5 +82,9 @@ class SecureConfigStorage(context: Context) {
         const val KEY_ALARM_WAKE_INTERVAL_SEC = "alarm_wake_interval_sec"
         const val KEY_CPU_SHA256_FLAVOR = "cpu_sha256_flavor"
         const val KEY_GPU_SHA256_MODE = "gpu_sha256_mode"
+        const val KEY_PER_WORKER_EXTRANONCE2 = "per_worker_extranonce2"
+        const val KEY_CPU_SHA_CALIBRATION_DEVICE = "cpu_sha_calibration_device"
+        const val KEY_CPU_SHA_CALIBRATION_FLAVOR = "cpu_sha_calibration_flavor"
+        const val KEY_CPU_SHA_CALIBRATION_TABLE = "cpu_sha_calibration_table"
     }
 }
@@ -0,0 +1,109 @@
+package com.btcminer.android.mining
+
+import com.btcminer.android.config.CpuSha256Flavor
+import com.btcminer.android.config.CpuShaCalibration
+import com.btcminer.android.config.CpuShaCapabilities
+
+/**
+ * Where the CPU pool's workers run on big.LITTLE SoCs. The configured thread count is filled fastest cluster
+ * first ([NativeMiner.nativeCpuTopology]) and each cluster used becomes one pinned [CpuWorkerPool] group, so
+ * the scheduler cannot park a prime-core worker on a little core mid-round. Per cluster, the group gets:
+ * - the flavor that cluster calibrated fastest with, when the configured flavor was AUTO;
+ * - a claim size scaled by its per-thread speed, so slow cores take small bites and finish a round on time;
+ * - that speed as its weight in the pool's initial split of each job.
+ */
+internal object CpuPlacement {
+
+    data class Cluster(val cpuMask: Long, val cpus: Int, val capacity: Long, val maxKhz: Long)
+
+    /**
+     * [threads] workers pinned to [cluster], scanning with [flavor] (null = the job's) in claims of [chunkNonces]
+     * nonces; [weight] is their per-thread speed relative to the other groups.
+     */
+    data class Group(
+        val cluster: Cluster,
+        val threads: Int,
+        val flavor: CpuSha256Flavor?,
+        val chunkNonces: Long,
+        val weight: Long,
+    )
+
+    /** cpu_pool.h CPU_POOL_CHUNK. */
+    private const val DEFAULT_CHUNK = 1L shl 16
+    private const val MIN_CHUNK = NativeMiner.CPU_POOL_UNIT
+
+    private const val MAX_CLUSTERS = 8
+
+    fun topology(): List<Cluster> {
+        val out = LongArray(MAX_CLUSTERS * NativeMiner.CPU_TOPOLOGY_ROW)
+        val n = try {
+            NativeMiner.nativeCpuTopology(out)
+        } catch (_: UnsatisfiedLinkError) {
+            0
+        }
+        return (0 until n.coerceAtMost(MAX_CLUSTERS)).map { c ->
+            val o = c * NativeMiner.CPU_TOPOLOGY_ROW
+            Cluster(out[o], out[o + 1].toInt(), out[o + 2], out[o + 3])
+        }.filter { it.cpuMask != 0L && it.cpus > 0 }
+    }
+
+    /**
+     * Groups for [threads] workers mining with [flavor]; empty when there is nothing to place (a single cluster
+     * or unreadable topology), in which case the caller starts a plain unpinned pool. With [perClusterFlavor]
+     * each cluster's fastest self-tested flavor in [calibration] replaces [flavor] for its group.
+     */
+    fun plan(
+        threads: Int,
+        flavor: CpuSha256Flavor,
+        perClusterFlavor: Boolean,
+        calibration: List<CpuShaCalibration.Row>,
+        clusters: List<Cluster> = topology(),
+    ): List<Group> {
+        if (threads <= 0 || clusters.size < 2) return emptyList()
+        val used = mutableListOf<Pair<Cluster, Int>>()
+        var left = threads
+        for (c in clusters) {
+            if (left == 0) break
+            val n = minOf(c.cpus, left)
+            used += c to n
+            left -= n
+        }
+        // More threads than online CPUs (some went offline since the count was taken): the extras join the fastest.
+        if (left > 0) used[0] = used[0].first to used[0].second + left
+        val flavors = used.map { (c, _) -> if (perClusterFlavor) fastestFlavor(c, flavor, calibration) else null }
+        val speeds = used.mapIndexed { i, (c, _) ->
+            val f = flavors[i] ?: flavor
+            calibration.firstOrNull { it.cpuMask == c.cpuMask && it.flavor == f }?.hashesPerSec ?: 0L
+        }
+        // Calibrated H/s when every cluster has it, else the kernel's capacity, else max clock, else equal.
+        val weights = when {
+            speeds.all { it > 0L } -> speeds
+            used.all { it.first.capacity > 0L } -> used.map { it.first.capacity }
+            used.all { it.first.maxKhz > 0L } -> used.map { it.first.maxKhz }
+            else -> used.map { 1L }
+        }
+        val maxWeight = weights.max()
+        return used.mapIndexed { i, (c, n) ->
+            val chunk = (DEFAULT_CHUNK * weights[i] / maxWeight / MIN_CHUNK * MIN_CHUNK).coerceAtLeast(MIN_CHUNK)
+            Group(c, n, flavors[i], chunk, weights[i])
+        }
+    }
+
+    /** [cluster]'s fastest calibrated flavor when it differs from [flavor] and passes its self-test, else null. */
+    private fun fastestFlavor(
+        cluster: Cluster,
+        flavor: CpuSha256Flavor,
+        calibration: List<CpuShaCalibration.Row>,
+    ): CpuSha256Flavor? {
+        val best = calibration
+            .filter { it.cpuMask == cluster.cpuMask && CpuShaCapabilities.isSelectable(it.flavor) }
+            .maxByOrNull { it.hashesPerSec }
+            ?.flavor
+        if (best == null || best == flavor) return null
+        return best.takeIf { NativeMiner.nativeSelfTestCpuSha256Flavor(it.ordinal) }
+    }
+
+    fun describe(groups: List<Group>): String = groups.joinToString(", ") { g ->
+        "0x${g.cluster.cpuMask.toString(16)} x${g.threads} ${g.flavor?.name ?: "job"} chunk=${g.chunkNonces} weight=${g.weight}"
+    }
+}
@@ -0,0 +1,129 @@
+package com.btcminer.android.mining
+
+/**
+ * Native CPU worker pool (cpu_pool.c): the engine submits one job per round and the pool's pthreads split the
+ * nonce range between them, stealing chunks from each other so none idles before the round is done. Jobs go in
+ * and hits and counters come out through [channel]; the hashing threads never return to the JVM and the calls
+ * are @CriticalNative. On big.LITTLE SoCs [createGroups] pins one set of workers per core cluster
+ * ([CpuPlacement]). Not thread-safe: one owner thread submits and drains.
+ */
+internal class CpuWorkerPool private constructor(
+    private var handle: Long,
+    val channel: MinerChannel,
+    /** Placement the pool was created with; empty for one unpinned group. */
+    val groups: List<CpuPlacement.Group>,
+) : AutoCloseable {
+
+    private val groupScanned = LongArray(groups.size)
+    private val lastGroupScanned = LongArray(groupScanned.size)
+    private var lastGroupSampleMs = 0L
+
+    /**
+     * Prepares the job once and hands it to the pool, which keeps its own reference until the job is replaced or
+     * cancelled. @see NativeMiner.nativeCpuPoolSubmitJob
+     */
+    fun submit(tag: Long, header76: ByteArray, target: ByteArray, flavor: Int, nonceStart: Long, nonceEnd: Long): Int {
+        channel.setJob(header76, target)
+        val job = channel.prepareJob(flavor)
+        if (job == 0L) return CpuNonceScanResult.JNI_ARG_ERROR
+        val status = NativeMiner.nativeCpuPoolSubmitJob(handle, job, tag, nonceStart.toInt(), nonceEnd.toInt())
+        NativeMiner.nativeJobRelease(job)
+        return status
+    }
+
+    /**
+     * Template job: worker i mines extranonce2 [en2First] + i + k * [en2Stride] on its own ([workers] sequences).
+     * @see NativeMiner.nativeCpuPoolSubmitTemplate
+     */
+    fun submitTemplate(tag: Long, template: Long, flavor: Int, en2First: Long, en2Stride: Int): Int =
+        NativeMiner.nativeCpuPoolSubmitTemplate(handle, template, tag, flavor, en2First.toInt(), en2Stride)
+
+    /** Worker threads running; each owns one extranonce2 sequence of a template job. */
+    val workers: Int get() = NativeMiner.nativeCpuPoolWorkers(handle)
+
+    fun cancel() = NativeMiner.nativeCpuPoolCancel(handle)
+
+    /*
+     * extend, steal and remaining lock natively and may be called from any thread while the pool is open
+     * ([NonceScheduler] calls them from the gpu-worker thread).
+     */
+
+    /** Adds [range] (whole [NativeMiner.CPU_POOL_UNIT]s) to job [tag] while it is still current. @see NativeMiner.nativeCpuPoolExtend */
+    fun extend(tag: Long, range: LongRange): Boolean =
+        NativeMiner.nativeCpuPoolExtend(handle, tag, range.first.toInt(), range.last.toInt()) != 0
+
+    /** Upper half of job [tag]'s largest remaining run, if at least [minNonces]. @see NativeMiner.nativeCpuPoolSteal */
+    fun steal(tag: Long, minNonces: Long): LongRange? {
+        val packed = NativeMiner.nativeCpuPoolSteal(handle, tag, minNonces.coerceIn(0L, Int.MAX_VALUE.toLong()).toInt())
+        if (packed == -1L) return null
+        return (packed ushr 32)..(packed and 0xFFFFFFFFL)
+    }
+
+    /** Nonces of the current job no worker has claimed yet. */
+    fun remaining(): Long = NativeMiner.nativeCpuPoolRemaining(handle)
+
+    fun setPaceMs(ms: Long) = NativeMiner.nativeCpuPoolSetPace(handle, ms.coerceIn(0L, Int.MAX_VALUE.toLong()).toInt())
+
+    /**
+     * Moves up to [MinerChannel.MAX_HITS] hits and the counters since the previous drain into [channel]; returns the
+     * hit count (negative on a native argument error). Call again while it comes back full.
+     */
+    fun drain(): Int = NativeMiner.nativeCpuPoolDrainChannel(handle, channel.address)
+
+    /**
+     * Hashes/sec of each of [groups] since the previous sample (zeros on the first), or null for an ungrouped pool
+     * or when the previous sample is less than [minIntervalMs] old.
+     */
+    fun groupHashrates(nowMs: Long, minIntervalMs: Long): DoubleArray? {
+        if (groups.isEmpty() || handle == 0L) return null
+        val dtMs = nowMs - lastGroupSampleMs
+        if (lastGroupSampleMs != 0L && dtMs < minIntervalMs) return null
+        val n = NativeMiner.nativeCpuPoolGroupScanned(handle, groupScanned).coerceAtMost(groups.size)
+        val rates = DoubleArray(n) { g ->
+            if (lastGroupSampleMs == 0L || dtMs <= 0L) 0.0 else (groupScanned[g] - lastGroupScanned[g]) * 1000.0 / dtMs
+        }
+        groupScanned.copyInto(lastGroupScanned)
+        lastGroupSampleMs = nowMs
+        return rates
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            NativeMiner.nativeCpuPoolDestroy(handle)
+            handle = 0L
+        }
+    }
+
+    companion object {
+        /** Null when the library is missing or no worker thread could start. */
+        fun create(threads: Int, threadPriority: Int): CpuWorkerPool? {
+            val channel = MinerChannel.create() ?: return null
+            val h = try {
+                NativeMiner.nativeCpuPoolCreate(threads, threadPriority)
+            } catch (_: UnsatisfiedLinkError) {
+                0L
+            }
+            return if (h != 0L) CpuWorkerPool(h, channel, emptyList()) else null
+        }
+
+        /** One pinned set of workers per [groups] entry ([CpuPlacement.plan]); null as for [create]. */
+        fun createGroups(groups: List<CpuPlacement.Group>, threadPriority: Int): CpuWorkerPool? {
+            val channel = MinerChannel.create() ?: return null
+            val rows = LongArray(groups.size * NativeMiner.CPU_POOL_GROUP_ROW)
+            groups.forEachIndexed { i, g ->
+                val o = i * NativeMiner.CPU_POOL_GROUP_ROW
+                rows[o] = g.cluster.cpuMask
+                rows[o + 1] = g.threads.toLong()
+                rows[o + 2] = (g.flavor?.ordinal ?: NativeMiner.JOB_NO_FLAVOR).toLong()
+                rows[o + 3] = g.chunkNonces
+                rows[o + 4] = g.weight
+            }
+            val h = try {
+                NativeMiner.nativeCpuPoolCreateGroups(rows, threadPriority)
+            } catch (_: UnsatisfiedLinkError) {
+                0L
+            }
+            return if (h != 0L) CpuWorkerPool(h, channel, groups) else null
+        }
+    }
+}
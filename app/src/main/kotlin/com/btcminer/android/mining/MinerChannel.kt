@@ -0,0 +1,90 @@
+package com.btcminer.android.mining
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * One worker's shared-memory record with native code (miner_channel.h): a direct buffer registered once, holding
+ * the job inputs the worker writes and the result / telemetry native code writes back. Channel calls pass only
+ * [address] and primitives, so the mining path copies, pins and allocates nothing per call. Owned by one thread
+ * at a time; the buffer reference keeps [address] valid.
+ */
+internal class MinerChannel private constructor(private val buffer: ByteBuffer, val address: Long) {
+
+    /** Header and share target for the next scans or pool submit; once per round. */
+    fun setJob(header76: ByteArray, target: ByteArray) {
+        require(header76.size == HEADER76_SIZE && target.size == TARGET_SIZE) { "header76 / target size" }
+        buffer.clear()
+        buffer.put(header76)
+        buffer.put(target)
+    }
+
+    /**
+     * Prepared native job from the header and target last passed to [setJob], with the CPU kernel image for
+     * [flavor] ([NativeMiner.JOB_NO_FLAVOR] for a GPU-only job). The caller frees the handle with
+     * [NativeMiner.nativeJobRelease]; 0 when native memory ran out.
+     */
+    fun prepareJob(flavor: Int): Long = NativeMiner.nativeJobCreate(address, flavor)
+
+    val status: Int get() = buffer.getInt(STATUS)
+
+    /** GPU winning nonce, unsigned. */
+    val nonce: Long get() = buffer.getInt(NONCE).toLong() and 0xFFFFFFFFL
+
+    val busyWorkers: Int get() = buffer.getInt(BUSY)
+
+    val hitCount: Int get() = buffer.getInt(COUNT).coerceIn(0, MAX_HITS)
+
+    val dropped: Long get() = buffer.getInt(DROPPED).toLong() and 0xFFFFFFFFL
+
+    val scanned: Long get() = buffer.getLong(SCANNED)
+
+    val bestDifficulty: Double get() = buffer.getDouble(BEST_DIFFICULTY)
+
+    fun hitTag(i: Int): Long = buffer.getLong(HITS + i * HIT_SIZE)
+
+    fun hitNonce(i: Int): Long = buffer.getInt(HITS + i * HIT_SIZE + 8).toLong() and 0xFFFFFFFFL
+
+    /** Extranonce2 of the header hit [i] was found in (template jobs), unsigned. */
+    fun hitExtranonce2(i: Int): Long = buffer.getInt(HITS + i * HIT_SIZE + 12).toLong() and 0xFFFFFFFFL
+
+    /**
+     * Template [template]'s header for [extranonce2] and its target, written natively as [setJob] would write them;
+     * returns the header.
+     */
+    fun setTemplateJob(template: Long, extranonce2: Long): ByteArray {
+        NativeMiner.nativeTemplateHeader(template, extranonce2.toInt(), address)
+        val header76 = ByteArray(HEADER76_SIZE)
+        buffer.clear()
+        buffer.get(header76)
+        return header76
+    }
+
+    companion object {
+        // Offsets mirror miner_channel.h, which pins them with _Static_assert.
+        private const val HEADER76_SIZE = 76
+        private const val TARGET_SIZE = 32
+        private const val STATUS = 108
+        private const val NONCE = 112
+        private const val BUSY = 116
+        private const val COUNT = 120
+        private const val DROPPED = 124
+        private const val SCANNED = 128
+        private const val BEST_DIFFICULTY = 136
+        private const val HITS = 144
+        private const val HIT_SIZE = 16
+        const val MAX_HITS = 64
+        const val SIZE = HITS + MAX_HITS * HIT_SIZE
+
+        /** Null when the library is missing or the buffer cannot be registered. */
+        fun create(): MinerChannel? {
+            val buffer = ByteBuffer.allocateDirect(SIZE).order(ByteOrder.nativeOrder())
+            val address = try {
+                NativeMiner.nativeChannelAddress(buffer)
+            } catch (_: UnsatisfiedLinkError) {
+                0L
+            }
+            return if (address != 0L) MinerChannel(buffer, address) else null
+        }
+    }
+}
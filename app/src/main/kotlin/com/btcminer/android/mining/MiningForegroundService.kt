@@ -67,6 +67,8 @@ class MiningForegroundService : Service() {
                     ).show()
                 }
             },
+            resolveCpuSha256Flavor = configRepository::resolveCpuSha256Flavor,
+            cpuShaCalibrationRows = configRepository::storedCpuShaCalibrationRows,
             onSessionBestDifficultyRecord = { recordedAtMs, difficulty ->
                 handler.post {
                     val start = miningStartTimeMillis ?: return@post
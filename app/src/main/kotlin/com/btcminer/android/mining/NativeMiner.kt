@@ -1,27 +1,22 @@
 package com.btcminer.android.mining
 
+import dalvik.annotation.optimization.CriticalNative
+import java.nio.ByteBuffer
+
 /**
- * Outcome of a CPU nonce scan ([nativeScanNoncesInto]). Status values match CPU JNI in [miner.c] only.
+ * Status codes of the CPU JNI calls (the `CPU_JNI_STATUS_*` values in [miner.c]): [CpuWorkerPool] and
+ * [MinerChannel] results, and the [NativeMiner.nativeCalibrateCpuSha256] header.
  */
-data class CpuNonceScanResult(val status: Int, val nonceU32: Long) {
-    val isHit: Boolean get() = status == HIT
-
-    companion object {
-        const val MISS = 0
-        const val HIT = 1
-        const val INTERRUPTED = -3
-        const val FLAVOR_ERROR = -4
-        const val JNI_ARG_ERROR = -5
-
-        fun fromJniOut(out: LongArray): CpuNonceScanResult {
-            require(out.size >= 2) { "CPU scan JNI out[] length >= 2" }
-            return CpuNonceScanResult(out[0].toInt(), out[1])
-        }
-    }
+object CpuNonceScanResult {
+    const val MISS = 0
+    const val HIT = 1
+    const val INTERRUPTED = -3
+    const val FLAVOR_ERROR = -4
+    const val JNI_ARG_ERROR = -5
 }
 
 /**
- * Outcome of a GPU nonce scan ([gpuScanNoncesInto]). Status values match GPU JNI in [vulkan_miner.c] only.
+ * Outcome of a GPU nonce scan ([NativeMiner.gpuScanJob]). Status values match GPU JNI in [vulkan_miner.c] only.
  */
 data class GpuNonceScanResult(val status: Int, val nonceU32: Long) {
     val isHit: Boolean get() = status == HIT
@@ -30,11 +25,6 @@ data class GpuNonceScanResult(val status: Int, val nonceU32: Long) {
         const val MISS = 0
         const val HIT = 1
         const val UNAVAILABLE = -2
-
-        fun fromJniOut(out: LongArray): GpuNonceScanResult {
-            require(out.size >= 2) { "GPU scan JNI out[] length >= 2" }
-            return GpuNonceScanResult(out[0].toInt(), out[1])
-        }
     }
 }
 
@@ -53,6 +43,9 @@ object NativeMiner {
      */
     external fun nativeVersion(): String
 
+    /** sha256_calibrate.h CPU_SHA_KERNELS_VERSION: changes whenever a CPU kernel or flavor does. */
+    external fun nativeKernelsVersion(): Int
+
     /**
      * Runs a known SHA-256 test vector (NIST "abc"). Returns true if the implementation is correct.
      */
@@ -63,9 +56,37 @@ object NativeMiner {
      */
     external fun nativeHashBlockHeader(header: ByteArray): ByteArray?
 
+    /**
+     * Share target (32 bytes, big-endian) for pool [difficulty]: difficulty-1 target / [difficulty], floored,
+     * clamped to all 0xFF when easier than 2^256 - 1. Native counterpart of
+     * [StratumHeaderBuilder.buildTargetFromDifficulty] without BigDecimal.
+     */
+    external fun nativeTargetFromDifficulty(difficulty: Double): ByteArray?
+
+    /** Difficulty a 32-byte big-endian share target stands for; 0.0 if [target] is not 32 bytes. */
+    external fun nativeDifficultyFromTarget(target: ByteArray): Double
+
+    /**
+     * Share difficulty of an 80-byte header (double SHA-256, truediffone / hash); 0.0 if the length is wrong.
+     * Native counterpart of [StratumHeaderBuilder.difficultyFromHeader80].
+     */
+    external fun nativeShareDifficulty(header80: ByteArray): Double
+
     /** True when AArch64 reports SHA256 hardware support (AT_HWCAP HWCAP_SHA2). */
     external fun nativeHwcapSha2(): Boolean
 
+    /** True when x86_64 CPUID reports the SHA extensions (plus the SSSE3/SSE4.1 the SHA-NI kernels use). */
+    external fun nativeCpuidShaNi(): Boolean
+
+    /** True when x86_64 CPUID reports SSSE3 and SSE4.1 (the SSE4 4-way kernels). */
+    external fun nativeCpuidSse41(): Boolean
+
+    /** True when x86_64 CPUID reports AVX2 and the OS saves YMM state (XGETBV). */
+    external fun nativeCpuidAvx2(): Boolean
+
+    /** True when x86_64 CPUID reports AVX-512F/BW and the OS saves ZMM state (XGETBV). */
+    external fun nativeCpuidAvx512(): Boolean
+
     /** Verify double-SHA256 for [flavor] against scalar reference on fixed test vectors. */
     external fun nativeSelfTestCpuSha256Flavor(flavor: Int): Boolean
 
@@ -76,36 +97,205 @@ object NativeMiner {
     external fun gpuShaVulkanSelftest(useMidstate: Int): Boolean
 
     /**
-     * CPU nonce scan: writes [CpuNonceScanResult] wire format into [out] — `out[0]` = status, `out[1]` = winning
-     * nonce as [Long] in `0..0xFFFFFFFFL` when status is [CpuNonceScanResult.HIT].
-     * @param flavor [com.btcminer.android.config.CpuSha256Flavor.ordinal], 0..5.
+     * Starts the native CPU worker pool ([CpuWorkerPool]): [threads] pthreads at nice value [nice] (an
+     * [android.os.Process] thread priority). Returns a handle for the other `nativeCpuPool*` calls, 0 on failure.
+     */
+    external fun nativeCpuPoolCreate(threads: Int, nice: Int): Long
+
+    /**
+     * Like [nativeCpuPoolCreate] with one set of workers per group ([CpuPlacement]): [groups] holds rows of
+     * [CPU_POOL_GROUP_ROW] longs: CPU mask to pin to (0 = unpinned), threads, flavor ordinal ([JOB_NO_FLAVOR] =
+     * the submitted job's), nonces per claim (0 = default) and per-thread weight (e.g. calibrated H/s).
+     * At most 8 groups; 0 on failure.
+     */
+    external fun nativeCpuPoolCreateGroups(groups: LongArray, nice: Int): Long
+
+    /** Cumulative nonces hashed by each group of [handle] into [out]; returns the group count. */
+    external fun nativeCpuPoolGroupScanned(handle: Long, out: LongArray): Int
+
+    /**
+     * Online core clusters, fastest first, as rows of [CPU_TOPOLOGY_ROW] longs: CPU mask, CPU count, capacity
+     * (cpu_capacity, 0 when the kernel has none) and max kHz. Returns the cluster count (rows beyond [out] are
+     * dropped); 0 when sysfs is unreadable.
      */
-    external fun nativeScanNoncesInto(
-        header76: ByteArray,
+    external fun nativeCpuTopology(out: LongArray): Int
+
+    /** Cancels the current job, joins the workers and frees [handle]. */
+    external fun nativeCpuPoolDestroy(handle: Long)
+
+    /**
+     * Address of [channel] for the channel calls below ([MinerChannel]): a direct buffer of at least
+     * [MinerChannel.SIZE] bytes. 0 when it is not direct, too small or misaligned. Valid while the buffer is
+     * reachable; called once per channel.
+     */
+    external fun nativeChannelAddress(channel: ByteBuffer): Long
+
+    /**
+     * Header template (miner_template.h) for one Stratum job: the header and target in [channel]
+     * ([MinerChannel.setJob]; its merkle root is ignored), [coinbase1] = coinb1 || extranonce1, an [en2Size]-byte
+     * extranonce2, [coinbase2] = coinb2 and the merkle [branches] concatenated (32 bytes each). Headers for any
+     * extranonce2 then come from [nativeTemplateHeader] or the pool's own workers
+     * ([nativeCpuPoolSubmitTemplate]). The handle holds one reference, freed with [nativeTemplateRelease]; 0 on a
+     * bad size or when native memory ran out.
+     */
+    external fun nativeTemplateCreate(
+        channel: Long,
+        coinbase1: ByteArray,
+        en2Size: Int,
+        coinbase2: ByteArray,
+        branches: ByteArray,
+    ): Long
+
+    /*
+     * @CriticalNative calls: primitives only, bound by RegisterNatives in JNI_OnLoad (miner.c). Each returns in
+     * microseconds, so skipping the thread-state transition never holds up GC.
+     */
+
+    /**
+     * Prepares a job (miner_job.h) from the header and target in [channel] ([MinerChannel.setJob]): midstate,
+     * target words, the CPU kernel image for [flavor] ([JOB_NO_FLAVOR] for none) and the GPU uniform image. The
+     * returned handle holds one reference, freed with [nativeJobRelease]; 0 when native memory ran out.
+     */
+    @JvmStatic
+    @CriticalNative
+    external fun nativeJobCreate(channel: Long, flavor: Int): Long
+
+    /** Drops the caller's reference to [job]; scans still using it keep their own. */
+    @JvmStatic
+    @CriticalNative
+    external fun nativeJobRelease(job: Long)
+
+    /**
+     * Replaces the pool's job: nonces [nonceStart]..[nonceEnd] (unsigned) of [job] ([nativeJobCreate], scanned
+     * with the flavor it was prepared for), hits tagged with [tag]. The pool takes its own reference. Returns 0,
+     * [CpuNonceScanResult.FLAVOR_ERROR] or [CpuNonceScanResult.JNI_ARG_ERROR].
+     */
+    @JvmStatic
+    @CriticalNative
+    external fun nativeCpuPoolSubmitJob(
+        handle: Long,
+        job: Long,
+        tag: Long,
         nonceStart: Int,
         nonceEnd: Int,
-        target: ByteArray,
+    ): Int
+
+    /** Drops the rest of the current job; every worker stops within 64 nonces. */
+    @JvmStatic
+    @CriticalNative
+    external fun nativeCpuPoolCancel(handle: Long)
+
+    /** Per-worker sleep after every 2M nonces (intensity and thermal throttle); 0 = none. */
+    @JvmStatic
+    @CriticalNative
+    external fun nativeCpuPoolSetPace(handle: Long, paceMs: Int)
+
+    /**
+     * Moves queued hits (up to [MinerChannel.MAX_HITS]; the rest stay queued) and the counters since the previous
+     * drain into [channel]. Returns the hit count, or [CpuNonceScanResult.JNI_ARG_ERROR].
+     */
+    @JvmStatic
+    @CriticalNative
+    external fun nativeCpuPoolDrainChannel(handle: Long, channel: Long): Int
+
+    /**
+     * Adds nonces [nonceStart]..[nonceEnd] (unsigned, multiples of [CPU_POOL_UNIT] outside the submitted range) to
+     * the pool's job while it is still [tag]; workers that had finished it pick them up. 1 when added, else 0.
+     */
+    @JvmStatic
+    @CriticalNative
+    external fun nativeCpuPoolExtend(handle: Long, tag: Long, nonceStart: Int, nonceEnd: Int): Int
+
+    /**
+     * Takes the upper half of the largest range the pool has left of job [tag], for another device: start in the
+     * high 32 bits, end in the low 32 (unsigned), or -1 when that half would be under [minNonces].
+     */
+    @JvmStatic
+    @CriticalNative
+    external fun nativeCpuPoolSteal(handle: Long, tag: Long, minNonces: Int): Long
+
+    /** Nonces of the pool's current job not yet claimed by a worker. */
+    @JvmStatic
+    @CriticalNative
+    external fun nativeCpuPoolRemaining(handle: Long): Long
+
+    /** Drops the caller's reference to [template]; pool jobs built from it keep their own. */
+    @JvmStatic
+    @CriticalNative
+    external fun nativeTemplateRelease(template: Long)
+
+    /**
+     * Writes [template]'s header for [extranonce2] (unsigned; big-endian in the job's extranonce2 bytes, as
+     * [StratumHeaderBuilder] encodes it) and its target into [channel]'s job inputs, ready for
+     * [nativeJobCreate].
+     */
+    @JvmStatic
+    @CriticalNative
+    external fun nativeTemplateHeader(template: Long, extranonce2: Int, channel: Long)
+
+    /**
+     * Replaces the pool's job with a template job: worker i mines the headers for extranonce2 [en2First] + i,
+     * then + [en2Stride] each time it has scanned a header's whole nonce space, without waiting for the others.
+     * [en2Stride] must be at least [nativeCpuPoolWorkers]; the values in between are free for the GPU. Hits
+     * carry their header's extranonce2 ([MinerChannel.hitExtranonce2]). The pool takes its own reference to
+     * [template]. Returns 0, [CpuNonceScanResult.FLAVOR_ERROR] or [CpuNonceScanResult.JNI_ARG_ERROR].
+     */
+    @JvmStatic
+    @CriticalNative
+    external fun nativeCpuPoolSubmitTemplate(
+        handle: Long,
+        template: Long,
+        tag: Long,
         flavor: Int,
-        out: LongArray,
-    )
+        en2First: Int,
+        en2Stride: Int,
+    ): Int
+
+    /** Worker threads the pool started. */
+    @JvmStatic
+    @CriticalNative
+    external fun nativeCpuPoolWorkers(handle: Long): Int
+
+    /**
+     * Times every CPU SHA flavor that passes its self-test on each CPU cluster for [msPerFlavor] ms (the
+     * calling thread is pinned per cluster, then restored). `out[0]` = winning flavor ordinal (-1 none,
+     * [CpuNonceScanResult.INTERRUPTED] when interrupted), `out[1]` = row count, then rows of
+     * [CPU_CALIBRATION_ROW] longs: cluster index, cluster CPU mask, flavor ordinal, hashes/sec.
+     * Rows beyond the array are dropped. See [com.btcminer.android.config.CpuShaCalibration].
+     */
+    external fun nativeCalibrateCpuSha256(msPerFlavor: Int, out: LongArray)
+
+    const val CPU_CALIBRATION_HEADER = 2
+    const val CPU_CALIBRATION_ROW = 4
+    const val CPU_TOPOLOGY_ROW = 4
+    const val CPU_POOL_GROUP_ROW = 5
+
+    /** cpu_pool.h CPU_POOL_UNIT: ranges added to or stolen from a pool job are whole units. */
+    const val CPU_POOL_UNIT = 1L shl 14
 
     /** @see CpuNonceScanResult.FLAVOR_ERROR */
     const val CPU_SHA_FLAVOR_ERROR = -4
 
+    /** [nativeJobCreate] flavor for a GPU-only job (no CPU kernel image). */
+    const val JOB_NO_FLAVOR = -1
+
     /**
-     * Requests the GPU worker to interrupt. When set, [gpuScanNoncesInto] reports unavailable on the next
+     * Requests the GPU worker to interrupt. When set, [gpuScanJob] reports unavailable on the next
      * vkWaitForFences timeout (within ~1s). Used by the stuck-worker watchdog.
      */
     external fun gpuRequestInterrupt(): Unit
 
     /**
-     * Requests CPU workers to interrupt. When set, [nativeScanNoncesInto] reports interrupted on its next
-     * 64k-iteration check. Used by the stuck-worker watchdog.
+     * Ends every CPU scan in flight: bumps the native job epoch, so the [CpuWorkerPool] job running now stops
+     * within 64 nonces, on every thread at once. Scans started afterwards are unaffected. Used on clean_jobs, overheat and by the
+     * stuck-worker watchdog.
      */
-    external fun cpuRequestInterrupt(): Unit
+    @JvmStatic
+    @CriticalNative
+    external fun cpuRequestInterrupt()
 
     /**
-     * Whether Vulkan is available for GPU compute. When true, [gpuScanNoncesInto] can be used.
+     * Whether Vulkan is available for GPU compute. When true, [gpuScanJob] can be used.
      */
     external fun gpuIsAvailable(): Boolean
 
@@ -117,24 +307,25 @@ object NativeMiner {
 
     /**
      * True only when the Vulkan compute pipeline for the given [gpuCores] can be created
-     * (SPIR-V present and pipeline creation succeeds). When false, [gpuScanNoncesInto] would report unavailable;
+     * (SPIR-V present and pipeline creation succeeds). When false, [gpuScanJob] would report unavailable;
      * use this to fail fast at mining start instead of on first chunk.
      * @param gpuSha256Mode [com.btcminer.android.config.GpuSha256Mode.ordinal].
      */
     external fun gpuPipelineReady(gpuCores: Int, gpuSha256Mode: Int): Boolean
 
     /**
-     * GPU nonce scan: writes [GpuNonceScanResult] wire format into [out] — `out[0]` = status, `out[1]` = winning
-     * nonce as [Long] in `0..0xFFFFFFFFL` when status is [GpuNonceScanResult.HIT] (including `0xFFFFFFFFL` as a valid hit).
+     * GPU nonce scan of [nonceStart]..[nonceEnd] (unsigned) of [job] ([nativeJobCreate]; the caller keeps it alive
+     * for the call). Returns the [GpuNonceScanResult] status and leaves it, the winning nonce (status
+     * [GpuNonceScanResult.HIT], `0xFFFFFFFF` included) and the nonces scanned in [channel]. Blocks for the
+     * whole dispatch, so it is a plain JNI call rather than @CriticalNative.
      * @param gpuSha256Mode [com.btcminer.android.config.GpuSha256Mode.ordinal].
      */
-    external fun gpuScanNoncesInto(
-        header76: ByteArray,
+    external fun gpuScanJob(
+        job: Long,
+        channel: Long,
         nonceStart: Int,
         nonceEnd: Int,
-        target: ByteArray,
         gpuCores: Int,
         gpuSha256Mode: Int,
-        out: LongArray,
-    )
+    ): Int
 }
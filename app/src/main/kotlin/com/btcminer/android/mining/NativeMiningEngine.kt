@@ -2,6 +2,8 @@ package com.btcminer.android.mining
 
 import android.os.Process
 import com.btcminer.android.AppLog
+import com.btcminer.android.config.CpuSha256Flavor
+import com.btcminer.android.config.CpuShaCalibration
 import com.btcminer.android.config.GpuSha256Mode
 import com.btcminer.android.config.MiningConfig
 import com.btcminer.android.network.StratumPinCapture
@@ -18,6 +20,7 @@ import java.util.concurrent.TimeoutException
 import java.util.concurrent.atomic.AtomicBoolean
 import java.util.concurrent.atomic.AtomicLong
 import java.util.concurrent.atomic.AtomicReference
+import java.util.concurrent.locks.LockSupport
 
 /**
  * Mining engine using native hashing (Phase 2) and Kotlin Stratum client (Phase 3).
@@ -35,6 +38,10 @@ class NativeMiningEngine(
     private val onGpuUnavailable: (() -> Unit)? = null,
     /** Invoked on miner thread when session best share difficulty strictly increases. */
     private val onSessionBestDifficultyRecord: ((recordedAtMs: Long, difficulty: Double) -> Unit)? = null,
+    /** Maps [CpuSha256Flavor.AUTO] to a concrete flavor; may block to calibrate (start() runs off the main thread). */
+    private val resolveCpuSha256Flavor: (CpuSha256Flavor) -> CpuSha256Flavor = { it },
+    /** Stored per-cluster calibration timings for this device ([CpuPlacement]); empty when none. */
+    private val cpuShaCalibrationRows: () -> List<CpuShaCalibration.Row> = { emptyList() },
 ) : MiningEngine {
 
     companion object {
@@ -48,14 +55,27 @@ class NativeMiningEngine(
         const val BOTH_HASHERS_DISABLED_LAST_ERROR = "BOTH_HASHERS_DISABLED"
         /** CPU cores = 0 and GPU not usable (pipeline/init failed). */
         const val NO_HASHING_BACKEND_LAST_ERROR = "NO_HASHING_BACKEND"
+        /** Nonces per GPU dispatch batch. */
         private const val CHUNK_SIZE = 2L * 1024 * 1024
-        private const val MAX_NONCE = 0xFFFFFFFFL
-        /** CPU nonce range end; GPU uses CPU_NONCE_END to MAX_NONCE. */
-        private const val CPU_NONCE_END = MAX_NONCE / 2
+        /** Smallest tail the GPU steals from the CPU pool; less finishes sooner on the CPU than a dispatch costs. */
+        private const val GPU_MIN_STEAL = CHUNK_SIZE / 4
+        /** Margin (ms) past the pool's estimated finish before checking for it, covering claims still in flight. */
+        private const val CPU_DRY_SLACK_MS = 20L
+        /**
+         * Extranonce2 values reserved per [TemplateRound]: every CPU worker and the GPU walk their own sequences
+         * inside it, at 2^32 nonces per value, so no device gets near its end before the job changes.
+         */
+        private const val TEMPLATE_EN2_WINDOW = 1L shl 20
+        /** miner_template.h MINER_TEMPLATE_MAX_EN2. */
+        private const val TEMPLATE_MAX_EN2_SIZE = 8
+        /** Recent CPU rounds whose hits can still be drained (a cancelled round's last chunk may hit late). */
+        private const val CPU_ROUND_CONTEXTS = 4
         /** Minimum elapsed time (seconds) used as divisor for hashrate. Avoids a huge spike when "Start Mining" is clicked: dividing by a tiny elapsed time would show an inflated rate until the denominator grows. */
         private const val MIN_ELAPSED_SEC_FOR_HASHRATE = 1.0
         /** Rolling window (seconds) for hashrate display; configurable constant. */
         private const val ROLLING_WINDOW_SEC = 60
+        /** Minimum window (ms) for the per-cluster CPU hashrate in the stats log. */
+        private const val CPU_CLUSTER_RATE_INTERVAL_MS = 5_000L
 
         /** Fixed intensity sleep (ms per chunk). 0% = 10 min, 100% = 0. */
         private fun fixedIntensitySleepMs(intensityPercent: Int): Long =
@@ -86,7 +106,10 @@ class NativeMiningEngine(
     private val totalNoncesScanned = AtomicLong(0)
     private val bestDifficultyRef = AtomicReference(0.0)
     private val blockTemplatesCount = AtomicLong(0)
-    /** Max share difficulty observed in the current mining session (panel #1); not persisted as lifetime. */
+    /**
+     * Max difficulty observed in the current mining session (panel #1): found shares plus the best hash of every
+     * CPU scan, share or not. Not persisted as lifetime.
+     */
     private val sessionBestShareDifficultyRef = AtomicReference(0.0)
     private val gpuNoncesScanned = AtomicLong(0)
     private val gpuUnavailable = AtomicBoolean(false)
@@ -98,16 +121,47 @@ class NativeMiningEngine(
     @Volatile
     private var gpuRetryThread: Thread? = null
 
+    /** Round both backends mine ([nextRound]); its nonce space is split between them by [NonceScheduler]. */
+    @Volatile
+    private var sharedRound: SharedRound? = null
+    private val sharedRoundLock = Any()
+    /** Job both backends mine in per-worker extranonce2 mode ([nextTemplateRound]); guarded like [sharedRound]. */
+    @Volatile
+    private var sharedTemplate: TemplateRound? = null
+    /** Rolling CPU and GPU hashrates, for splitting new rounds. */
+    @Volatile
+    private var cpuRateHs = 0.0
+    @Volatile
+    private var gpuRateHs = 0.0
+
     /** Shared: when clean_jobs, set to null so both CPU and GPU workers exit. */
     private val activeJobId = AtomicReference<String?>(null)
     /** Found shares from CPU or GPU workers; coordinator drains and submits. */
     private val foundSharesQueue: BlockingQueue<FoundResult> = LinkedBlockingQueue()
     @Volatile
     private var cpuSupervisorThread: Thread? = null
+    /** CPU pool job tags and their rounds; only touched on the cpu-supervisor thread. */
+    private var cpuRoundTag = 0L
+    private val cpuRoundContexts = object : LinkedHashMap<Long, RoundContext>() {
+        override fun removeEldestEntry(eldest: MutableMap.MutableEntry<Long, RoundContext>?): Boolean =
+            size > CPU_ROUND_CONTEXTS
+    }
+    /** Same for template jobs, whose hits each carry their own extranonce2. */
+    private val cpuTemplateRounds = object : LinkedHashMap<Long, TemplateRound>() {
+        override fun removeEldestEntry(eldest: MutableMap.MutableEntry<Long, TemplateRound>?): Boolean =
+            size > CPU_ROUND_CONTEXTS
+    }
     @Volatile
     private var gpuSupervisorThread: Thread? = null
+    /** Job / result channel of the gpu-worker thread, the only thread that touches it. */
+    private val gpuChannel: MinerChannel? by lazy { MinerChannel.create() }
 
     private val lastCpuIntensityDelayMs = AtomicLong(0L)
+    /** True when this start resolved [CpuSha256Flavor.AUTO], so clusters may pick their own flavor. */
+    @Volatile
+    private var cpuFlavorAuto = false
+    /** Per-cluster CPU hashrate for the stats log; empty with an ungrouped pool. */
+    private val cpuClusterSummary = AtomicReference("")
     private val lastGpuIntensityDelayMs = AtomicLong(0L)
 
     /** Samples (timestampMs, cpuNonces, gpuNonces) for rolling-window hashrate. Cleared when mining loop starts. */
@@ -132,6 +186,16 @@ class NativeMiningEngine(
         }
     }
 
+    /** Folds [diff] into the lifetime and session bests; a new session best is reported to [onSessionBestDifficultyRecord]. */
+    private fun recordBestDifficulty(diff: Double) {
+        bestDifficultyRef.updateAndGet { maxOf(it, diff) }
+        val prevSessionBest = sessionBestShareDifficultyRef.get()
+        val newSessionBest = sessionBestShareDifficultyRef.updateAndGet { maxOf(it, diff) }
+        if (newSessionBest > prevSessionBest) {
+            onSessionBestDifficultyRecord?.invoke(System.currentTimeMillis(), newSessionBest)
+        }
+    }
+
     private fun shareSourceFromFoundTag(tag: String): StratumOutboundSubmitSource? = when (tag.lowercase(Locale.US)) {
         "cpu" -> StratumOutboundSubmitSource.Cpu
         "gpu" -> StratumOutboundSubmitSource.Gpu
@@ -163,7 +227,16 @@ class NativeMiningEngine(
             return
         }
 
-        val flavor = config.cpuSha256Flavor
+        // AUTO is resolved here, once per start, so the scan loop only ever sees a concrete flavor.
+        cpuFlavorAuto = config.cpuSha256Flavor == CpuSha256Flavor.AUTO
+        val miningConfig = if (config.maxWorkerThreads > 0 && config.cpuSha256Flavor == CpuSha256Flavor.AUTO) {
+            val resolved = resolveCpuSha256Flavor(CpuSha256Flavor.AUTO)
+            AppLog.d(LOG_TAG) { "CPU SHA-256 flavor AUTO resolved to ${resolved.name}" }
+            config.copy(cpuSha256Flavor = resolved)
+        } else {
+            config
+        }
+        val flavor = miningConfig.cpuSha256Flavor
         if (config.maxWorkerThreads > 0) {
             if (!NativeMiner.nativeSelfTestCpuSha256Flavor(flavor.ordinal)) {
                 AppLog.e(LOG_TAG) { "CPU SHA-256 self-test failed for flavor=${flavor.name}" }
@@ -212,6 +285,7 @@ class NativeMiningEngine(
         val client = StratumClient(host, port, username, password, useTls = useTls, stratumPin = stratumPin,
             onReconnectRequest = { h, p -> onPoolRedirectRequested?.invoke(h, p) },
             onTemplateReceived = { blockTemplatesCount.incrementAndGet() },
+            onCleanJobs = { onCleanJobsNotify() },
             onConnectionLost = null,
             threadPriority = config.miningThreadPriority)
         val err = client.connect()
@@ -245,7 +319,7 @@ class NativeMiningEngine(
         val minerThread = Thread {
             Process.setThreadPriority(config.miningThreadPriority)
             try {
-                runMiningLoop(client, config)
+                runMiningLoop(client, miningConfig)
             } catch (_: InterruptedException) { }
             finally {
                 client.disconnect()
@@ -395,65 +469,327 @@ class NativeMiningEngine(
         val isOfflineRound: Boolean,
     )
 
+    /** One header mined by both backends: [nonces] hands out its nonce space. */
+    private class SharedRound(val ctx: RoundContext, val nonces: NonceScheduler)
+
+    /**
+     * One job mined with per-worker extranonce2 ([MiningConfig.perWorkerExtranonce2]): CPU pool worker i owns
+     * extranonce2 [en2First] + i + k * [en2Stride] and the GPU [en2First] + [gpuIndex] + k * [en2Stride]. Each builds
+     * its next header as soon as it has scanned the last one's nonce space, so neither ever waits at a round boundary
+     * or shares a nonce counter; the job ends only when the pool replaces it.
+     */
+    private class TemplateRound(
+        val job: StratumJob,
+        val en1Hex: String,
+        val en2Size: Int,
+        val target: ByteArray,
+        val en2First: Long,
+        val en2Stride: Int,
+        val gpuIndex: Int,
+        val isOfflineRound: Boolean,
+    ) {
+        fun extranonce2Hex(en2: Long): String = String.format("%0${en2Size * 2}x", en2 and 0xFFFFFFFFL)
+
+        /** Header for [en2], built on the JVM (for hits; the miners build theirs natively). */
+        fun header76(en2: Long): ByteArray = StratumHeaderBuilder.buildHeader76(
+            job,
+            StratumHeaderBuilder.buildMerkleRoot(job.coinb1Hex, job.coinb2Hex, en1Hex, extranonce2Hex(en2), job.merkleBranchHex),
+        )
+
+        /**
+         * Native header template for this job, set up through [channel] (its job inputs are overwritten); freed with
+         * [NativeMiner.nativeTemplateRelease]. 0 when native memory ran out.
+         */
+        fun createNative(channel: MinerChannel): Long {
+            channel.setJob(StratumHeaderBuilder.buildHeader76(job, ByteArray(32)), target)
+            val branches = job.merkleBranchHex.fold(ByteArray(0)) { acc, b -> acc + StratumHeaderBuilder.hexToBytes(b) }
+            return NativeMiner.nativeTemplateCreate(
+                channel.address,
+                StratumHeaderBuilder.hexToBytes(job.coinb1Hex) + StratumHeaderBuilder.hexToBytes(en1Hex),
+                en2Size,
+                StratumHeaderBuilder.hexToBytes(job.coinb2Hex),
+                branches,
+            )
+        }
+    }
+
+    /**
+     * The CPU's part of [round] on [pool]: submits its range, then drains hits and counters every status interval.
+     * When the pool runs dry it takes a share of the GPU's unclaimed range into the same job, until there is none
+     * left, the job goes stale, or mining stops. [onCleanJobsNotify] unparks the wait, so a clean_jobs notify is
+     * handled at once rather than at the end of the interval.
+     */
     private fun runCpuRound(
         client: StratumClient,
         config: MiningConfig,
-        ctx: RoundContext,
-        threadCount: Int,
+        pool: CpuWorkerPool,
+        round: SharedRound,
+        statusUpdateIntervalMs: Int,
+    ) {
+        val ctx = round.ctx
+        val range = round.nonces.claimCpu() ?: return
+        val tag = ++cpuRoundTag
+        cpuRoundContexts[tag] = ctx
+        updateCpuPace(pool, config)
+        val submitStatus = pool.submit(tag, ctx.header76, ctx.target, config.cpuSha256Flavor.ordinal, range.first, range.last)
+        if (submitStatus != 0) {
+            AppLog.e(LOG_TAG) { "CPU pool submit failed (status=$submitStatus, flavor=${config.cpuSha256Flavor.name})" }
+            Thread.sleep(statusUpdateIntervalMs.toLong())
+            return
+        }
+        round.nonces.attachCpu(pool, tag)
+        try {
+            cpuRoundLoop(client, config, pool, round, tag, statusUpdateIntervalMs)
+        } finally {
+            round.nonces.detachCpu()
+        }
+        pool.cancel()
+        drainCpuPool(pool)
+    }
+
+    private fun cpuRoundLoop(
+        client: StratumClient,
+        config: MiningConfig,
+        pool: CpuWorkerPool,
+        round: SharedRound,
+        tag: Long,
         statusUpdateIntervalMs: Int,
     ) {
+        val ctx = round.ctx
         val job = ctx.job
-        activeJobId.set(job.jobId)
-        val nextChunkStart = AtomicLong(0)
         val roundStartTimeMs = System.currentTimeMillis()
+        while (running.get() && activeJobId.get() == job.jobId) {
+            // Checks follow the wait: a clean_jobs unpark must consume its flag before the drain sees an idle pool.
+            LockSupport.parkNanos(TimeUnit.MILLISECONDS.toNanos(cpuWaitMs(pool, statusUpdateIntervalMs)))
+            if (Thread.currentThread().isInterrupted) break
+            if (throttleStateRef?.get()?.stopDueToOverheat == true) break
+            if (!ctx.isOfflineRound && !client.isConnected()) {
+                AppLog.d(LOG_TAG) { "Connection lost during CPU mining, breaking out to try reconnect" }
+                activeJobId.set(null)
+                break
+            }
+            if (client.isConnected() && client.consumeCleanJobsInvalidation()) {
+                AppLog.d(LOG_TAG) { "Job changed (clean_jobs), switching to new template" }
+                activeJobId.set(null)
+                break
+            }
+            updateCpuPace(pool, config)
+            if (drainCpuPool(pool) == 0) {
+                // Ran dry: take the GPU's tail into the same job; without one the round is done for the CPU.
+                val tail = round.nonces.takeGpuTail() ?: break
+                if (!pool.extend(tag, tail)) {
+                    AppLog.e(LOG_TAG) { "CPU pool refused the GPU tail ${tail.first}..${tail.last}" }
+                    break
+                }
+                continue
+            }
+            val elapsed = System.currentTimeMillis() - roundStartTimeMs
+            if (elapsed >= MiningConstants.ROUND_STUCK_TIMEOUT_MS) {
+                AppLog.d(LOG_TAG) { "CPU round stuck (${elapsed / 1000}s), cancelling the pool job" }
+                activeJobId.set(null)
+                break
+            }
+        }
+    }
+
+    /**
+     * The CPU's part of template [round] on [pool]: every worker mines its own extranonce2 sequence until the pool
+     * sends another job (clean or not), the workers stop, or mining stops; meanwhile this thread only drains.
+     */
+    private fun runCpuTemplateRound(
+        client: StratumClient,
+        config: MiningConfig,
+        pool: CpuWorkerPool,
+        round: TemplateRound,
+        statusUpdateIntervalMs: Int,
+    ) {
+        val job = round.job
+        val template = round.createNative(pool.channel)
+        if (template == 0L) {
+            AppLog.e(LOG_TAG) { "CPU header template failed (extranonce2 size ${round.en2Size})" }
+            Thread.sleep(statusUpdateIntervalMs.toLong())
+            return
+        }
+        val tag = ++cpuRoundTag
+        cpuTemplateRounds[tag] = round
+        updateCpuPace(pool, config)
+        val submitStatus = try {
+            pool.submitTemplate(tag, template, config.cpuSha256Flavor.ordinal, round.en2First, round.en2Stride)
+        } finally {
+            NativeMiner.nativeTemplateRelease(template)
+        }
+        if (submitStatus != 0) {
+            AppLog.e(LOG_TAG) { "CPU pool template submit failed (status=$submitStatus, flavor=${config.cpuSha256Flavor.name})" }
+            Thread.sleep(statusUpdateIntervalMs.toLong())
+            return
+        }
+        val roundStartTimeMs = System.currentTimeMillis()
+        while (running.get() && activeJobId.get() == job.jobId && client.getCurrentJob() === job) {
+            LockSupport.parkNanos(TimeUnit.MILLISECONDS.toNanos(statusUpdateIntervalMs.toLong()))
+            if (Thread.currentThread().isInterrupted) break
+            if (throttleStateRef?.get()?.stopDueToOverheat == true) break
+            if (!round.isOfflineRound && !client.isConnected()) {
+                AppLog.d(LOG_TAG) { "Connection lost during CPU mining, breaking out to try reconnect" }
+                activeJobId.set(null)
+                break
+            }
+            if (client.isConnected() && client.consumeCleanJobsInvalidation()) {
+                AppLog.d(LOG_TAG) { "Job changed (clean_jobs), switching to new template" }
+                activeJobId.set(null)
+                break
+            }
+            updateCpuPace(pool, config)
+            // Workers only leave a template job when interrupted or on a flavor error.
+            if (drainCpuPool(pool) == 0) break
+            val elapsed = System.currentTimeMillis() - roundStartTimeMs
+            if (elapsed >= MiningConstants.ROUND_STUCK_TIMEOUT_MS) {
+                AppLog.d(LOG_TAG) { "CPU round stuck (${elapsed / 1000}s), cancelling the pool job" }
+                activeJobId.set(null)
+                break
+            }
+        }
+        pool.cancel()
+        drainCpuPool(pool)
+    }
+
+    /** Status interval, cut short when the pool should run dry before it ends so the GPU tail is taken at once. */
+    private fun cpuWaitMs(pool: CpuWorkerPool, statusUpdateIntervalMs: Int): Long {
+        val interval = statusUpdateIntervalMs.toLong()
+        val rate = cpuRateHs
+        if (rate <= 0.0) return interval
+        val etaMs = (pool.remaining() * 1000.0 / rate).toLong()
+        return (etaMs + CPU_DRY_SLACK_MS).coerceIn(CPU_DRY_SLACK_MS, interval)
+    }
+
+    /**
+     * clean_jobs notify, on the stratum reader thread: every native CPU scan of the old job stops within
+     * 64 nonces, and the CPU supervisor wakes to build the new round instead of finishing its wait.
+     */
+    private fun onCleanJobsNotify() {
+        if (!running.get()) return
+        NativeMiner.cpuRequestInterrupt()
+        cpuSupervisorThread?.let { LockSupport.unpark(it) }
+    }
 
-        val cpuWorkers = (0 until threadCount).map {
+    /** Intensity and thermal-throttle sleep, applied by every pool worker after each 2M nonces. */
+    private fun updateCpuPace(pool: CpuWorkerPool, config: MiningConfig) {
+        val throttle = throttleStateRef?.get()
+        val intensity = throttle?.effectiveIntensityPercent ?: config.maxIntensityPercent
+        val cpuIntensityDelay = fixedIntensitySleepMs(intensity)
+        lastCpuIntensityDelayMs.set(cpuIntensityDelay)
+        pool.setPaceMs(cpuIntensityDelay + (throttle?.throttleSleepMs ?: 0L))
+    }
+
+    /** Moves pool hits into [foundSharesQueue] and its counters into the engine; returns the busy worker count. */
+    private fun drainCpuPool(pool: CpuWorkerPool): Int {
+        pool.groupHashrates(System.currentTimeMillis(), CPU_CLUSTER_RATE_INTERVAL_MS)?.let { rates ->
+            cpuClusterSummary.set(
+                pool.groups.zip(rates.asList()).joinToString(" ") { (g, hs) ->
+                    "0x${g.cluster.cpuMask.toString(16)}=${NumberFormatUtils.formatHashrateWithSpaces(hs)}"
+                },
+            )
+        }
+        val ch = pool.channel
+        while (true) {
+            val n = pool.drain()
+            if (n < 0) return 0
+            totalNoncesScanned.addAndGet(ch.scanned)
+            if (ch.bestDifficulty > 0.0) recordBestDifficulty(ch.bestDifficulty)
+            for (i in 0 until n) {
+                // Hits of an already replaced round still carry that round's header and extranonce2.
+                val tag = ch.hitTag(i)
+                val ctx = cpuRoundContexts[tag]
+                if (ctx != null) {
+                    foundSharesQueue.offer(
+                        FoundResult(ctx.job.jobId, ch.hitNonce(i), ctx.extranonce2Hex, ctx.ntimeHex, ctx.header76, "cpu"),
+                    )
+                    continue
+                }
+                val round = cpuTemplateRounds[tag] ?: continue
+                val en2 = ch.hitExtranonce2(i)
+                foundSharesQueue.offer(
+                    FoundResult(round.job.jobId, ch.hitNonce(i), round.extranonce2Hex(en2), round.job.ntimeHex, round.header76(en2), "cpu"),
+                )
+            }
+            val dropped = ch.dropped
+            if (dropped > 0L) AppLog.e(LOG_TAG) { "CPU pool dropped $dropped hit(s): result queue full" }
+            if (ch.status == CpuNonceScanResult.FLAVOR_ERROR) {
+                AppLog.e(LOG_TAG) { "CPU SHA flavor error in pool worker" }
+            }
+            if (n < MinerChannel.MAX_HITS) return ch.busyWorkers
+        }
+    }
+
+    /**
+     * The GPU's part of [round]: dispatches chunks of its range, then of ranges stolen from the CPU pool, until the
+     * round has none left for it, the job goes stale, or mining stops. A hit resumes right after its nonce.
+     */
+    private fun runGpuRound(
+        client: StratumClient,
+        config: MiningConfig,
+        round: SharedRound,
+        statusUpdateIntervalMs: Int,
+    ) {
+        val ctx = round.ctx
+        val job = ctx.job
+
+        val gpuWorkerFuture: Future<*> = gpuWorkerExecutor.submit {
+            Process.setThreadPriority(config.miningThreadPriority)
             val workerJobId = job.jobId
-            Thread {
-                Process.setThreadPriority(config.miningThreadPriority)
+            val channel = gpuChannel
+            channel?.setJob(ctx.header76, ctx.target)
+            // One prepared job per round; this thread frees it once it stops scanning.
+            val gpuJob = channel?.prepareJob(NativeMiner.JOB_NO_FLAVOR) ?: 0L
+            // Rest of a chunk after a hit, scanned before claiming another.
+            var pending: LongRange? = null
+            try {
                 while (running.get() && activeJobId.get() == workerJobId) {
                     if (throttleStateRef?.get()?.stopDueToOverheat == true) break
-                    if (client.isConnected() && client.hasCleanJobsInvalidation()) break
                     val throttle = throttleStateRef?.get()
-                    val start = nextChunkStart.getAndAdd(CHUNK_SIZE)
-                    if (start > CPU_NONCE_END) break
-                    val nonceEndL = minOf(start + CHUNK_SIZE - 1, CPU_NONCE_END)
-                    val nonceEnd = nonceEndL.toInt()
-                    val jniOut = LongArray(2)
-                    NativeMiner.nativeScanNoncesInto(
-                        ctx.header76,
-                        start.toInt(),
-                        nonceEnd,
-                        ctx.target,
-                        config.cpuSha256Flavor.ordinal,
-                        jniOut,
-                    )
-                    val scan = CpuNonceScanResult.fromJniOut(jniOut)
-                    if (scan.status == CpuNonceScanResult.INTERRUPTED) {
-                        AppLog.d(LOG_TAG) { "CPU worker interrupted (stuck watchdog)" }
-                        break
+                    val range = pending ?: round.nonces.claimGpu(CHUNK_SIZE, GPU_MIN_STEAL) ?: break
+                    pending = null
+                    val start = range.first
+                    val nonceEnd = range.last.toInt()
+                    val t0 = System.currentTimeMillis()
+                    val gpuMode = GpuSha256Mode.fromOrdinal(config.gpuSha256Mode.ordinal)
+                    val preJniStartMs = System.currentTimeMillis()
+                    // Midstate and uniform image are already in the prepared job; only the range crosses JNI.
+                    val status = if (channel == null || gpuJob == 0L) {
+                        GpuNonceScanResult.UNAVAILABLE
+                    } else {
+                        NativeMiner.gpuScanJob(
+                            gpuJob,
+                            channel.address,
+                            start.toInt(),
+                            nonceEnd,
+                            config.gpuCores.coerceIn(MiningConfig.GPU_CORES_MIN, MiningConfig.GPU_CORES_MAX),
+                            config.gpuSha256Mode.ordinal,
+                        )
                     }
-                    if (scan.status == CpuNonceScanResult.FLAVOR_ERROR) {
-                        AppLog.e(LOG_TAG) { "CPU SHA flavor error in worker (flavor=${config.cpuSha256Flavor.name})" }
-                        break
+                    val workMs = System.currentTimeMillis() - t0
+                    val preJniMs = preJniStartMs - t0
+                    if (preJniMs >= 100L || workMs >= 500L || status != GpuNonceScanResult.MISS) {
+                        AppLog.d(LOG_TAG) {
+                            "GPU scan anomaly jobId=${job.jobId} range=${String.format(Locale.US, "%08x", start.toInt())}-${String.format(Locale.US, "%08x", nonceEnd)} mode=${gpuMode.name} status=$status nonce=${String.format(Locale.US, "%08x", (channel?.nonce ?: 0L).toInt())} preJniMs=$preJniMs workMs=$workMs"
+                        }
                     }
-                    if (scan.status == CpuNonceScanResult.JNI_ARG_ERROR) {
-                        AppLog.e(LOG_TAG) { "CPU scan JNI argument error in worker" }
+                    if (status == GpuNonceScanResult.UNAVAILABLE || channel == null) {
+                        // The CPU pool takes over this chunk and the rest of the GPU's range right away.
+                        round.nonces.abandonGpu(range)
+                        if (!gpuUnavailable.getAndSet(true)) {
+                            AppLog.d(LOG_TAG) { "GPU unavailable (gpuScanJob status=UNAVAILABLE)" }
+                            onGpuUnavailable?.invoke()
+                            startGpuRetryThreadIfNeeded(config)
+                        }
                         break
                     }
-                    val startU = start.toLong() and 0xFFFFFFFFL
-                    val endU = nonceEndL
-                    val scanned = if (scan.isHit) {
-                        ((scan.nonceU32 and 0xFFFFFFFFL) - startU + 1L).coerceIn(1L, endU - startU + 1L)
-                    } else {
-                        endU - startU + 1L
-                    }
-                    totalNoncesScanned.addAndGet(scanned)
-                    val intensity = throttle?.effectiveIntensityPercent ?: config.maxIntensityPercent
+                    val isHit = status == GpuNonceScanResult.HIT
+                    gpuNoncesScanned.addAndGet(channel.scanned)
+                    val gpuUtil = (throttle?.effectiveGpuUtilizationPercent ?: config.gpuUtilizationPercent).coerceIn(MiningConfig.GPU_UTILIZATION_MIN, MiningConfig.GPU_UTILIZATION_MAX)
                     val throttleSleep = throttle?.throttleSleepMs ?: 0L
-                    val cpuIntensityDelay = fixedIntensitySleepMs(intensity)
-                    lastCpuIntensityDelayMs.set(cpuIntensityDelay)
-                    val totalSleep = cpuIntensityDelay + throttleSleep
+                    val gpuIntensityDelay = fixedIntensitySleepMs(gpuUtil)
+                    lastGpuIntensityDelayMs.set(gpuIntensityDelay)
+                    val totalSleep = gpuIntensityDelay + throttleSleep
                     if (totalSleep > 0L) {
                         try {
                             Thread.sleep(totalSleep)
@@ -461,126 +797,125 @@ class NativeMiningEngine(
                             break
                         }
                     }
-                    if (scan.isHit) {
-                        val nu = scan.nonceU32 and 0xFFFFFFFFL
+                    if (isHit) {
+                        val nu = channel.nonce
                         foundSharesQueue.offer(
-                            FoundResult(job.jobId, nu, ctx.extranonce2Hex, ctx.ntimeHex, ctx.header76, "cpu"),
+                            FoundResult(job.jobId, nu, ctx.extranonce2Hex, ctx.ntimeHex, ctx.header76, "gpu"),
                         )
-                        break
+                        if (nu in range.first until range.last) pending = (nu + 1)..range.last
                     }
                 }
-            }.apply { isDaemon = true }
-        }
-        cpuWorkers.forEach { it.start() }
-        while (cpuWorkers.any { it.isAlive }) {
-            if (!ctx.isOfflineRound && !client.isConnected()) {
-                AppLog.d(LOG_TAG) { "Connection lost during CPU mining, breaking out to try reconnect" }
-                activeJobId.set(null)
-                break
-            }
-            if (client.isConnected() && client.consumeCleanJobsInvalidation()) {
-                AppLog.d(LOG_TAG) { "Job changed (clean_jobs), switching to new template" }
-                activeJobId.set(null)
-            }
-            try {
-                cpuWorkers.forEach { it.join(statusUpdateIntervalMs.toLong()) }
-            } catch (e: InterruptedException) {
-                Thread.currentThread().interrupt()
-                break
-            }
-            val now = System.currentTimeMillis()
-            val elapsed = now - roundStartTimeMs
-            if (elapsed >= MiningConstants.ROUND_STUCK_TIMEOUT_MS && cpuWorkers.any { it.isAlive }) {
-                AppLog.d(LOG_TAG) { "CPU round stuck (${elapsed / 1000}s), interrupting all workers" }
-                NativeMiner.cpuRequestInterrupt()
-                cpuWorkers.forEach { it.interrupt() }
-                activeJobId.set(null)
+            } finally {
+                if (gpuJob != 0L) NativeMiner.nativeJobRelease(gpuJob)
             }
         }
+        watchGpuWorker(client, gpuWorkerFuture, ctx.isOfflineRound, statusUpdateIntervalMs)
     }
 
-    private fun runGpuRound(
+    /**
+     * The GPU's part of template [round]: its own extranonce2 sequence, one header after another (each scanned over
+     * the whole nonce space in [CHUNK_SIZE] dispatches), until the pool sends another job or mining stops.
+     */
+    private fun runGpuTemplateRound(
         client: StratumClient,
         config: MiningConfig,
-        ctx: RoundContext,
+        round: TemplateRound,
         statusUpdateIntervalMs: Int,
     ) {
-        val job = ctx.job
-        activeJobId.set(job.jobId)
-        val nextChunkStart = AtomicLong(CPU_NONCE_END)
-        val roundStartTimeMs = System.currentTimeMillis()
-        val roundStartGpuNonces = gpuNoncesScanned.get()
-
+        val job = round.job
         val gpuWorkerFuture: Future<*> = gpuWorkerExecutor.submit {
             Process.setThreadPriority(config.miningThreadPriority)
-            val workerJobId = job.jobId
-            while (running.get() && activeJobId.get() == workerJobId) {
-                if (throttleStateRef?.get()?.stopDueToOverheat == true) break
-                val throttle = throttleStateRef?.get()
-                val start = nextChunkStart.getAndAdd(CHUNK_SIZE)
-                if (start > MAX_NONCE) break
-                val nonceEndL = minOf(start + CHUNK_SIZE - 1, MAX_NONCE)
-                val nonceEnd = nonceEndL.toInt()
-                val t0 = System.currentTimeMillis()
-                val jniOut = LongArray(2)
-                val gpuMode = GpuSha256Mode.fromOrdinal(config.gpuSha256Mode.ordinal)
-                val preJniStartMs = System.currentTimeMillis()
-                NativeMiner.gpuScanNoncesInto(
-                    ctx.header76,
-                    start.toInt(),
-                    nonceEnd,
-                    ctx.target,
-                    config.gpuCores.coerceIn(MiningConfig.GPU_CORES_MIN, MiningConfig.GPU_CORES_MAX),
-                    config.gpuSha256Mode.ordinal,
-                    jniOut,
-                )
-                val scan = GpuNonceScanResult.fromJniOut(jniOut)
-                val workMs = System.currentTimeMillis() - t0
-                val preJniMs = preJniStartMs - t0
-                if (preJniMs >= 100L || workMs >= 500L || scan.status != GpuNonceScanResult.MISS) {
-                    AppLog.d(LOG_TAG) {
-                        "GPU scan anomaly jobId=${job.jobId} range=${String.format(Locale.US, "%08x", start.toInt())}-${String.format(Locale.US, "%08x", nonceEnd)} mode=${gpuMode.name} status=${scan.status} nonce=${String.format(Locale.US, "%08x", (scan.nonceU32 and 0xFFFFFFFFL).toInt())} preJniMs=$preJniMs workMs=$workMs"
-                    }
-                }
-                if (scan.status == GpuNonceScanResult.UNAVAILABLE) {
-                    if (!gpuUnavailable.getAndSet(true)) {
-                        AppLog.d(LOG_TAG) { "GPU unavailable (gpuScanNoncesInto status=UNAVAILABLE)" }
-                        onGpuUnavailable?.invoke()
-                        startGpuRetryThreadIfNeeded(config)
-                    }
-                    break
-                }
-                val startU = start.toLong() and 0xFFFFFFFFL
-                val endU = nonceEndL
-                val scanned = if (scan.isHit) {
-                    ((scan.nonceU32 and 0xFFFFFFFFL) - startU + 1L).coerceIn(1L, endU - startU + 1L)
-                } else {
-                    endU - startU + 1L
-                }
-                gpuNoncesScanned.addAndGet(scanned)
-                val gpuUtil = (throttle?.effectiveGpuUtilizationPercent ?: config.gpuUtilizationPercent).coerceIn(MiningConfig.GPU_UTILIZATION_MIN, MiningConfig.GPU_UTILIZATION_MAX)
-                val throttleSleep = throttle?.throttleSleepMs ?: 0L
-                val gpuIntensityDelay = fixedIntensitySleepMs(gpuUtil)
-                lastGpuIntensityDelayMs.set(gpuIntensityDelay)
-                val totalSleep = gpuIntensityDelay + throttleSleep
-                if (totalSleep > 0L) {
+            val channel = gpuChannel
+            val template = channel?.let { round.createNative(it) } ?: 0L
+            if (channel == null || template == 0L) {
+                AppLog.e(LOG_TAG) { "GPU header template failed (extranonce2 size ${round.en2Size})" }
+                try {
+                    Thread.sleep(statusUpdateIntervalMs.toLong())
+                } catch (_: InterruptedException) { }
+                return@submit
+            }
+            var en2 = round.en2First + round.gpuIndex
+            try {
+                headers@ while (true) {
+                    val header76 = channel.setTemplateJob(template, en2)
+                    val gpuJob = channel.prepareJob(NativeMiner.JOB_NO_FLAVOR)
                     try {
-                        Thread.sleep(totalSleep)
-                    } catch (_: InterruptedException) {
-                        break
+                        var start = 0L
+                        while (start < NonceScheduler.NONCE_SPACE) {
+                            if (!running.get() || activeJobId.get() != job.jobId || client.getCurrentJob() !== job) break@headers
+                            val throttle = throttleStateRef?.get()
+                            if (throttle?.stopDueToOverheat == true) break@headers
+                            val nonceEnd = minOf(start + CHUNK_SIZE, NonceScheduler.NONCE_SPACE) - 1
+                            val status = if (gpuJob == 0L) {
+                                GpuNonceScanResult.UNAVAILABLE
+                            } else {
+                                NativeMiner.gpuScanJob(
+                                    gpuJob,
+                                    channel.address,
+                                    start.toInt(),
+                                    nonceEnd.toInt(),
+                                    config.gpuCores.coerceIn(MiningConfig.GPU_CORES_MIN, MiningConfig.GPU_CORES_MAX),
+                                    config.gpuSha256Mode.ordinal,
+                                )
+                            }
+                            if (status == GpuNonceScanResult.UNAVAILABLE) {
+                                // Nothing to hand over: the CPU workers own their extranonce2 values and go on.
+                                if (!gpuUnavailable.getAndSet(true)) {
+                                    AppLog.d(LOG_TAG) { "GPU unavailable (gpuScanJob status=UNAVAILABLE)" }
+                                    onGpuUnavailable?.invoke()
+                                    startGpuRetryThreadIfNeeded(config)
+                                }
+                                break@headers
+                            }
+                            gpuNoncesScanned.addAndGet(channel.scanned)
+                            val gpuUtil = (throttle?.effectiveGpuUtilizationPercent ?: config.gpuUtilizationPercent).coerceIn(MiningConfig.GPU_UTILIZATION_MIN, MiningConfig.GPU_UTILIZATION_MAX)
+                            val gpuIntensityDelay = fixedIntensitySleepMs(gpuUtil)
+                            lastGpuIntensityDelayMs.set(gpuIntensityDelay)
+                            val totalSleep = gpuIntensityDelay + (throttle?.throttleSleepMs ?: 0L)
+                            if (totalSleep > 0L) {
+                                try {
+                                    Thread.sleep(totalSleep)
+                                } catch (_: InterruptedException) {
+                                    break@headers
+                                }
+                            }
+                            start = if (status == GpuNonceScanResult.HIT) {
+                                val nu = channel.nonce
+                                foundSharesQueue.offer(
+                                    FoundResult(job.jobId, nu, round.extranonce2Hex(en2), job.ntimeHex, header76, "gpu"),
+                                )
+                                // The rest of the chunk after the hit.
+                                if (nu in start until nonceEnd) nu + 1 else nonceEnd + 1
+                            } else {
+                                nonceEnd + 1
+                            }
+                        }
+                    } finally {
+                        if (gpuJob != 0L) NativeMiner.nativeJobRelease(gpuJob)
                     }
+                    en2 += round.en2Stride
                 }
-                if (scan.isHit) {
-                    val nu = scan.nonceU32 and 0xFFFFFFFFL
-                    foundSharesQueue.offer(
-                        FoundResult(job.jobId, nu, ctx.extranonce2Hex, ctx.ntimeHex, ctx.header76, "gpu"),
-                    )
-                    break
-                }
+            } finally {
+                NativeMiner.nativeTemplateRelease(template)
             }
         }
+        watchGpuWorker(client, gpuWorkerFuture, round.isOfflineRound, statusUpdateIntervalMs)
+    }
+
+    /**
+     * Waits for the gpu-worker task of a round, cancelling it when the connection drops, a clean_jobs notify arrives,
+     * or it makes no progress.
+     */
+    private fun watchGpuWorker(
+        client: StratumClient,
+        gpuWorkerFuture: Future<*>,
+        isOfflineRound: Boolean,
+        statusUpdateIntervalMs: Int,
+    ) {
+        val roundStartTimeMs = System.currentTimeMillis()
+        val roundStartGpuNonces = gpuNoncesScanned.get()
         while (!gpuWorkerFuture.isDone) {
-            if (!ctx.isOfflineRound && !client.isConnected()) {
+            if (!isOfflineRound && !client.isConnected()) {
                 AppLog.d(LOG_TAG) { "Connection lost during GPU mining, breaking out to try reconnect" }
                 activeJobId.set(null)
                 gpuWorkerFuture.cancel(true)
@@ -655,6 +990,9 @@ class NativeMiningEngine(
 
         var lastReconnectAttemptMs = 0L
 
+        fun shareTarget(difficulty: Double): ByteArray =
+            NativeMiner.nativeTargetFromDifficulty(difficulty) ?: StratumHeaderBuilder.buildTargetFromDifficulty(difficulty)
+
         fun buildRoundContext(job: StratumJob, difficulty: Double, en1Hex: String, en2Size: Int, isOfflineRound: Boolean): RoundContext {
             val extranonce2Hex = String.format("%0${en2Size * 2}x", extranonce2Counter.getAndIncrement() and 0xFFFFFFFFL)
             val merkleRoot = StratumHeaderBuilder.buildMerkleRoot(
@@ -665,47 +1003,121 @@ class NativeMiningEngine(
                 job.merkleBranchHex,
             )
             val header76 = StratumHeaderBuilder.buildHeader76(job, merkleRoot)
-            val target = StratumHeaderBuilder.buildTargetFromDifficulty(difficulty)
-            return RoundContext(job, header76, target, job.ntimeHex, extranonce2Hex, isOfflineRound)
+            return RoundContext(job, header76, shareTarget(difficulty), job.ntimeHex, extranonce2Hex, isOfflineRound)
         }
 
-        fun cpuSupervisorLoop() {
-            while (running.get()) {
-                var j: StratumJob? = client.getCurrentJob()
-                while (j == null && running.get()) {
-                    Thread.sleep(200)
-                    j = client.getCurrentJob()
+        /** The current job, waiting for the first one; null when mining stops first. */
+        fun awaitJob(): StratumJob? {
+            var j: StratumJob? = client.getCurrentJob()
+            while (j == null && running.get()) {
+                Thread.sleep(200)
+                j = client.getCurrentJob()
+            }
+            return j?.takeIf { running.get() }
+        }
+
+        /** Per-worker extranonce2 rounds, unless the pool's extranonce2 is too long for native header templates. */
+        fun templateMode(): Boolean =
+            config.perWorkerExtranonce2 && client.getExtranonce2Size() <= TEMPLATE_MAX_EN2_SIZE
+
+        /**
+         * Template round to mine after [finished] (null at first): the one the other backend started on the current
+         * job, else a new one with a fresh window of extranonce2 values. Null when there is nothing to mine yet.
+         */
+        fun nextTemplateRound(finished: TemplateRound?): TemplateRound? {
+            val job = awaitJob() ?: return null
+            synchronized(sharedRoundLock) {
+                val current = sharedTemplate
+                if (current != null && current !== finished && current.job === job && activeJobId.get() == job.jobId) {
+                    return current
                 }
-                val cpuJob = j ?: continue
-                if (!running.get()) continue
                 val diff = client.getCurrentDifficulty()
-                if (diff <= 0.0) continue
-                val en1 = client.getExtranonce1Hex() ?: continue
+                if (diff <= 0.0) return null
+                val en1 = client.getExtranonce1Hex() ?: return null
                 val en2 = client.getExtranonce2Size().coerceAtLeast(4)
-                val ctx = buildRoundContext(cpuJob, diff, en1, en2, !client.isConnected())
-                runCpuRound(client, config, ctx, threadCount, statusUpdateIntervalMs)
+                val en2First = extranonce2Counter.getAndAdd(TEMPLATE_EN2_WINDOW) and 0xFFFFFFFFL
+                // CPU worker i owns en2First + i (the pool may start fewer than threadCount); the GPU the value after.
+                val round = TemplateRound(job, en1, en2, shareTarget(diff), en2First, threadCount + 1, threadCount, !client.isConnected())
+                AppLog.d(LOG_TAG) {
+                    "Template round ${round.extranonce2Hex(en2First)}: extranonce2 stride ${round.en2Stride}, GPU index ${round.gpuIndex}"
+                }
+                return round.also {
+                    sharedTemplate = it
+                    activeJobId.set(job.jobId)
+                }
+            }
+        }
+
+        /**
+         * Round to mine after [finished] (null at first): the one the other backend started on the current job, else
+         * a new one whose nonce space is split by the measured hashrates. Null when there is nothing to mine yet.
+         */
+        fun nextRound(finished: SharedRound?): SharedRound? {
+            val job = awaitJob() ?: return null
+            synchronized(sharedRoundLock) {
+                val current = sharedRound
+                if (current != null && current !== finished && current.ctx.job === job && activeJobId.get() == job.jobId) {
+                    return current
+                }
+                val diff = client.getCurrentDifficulty()
+                if (diff <= 0.0) return null
+                val en1 = client.getExtranonce1Hex() ?: return null
+                val en2 = client.getExtranonce2Size().coerceAtLeast(4)
+                val ctx = buildRoundContext(job, diff, en1, en2, !client.isConnected())
+                val gpuActive = gpuEnabled && !gpuUnavailable.get()
+                val nonces = NonceScheduler(cpuRateHs, gpuRateHs, threadCount > 0, gpuActive)
+                AppLog.d(LOG_TAG) { "Round ${ctx.extranonce2Hex}: CPU ${nonces.cpuPercent}% of the nonce space, GPU=$gpuActive" }
+                return SharedRound(ctx, nonces).also {
+                    sharedRound = it
+                    activeJobId.set(job.jobId)
+                }
+            }
+        }
+
+        fun cpuSupervisorLoop() {
+            val groups = CpuPlacement.plan(threadCount, config.cpuSha256Flavor, cpuFlavorAuto, cpuShaCalibrationRows())
+            val pool = groups.takeIf { it.isNotEmpty() }
+                ?.let { CpuWorkerPool.createGroups(it, config.miningThreadPriority) }
+                ?.also { AppLog.d(LOG_TAG) { "CPU workers placed per cluster: ${CpuPlacement.describe(groups)}" } }
+                ?: CpuWorkerPool.create(threadCount, config.miningThreadPriority)
+            cpuClusterSummary.set("")
+            if (pool == null) {
+                AppLog.e(LOG_TAG) { "CPU worker pool failed to start ($threadCount threads)" }
+                return
+            }
+            try {
+                var round: SharedRound? = null
+                var template: TemplateRound? = null
+                while (running.get()) {
+                    if (templateMode()) {
+                        template = nextTemplateRound(template) ?: continue
+                        runCpuTemplateRound(client, config, pool, template, statusUpdateIntervalMs)
+                    } else {
+                        round = nextRound(round) ?: continue
+                        runCpuRound(client, config, pool, round, statusUpdateIntervalMs)
+                    }
+                }
+            } catch (_: InterruptedException) {
+            } finally {
+                pool.close()
             }
         }
 
         fun gpuSupervisorLoop() {
+            var round: SharedRound? = null
+            var template: TemplateRound? = null
             while (running.get() && gpuEnabled) {
                 if (gpuUnavailable.get()) {
                     Thread.sleep(1000)
                     continue
                 }
-                var j: StratumJob? = client.getCurrentJob()
-                while (j == null && running.get()) {
-                    Thread.sleep(200)
-                    j = client.getCurrentJob()
+                if (templateMode()) {
+                    template = nextTemplateRound(template) ?: continue
+                    runGpuTemplateRound(client, config, template, statusUpdateIntervalMs)
+                } else {
+                    round = nextRound(round) ?: continue
+                    runGpuRound(client, config, round, statusUpdateIntervalMs)
                 }
-                val gpuJob = j ?: continue
-                if (!running.get()) continue
-                val diff = client.getCurrentDifficulty()
-                if (diff <= 0.0) continue
-                val en1 = client.getExtranonce1Hex() ?: continue
-                val en2 = client.getExtranonce2Size().coerceAtLeast(4)
-                val ctx = buildRoundContext(gpuJob, diff, en1, en2, !client.isConnected())
-                runGpuRound(client, config, ctx, statusUpdateIntervalMs)
             }
         }
 
@@ -750,13 +1162,7 @@ class NativeMiningEngine(
             while (true) {
                 val found = foundSharesQueue.poll() ?: break
                 val header80 = StratumHeaderBuilder.header76WithNonce(found.header76, found.nonceU32)
-                val diff = StratumHeaderBuilder.difficultyFromHeader80(header80)
-                bestDifficultyRef.updateAndGet { maxOf(it, diff) }
-                val prevSessionBest = sessionBestShareDifficultyRef.get()
-                val newSessionBest = sessionBestShareDifficultyRef.updateAndGet { maxOf(it, diff) }
-                if (newSessionBest > prevSessionBest) {
-                    onSessionBestDifficultyRecord?.invoke(System.currentTimeMillis(), newSessionBest)
-                }
+                recordBestDifficulty(NativeMiner.nativeShareDifficulty(header80))
                 identifiedShares.incrementAndGet()
                 when (shareSourceFromFoundTag(found.source)) {
                     StratumOutboundSubmitSource.Cpu -> identifiedSharesCpu.incrementAndGet()
@@ -811,6 +1217,9 @@ class NativeMiningEngine(
             val rolling = addSampleAndGetRollingHashrate(now, cpuN, gpuN)
             val hashrateHs = rolling?.first ?: (cpuN / effectiveElapsed)
             val gpuHashrateHs = rolling?.second ?: (gpuN / effectiveElapsed)
+            cpuRateHs = hashrateHs
+            gpuRateHs = gpuHashrateHs
+            sharedRound?.nonces?.updateRates(hashrateHs, gpuHashrateHs)
             statusRef.set(MiningStatus(
                 state = MiningStatus.State.Mining,
                 hashrateHs = hashrateHs,
@@ -830,7 +1239,7 @@ class NativeMiningEngine(
                 val cpuNonceN = totalNoncesScanned.get()
                 val gpuNonceN = gpuNoncesScanned.get()
                 AppLog.d(LOG_TAG) {
-                    "Stats: ${statsLogExtra?.invoke() ?: ""}CPU ${NumberFormatUtils.formatHashrateWithSpaces(hashrateHs)} GPU ${NumberFormatUtils.formatHashrateWithSpaces(gpuHashrateHs)} H/s, noncesCpu=${NumberFormatUtils.formatWithSpaces(cpuNonceN)}, noncesGpu=${NumberFormatUtils.formatWithSpaces(gpuNonceN)}, noncesTotal=${NumberFormatUtils.formatWithSpaces(cpuNonceN + gpuNonceN)}, blockTemplate=${NumberFormatUtils.formatIntWithSpaces(blockTemplatesCount.get().toInt())}, CPU_Int Delay=${NumberFormatUtils.formatDurationMmSs(lastCpuIntensityDelayMs.get())}, GPU_Int Delay=${NumberFormatUtils.formatDurationMmSs(lastGpuIntensityDelayMs.get())}"
+                    "Stats: ${statsLogExtra?.invoke() ?: ""}CPU ${NumberFormatUtils.formatHashrateWithSpaces(hashrateHs)} GPU ${NumberFormatUtils.formatHashrateWithSpaces(gpuHashrateHs)} H/s, noncesCpu=${NumberFormatUtils.formatWithSpaces(cpuNonceN)}, noncesGpu=${NumberFormatUtils.formatWithSpaces(gpuNonceN)}, noncesTotal=${NumberFormatUtils.formatWithSpaces(cpuNonceN + gpuNonceN)}, blockTemplate=${NumberFormatUtils.formatIntWithSpaces(blockTemplatesCount.get().toInt())}, CPU_Int Delay=${NumberFormatUtils.formatDurationMmSs(lastCpuIntensityDelayMs.get())}, GPU_Int Delay=${NumberFormatUtils.formatDurationMmSs(lastGpuIntensityDelayMs.get())}${cpuClusterSummary.get().takeIf { it.isNotEmpty() }?.let { ", cpuClusters=[$it]" } ?: ""}"
                 }
                 lastLogTime = now
             }
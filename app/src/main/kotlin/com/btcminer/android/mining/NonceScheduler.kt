@@ -0,0 +1,131 @@
+package com.btcminer.android.mining
+
+/**
+ * One round's nonce space (one header, nonces 0..0xFFFFFFFF) shared by the CPU pool and the GPU. It starts split
+ * in proportion to their measured hashrates: the CPU pool scans `[0, split)` as its job and the GPU claims chunks
+ * from the rest. Whichever runs dry first takes the other's tail:
+ * - the GPU steals the upper half of the pool's largest remaining run ([CpuWorkerPool.steal]);
+ * - the CPU takes its rate's share of the GPU's unclaimed range into the running pool job ([CpuWorkerPool.extend]).
+ *
+ * If the GPU fails, its unclaimed range joins the pool job at once. The round is done when neither side has
+ * anything left to take. Every boundary is a multiple of [NativeMiner.CPU_POOL_UNIT], as the pool requires.
+ * Thread-safe: the cpu-supervisor and gpu-worker threads both call in.
+ */
+internal class NonceScheduler(
+    @Volatile private var cpuRateHs: Double,
+    @Volatile private var gpuRateHs: Double,
+    cpuActive: Boolean,
+    gpuActive: Boolean,
+) {
+    /** The CPU's initial range, until [claimCpu] hands it out. */
+    private var cpuRange: LongRange?
+    /** The GPU's unclaimed range, `[gpuNext, gpuEnd)`. */
+    private var gpuNext: Long
+    private var gpuEnd = NONCE_SPACE
+    private var gpuGone = !gpuActive
+    /** Pool running this round's CPU job (and its tag) while the CPU is in the round; GPU steals go through it. */
+    private var pool: CpuWorkerPool? = null
+    private var cpuTag = 0L
+
+    /** Percent of the space initially given to the CPU. */
+    val cpuPercent: Int
+
+    init {
+        val split = when {
+            !cpuActive -> 0L
+            gpuGone -> NONCE_SPACE
+            else -> alignDown((NONCE_SPACE * cpuShare()).toLong()).coerceIn(UNIT, NONCE_SPACE - UNIT)
+        }
+        cpuRange = if (split > 0L) 0L until split else null
+        gpuNext = split
+        cpuPercent = (split * 100 / NONCE_SPACE).toInt()
+    }
+
+    /** CPU share of the current rates; an even split until both are known. */
+    private fun cpuShare(): Double {
+        val cpu = cpuRateHs
+        val gpu = gpuRateHs
+        return if (cpu > 0.0 && gpu > 0.0) cpu / (cpu + gpu) else 0.5
+    }
+
+    /** Latest measured rates, for later tail splits. */
+    fun updateRates(cpuHs: Double, gpuHs: Double) {
+        cpuRateHs = cpuHs
+        gpuRateHs = gpuHs
+    }
+
+    /** The CPU's range to submit: its initial one, else (and only once) a share of the GPU's; null when none. */
+    @Synchronized
+    fun claimCpu(): LongRange? {
+        val r = cpuRange ?: return takeGpuTailLocked()
+        cpuRange = null
+        return r
+    }
+
+    /** The CPU pool runs job [tag] of this round; the GPU may steal from it until [detachCpu]. */
+    @Synchronized
+    fun attachCpu(pool: CpuWorkerPool, tag: Long) {
+        this.pool = pool
+        cpuTag = tag
+    }
+
+    /** The CPU left the round (finished, stale or stopping); call before its pool takes another job. */
+    @Synchronized
+    fun detachCpu() {
+        pool = null
+    }
+
+    /**
+     * Next GPU range of at most [maxNonces]: from the GPU's own range, else stolen from the CPU pool (at least
+     * [minSteal] nonces). Null when the round has nothing left for the GPU.
+     */
+    @Synchronized
+    fun claimGpu(maxNonces: Long, minSteal: Long): LongRange? {
+        if (gpuNext >= gpuEnd) {
+            val stolen = pool?.steal(cpuTag, minSteal) ?: return null
+            gpuNext = stolen.first
+            gpuEnd = stolen.last + 1
+        }
+        val end = minOf(gpuEnd, gpuNext + maxNonces)
+        val r = gpuNext until end
+        gpuNext = end
+        return r
+    }
+
+    /** The CPU ran dry: its rate's share of the GPU's unclaimed range (all of it once the GPU is gone), or null. */
+    @Synchronized
+    fun takeGpuTail(): LongRange? = takeGpuTailLocked()
+
+    private fun takeGpuTailLocked(): LongRange? {
+        val left = gpuEnd - gpuNext
+        if (left < UNIT) return null
+        val share = if (gpuGone) left else alignDown((left * cpuShare()).toLong())
+        if (share < UNIT) return null
+        val start = gpuEnd - share
+        gpuEnd = start
+        return start until start + share
+    }
+
+    /**
+     * The GPU failed with [unscanned] (the tail of its last claim) still to do: that and the rest of the GPU's range
+     * join the CPU pool's job now, or wait for [takeGpuTail] when the CPU is not in the round.
+     */
+    @Synchronized
+    fun abandonGpu(unscanned: LongRange?) {
+        gpuGone = true
+        if (unscanned != null && !unscanned.isEmpty() && unscanned.last + 1 == gpuNext) {
+            // A partly scanned chunk restarts at the next unit; the few nonces skipped are not worth a duplicate hit.
+            gpuNext = alignUp(unscanned.first)
+        }
+        val p = pool ?: return
+        if (gpuNext < gpuEnd && p.extend(cpuTag, gpuNext until gpuEnd)) gpuNext = gpuEnd
+    }
+
+    companion object {
+        const val NONCE_SPACE = 1L shl 32
+        private const val UNIT = NativeMiner.CPU_POOL_UNIT
+
+        private fun alignDown(n: Long): Long = n / UNIT * UNIT
+        private fun alignUp(n: Long): Long = (n + UNIT - 1) / UNIT * UNIT
+    }
+}
@@ -45,6 +45,8 @@ class StratumClient(
     private val stratumPin: String? = null,
     private val onReconnectRequest: ((host: String, port: Int) -> Unit)? = null,
     private val onTemplateReceived: (() -> Unit)? = null,
+    /** Called on the reader thread right after a clean_jobs notify is stored as the current job. */
+    private val onCleanJobs: (() -> Unit)? = null,
     private val onConnectionLost: (() -> Unit)? = null,
     private val threadPriority: Int = 0,
 ) {
@@ -453,6 +455,7 @@ class StratumClient(
         }
         val merkleList = params.optJSONArray(4) ?: JSONArray()
         val merkleBranch = (0 until merkleList.length()).map { merkleList.optString(it) }
+        val cleanJobs = params.optBoolean(8, false)
         currentJob.set(StratumJob(
             jobId = params.optString(0),
             prevhashHex = params.optString(1),
@@ -462,9 +465,10 @@ class StratumClient(
             versionHex = params.optString(5),
             nbitsHex = params.optString(6),
             ntimeHex = params.optString(7),
-            cleanJobs = params.optBoolean(8, false),
+            cleanJobs = cleanJobs,
         ))
         onTemplateReceived?.invoke()
+        if (cleanJobs) onCleanJobs?.invoke()
     }
 
     private fun parseSetExtranonce(params: JSONArray?) {
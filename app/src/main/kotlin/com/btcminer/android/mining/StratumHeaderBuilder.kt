@@ -114,7 +114,8 @@ object StratumHeaderBuilder {
      * where `max_target` is Bitcoin difficulty-1 (nbits 0x1d00ffff). Easier targets when the pool
      * sends difficulty below 1.0 are not capped back to difficulty 1 (NerdMiner / low-diff Stratum).
      * Values above 2^256-1
-     * clamp to all 0xFF bytes (easiest representable target).
+     * clamp to all 0xFF bytes (easiest representable target). Mining uses [NativeMiner.nativeTargetFromDifficulty];
+     * this stays as the JVM reference (unit tests, no native library).
      */
     fun buildTargetFromDifficulty(difficulty: Double): ByteArray {
         val maxTarget = BigInteger("00000000ffff0000000000000000000000000000000000000000000000000000", 16)
@@ -158,7 +159,7 @@ object StratumHeaderBuilder {
     /**
      * Compute share difficulty from 80-byte block header (double-SHA256 hash, then truediffone / hash).
      * Matches public-pool `DifficultyUtils` / bitcoinjs PoW integer: digest bytes as **little-endian** uint256
-     * (MSB = `digest[31]`), same as `BigInteger(1, hash.reversedArray())`.
+     * (MSB = `digest[31]`), same as `BigInteger(1, hash.reversedArray())`. Mining uses [NativeMiner.nativeShareDifficulty].
      */
     fun difficultyFromHeader80(header80: ByteArray): Double {
         require(header80.size == 80) { "Header must be 80 bytes" }
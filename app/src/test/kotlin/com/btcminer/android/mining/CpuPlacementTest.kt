@@ -0,0 +1,97 @@
+package com.btcminer.android.mining
+
+import com.btcminer.android.config.CpuSha256Flavor
+import com.btcminer.android.config.CpuShaCalibration
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertTrue
+import org.junit.Test
+
+/**
+ * [CpuPlacement.plan] on a synthetic 1 + 3 + 4 big.LITTLE topology, listed fastest first as
+ * [CpuPlacement.topology] reports it. Per-cluster flavors need the native self-test, so they stay off here.
+ */
+class CpuPlacementTest {
+
+    private val prime = CpuPlacement.Cluster(cpuMask = 0x80, cpus = 1, capacity = 1024, maxKhz = 3_200_000)
+    private val big = CpuPlacement.Cluster(cpuMask = 0x70, cpus = 3, capacity = 870, maxKhz = 2_800_000)
+    private val little = CpuPlacement.Cluster(cpuMask = 0x0F, cpus = 4, capacity = 325, maxKhz = 2_000_000)
+    private val clusters = listOf(prime, big, little)
+
+    private val flavor = CpuSha256Flavor.HW_SHA2_3WAY
+    private val unit = NativeMiner.CPU_POOL_UNIT
+
+    private fun plan(
+        threads: Int,
+        calibration: List<CpuShaCalibration.Row> = emptyList(),
+        on: List<CpuPlacement.Cluster> = clusters,
+    ) = CpuPlacement.plan(threads, flavor, perClusterFlavor = false, calibration = calibration, clusters = on)
+
+    private fun row(c: CpuPlacement.Cluster, hs: Long, f: CpuSha256Flavor = flavor) =
+        CpuShaCalibration.Row(clusters.indexOf(c), c.cpuMask, f, hs)
+
+    @Test
+    fun plan_isEmpty_withoutThreadsOrWithOneCluster() {
+        assertTrue(plan(0).isEmpty())
+        assertTrue(plan(4, on = listOf(little)).isEmpty())
+        assertTrue(plan(4, on = emptyList()).isEmpty())
+    }
+
+    @Test
+    fun plan_fillsFastestClustersFirst_withOnePinnedGroupEach() {
+        val groups = plan(6)
+        assertEquals(listOf(0x80L, 0x70L, 0x0FL), groups.map { it.cluster.cpuMask })
+        assertEquals(listOf(1, 3, 2), groups.map { it.threads })
+        assertTrue(groups.all { it.flavor == null })
+
+        val one = plan(1)
+        assertEquals(listOf(0x80L), one.map { it.cluster.cpuMask })
+        assertEquals(listOf(1), one.map { it.threads })
+    }
+
+    @Test
+    fun plan_putsThreadsBeyondOnlineCpusOnTheFastestCluster() {
+        assertEquals(listOf(3, 3, 4), plan(10).map { it.threads })
+    }
+
+    @Test
+    fun plan_weighsByCapacity_withoutCalibration() {
+        val groups = plan(8)
+        assertEquals(listOf(1024L, 870L, 325L), groups.map { it.weight })
+        // 64K scaled by weight / 1024, rounded down to whole units (16K), never below one unit.
+        assertEquals(listOf(4 * unit, 3 * unit, unit), groups.map { it.chunkNonces })
+    }
+
+    @Test
+    fun plan_weighsByCalibratedSpeed_whenEveryClusterHasIt() {
+        val calibration = listOf(
+            row(prime, 120_000_000),
+            row(big, 90_000_000),
+            row(little, 20_000_000),
+            // Another flavor's row never counts for the one being mined with.
+            row(little, 500_000_000, CpuSha256Flavor.NEON8_MIDSTATE),
+        )
+        val groups = plan(8, calibration)
+        assertEquals(listOf(120_000_000L, 90_000_000L, 20_000_000L), groups.map { it.weight })
+        assertEquals(listOf(4 * unit, 3 * unit, unit), groups.map { it.chunkNonces })
+        assertEquals(listOf(1, 3, 4), groups.map { it.threads })
+        assertEquals(listOf(0x80L, 0x70L, 0x0FL), groups.map { it.cluster.cpuMask })
+    }
+
+    @Test
+    fun plan_fallsBackToCapacity_whenACalibratedSpeedIsMissing() {
+        val groups = plan(8, listOf(row(prime, 120_000_000), row(big, 90_000_000)))
+        assertEquals(listOf(1024L, 870L, 325L), groups.map { it.weight })
+    }
+
+    @Test
+    fun plan_fallsBackToMaxClockThenEqualWeights() {
+        val noCapacity = clusters.map { it.copy(capacity = 0) }
+        val byClock = plan(8, on = noCapacity)
+        assertEquals(listOf(3_200_000L, 2_800_000L, 2_000_000L), byClock.map { it.weight })
+        assertEquals(listOf(4 * unit, 3 * unit, 2 * unit), byClock.map { it.chunkNonces })
+
+        val unknown = plan(8, on = noCapacity.map { it.copy(maxKhz = 0) })
+        assertEquals(listOf(1L, 1L, 1L), unknown.map { it.weight })
+        assertEquals(listOf(4 * unit, 4 * unit, 4 * unit), unknown.map { it.chunkNonces })
+    }
+}
@@ -0,0 +1,133 @@
+package com.btcminer.android.mining
+
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertNull
+import org.junit.Assert.assertTrue
+import org.junit.Test
+
+/** CPU/GPU nonce-space split without a CPU pool attached (steals and extends need the native pool). */
+class NonceSchedulerTest {
+
+    private val space = NonceScheduler.NONCE_SPACE
+    private val unit = NativeMiner.CPU_POOL_UNIT
+
+    /** [ranges] are disjoint and together are exactly 0..0xFFFFFFFF. */
+    private fun assertCoversSpace(ranges: List<LongRange>) {
+        var next = 0L
+        for (r in ranges.sortedBy { it.first }) {
+            assertTrue("empty range $r", !r.isEmpty())
+            assertEquals("gap or overlap at $r", next, r.first)
+            next = r.last + 1
+        }
+        assertEquals(space, next)
+    }
+
+    @Test
+    fun split_isEvenUntilBothRatesAreKnown() {
+        for ((cpu, gpu) in listOf(0.0 to 0.0, 5e6 to 0.0, 0.0 to 2e8)) {
+            val s = NonceScheduler(cpu, gpu, cpuActive = true, gpuActive = true)
+            assertEquals(50, s.cpuPercent)
+            assertEquals(0L until space / 2, s.claimCpu())
+            assertEquals(space / 2 until space, s.claimGpu(space, unit))
+        }
+    }
+
+    @Test
+    fun split_followsRatesOnUnitBoundaries() {
+        val s = NonceScheduler(1e6, 3e6, cpuActive = true, gpuActive = true)
+        assertEquals(25, s.cpuPercent)
+        val cpu = s.claimCpu()!!
+        assertEquals(0L, cpu.first)
+        assertEquals(space / 4, cpu.last + 1)
+
+        val third = NonceScheduler(1e6, 2e6, cpuActive = true, gpuActive = true)
+        val split = third.claimCpu()!!.last + 1
+        assertEquals(0L, split % unit)
+        assertTrue(split <= space / 3 && space / 3 - split < unit)
+        assertEquals(split, third.claimGpu(unit, unit)!!.first)
+    }
+
+    @Test
+    fun split_leavesEachActiveSideAtLeastOneUnit() {
+        val gpuHeavy = NonceScheduler(1.0, 1e12, cpuActive = true, gpuActive = true)
+        assertEquals(0L until unit, gpuHeavy.claimCpu())
+
+        val cpuHeavy = NonceScheduler(1e12, 1.0, cpuActive = true, gpuActive = true)
+        assertEquals(0L until space - unit, cpuHeavy.claimCpu())
+        assertEquals(space - unit until space, cpuHeavy.claimGpu(space, unit))
+        assertNull(cpuHeavy.claimGpu(space, unit))
+    }
+
+    @Test
+    fun cpuTakesEverything_whenGpuIsAbsent() {
+        val s = NonceScheduler(1e6, 0.0, cpuActive = true, gpuActive = false)
+        assertEquals(100, s.cpuPercent)
+        assertEquals(0L until space, s.claimCpu())
+        assertNull(s.claimGpu(space, unit))
+        assertNull(s.takeGpuTail())
+        assertNull(s.claimCpu())
+    }
+
+    @Test
+    fun gpuTakesEverything_whenCpuIsAbsent() {
+        val s = NonceScheduler(0.0, 2e8, cpuActive = false, gpuActive = true)
+        assertEquals(0, s.cpuPercent)
+        assertEquals(0L until space, s.claimGpu(space, unit))
+        assertNull(s.claimGpu(space, unit))
+    }
+
+    @Test
+    fun cpuTail_isItsRateShareFromTheTop() {
+        val s = NonceScheduler(0.0, 0.0, cpuActive = true, gpuActive = true)
+        s.claimCpu()
+        val gpu = s.claimGpu(16 * unit, unit)!!
+        s.updateRates(3e6, 1e6)
+        val tail = s.takeGpuTail()!!
+        val left = space - (gpu.last + 1)
+        assertEquals(space - 1, tail.last)
+        assertEquals(left * 3 / 4 / unit * unit, tail.last + 1 - tail.first)
+        assertEquals(0L, tail.first % unit)
+        // The GPU carries on below the tail, which it no longer owns.
+        val rest = generateSequence { s.claimGpu(space, unit) }.toList()
+        assertEquals(listOf(gpu.last + 1 until tail.first), rest)
+    }
+
+    @Test
+    fun abandonedGpu_leavesItsRangeToTheCpu() {
+        val s = NonceScheduler(1e6, 1e6, cpuActive = true, gpuActive = true)
+        s.claimCpu()
+        val gpu = s.claimGpu(10 * unit, unit)!!
+        // Failed partway through its chunk: the rest restarts at the next unit boundary.
+        val unscanned = gpu.first + 3 * unit + 5 until gpu.last + 1
+        s.abandonGpu(unscanned)
+        assertEquals(gpu.first + 4 * unit until space, s.takeGpuTail())
+        assertNull(s.takeGpuTail())
+        assertNull(s.claimGpu(space, unit))
+    }
+
+    @Test
+    fun abandonedGpu_beforeAnyClaim_leavesItsWholeRange() {
+        val s = NonceScheduler(1e6, 3e6, cpuActive = true, gpuActive = true)
+        val cpu = s.claimCpu()!!
+        s.abandonGpu(null)
+        val tail = s.takeGpuTail()!!
+        assertCoversSpace(listOf(cpu, tail))
+    }
+
+    @Test
+    fun claims_neitherOverlapNorLeaveGaps_upToUint32Max() {
+        val s = NonceScheduler(2e6, 5e6, cpuActive = true, gpuActive = true)
+        val ranges = mutableListOf(s.claimCpu()!!)
+        // Uneven GPU claims so the last one is cut short by the end of its range.
+        val chunk = (1L shl 27) + 7
+        var claims = 0
+        while (true) {
+            val g = s.claimGpu(chunk, unit) ?: break
+            ranges += g
+            if (++claims % 3 == 0) s.takeGpuTail()?.let { ranges += it }
+        }
+        s.takeGpuTail()?.let { ranges += it }
+        assertCoversSpace(ranges)
+        assertEquals(0xFFFFFFFFL, ranges.maxOf { it.last })
+    }
+}